@@ -120,6 +120,12 @@ declare namespace Rainbow {
     Count = 15,
   }
 
+  export enum IOPriority {
+    Low = 0,
+    Normal = 1,
+    High = 2,
+  }
+
   export class Label {
     private readonly $type: "Rainbow.Label";
     constructor();
@@ -342,6 +348,21 @@ declare namespace Rainbow {
     };
   }
 
+  export namespace FontCache {
+    function prewarm(font: string, fontSize: number, text: string): void;
+  }
+
+  export namespace IO {
+    function readFile(path: string, priority?: IOPriority): IORequest;
+    function readUserFile(path: string, priority?: IOPriority): IORequest;
+    function writeFile(path: string, data: ArrayBuffer | string, priority?: IOPriority): IORequest;
+    export type IORequest = {
+      readonly $type: "Rainbow.IORequest";
+      then(onFulfilled: (result?: ArrayBuffer) => void, onRejected?: (reason: string) => void): void;
+      cancel(): boolean;
+    };
+  }
+
   export namespace Input {
     const acceleration: Float64Array;
     const controllers: ReadonlyArray<Readonly<ControllerState>>;
@@ -7,7 +7,9 @@
 #include <algorithm>
 #include <array>
 
+#include "Audio/Codecs/PcmAudioFile.h"
 #include "Common/Logging.h"
+#include "FileSystem/AssetCache.h"
 #include "FileSystem/File.h"
 
 #if defined(RAINBOW_OS_IOS) || defined(RAINBOW_OS_MACOS)
@@ -19,6 +21,7 @@
 #    define USE_OGGVORBIS 1
 #endif
 
+using rainbow::AssetCache;
 using rainbow::czstring;
 using rainbow::audio::IAudioFile;
 
@@ -56,6 +59,22 @@ auto IAudioFile::open(czstring path) -> std::unique_ptr<IAudioFile>
         [[maybe_unused]] auto error = file.seek(0);
     }
 
+    if (PcmAudioFile::signature_matches(signature))
+    {
+        // Share the buffer with other instances of the same sound.
+        if (auto cache = AssetCache::Get())
+        {
+            if (auto data = cache->load(path, FileType::Asset))
+            {
+                return std::unique_ptr<IAudioFile>{
+                    std::make_unique<PcmAudioFile>(std::move(data))};
+            }
+        }
+
+        return std::unique_ptr<IAudioFile>{std::make_unique<PcmAudioFile>(
+            File::map(path, FileType::Asset))};
+    }
+
 #ifdef USE_OGGVORBIS
     if (OggVorbisAudioFile::signature_matches(signature))
     {
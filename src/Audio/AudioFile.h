@@ -10,6 +10,11 @@
 #include "Common/NonCopyable.h"
 #include "Common/String.h"
 
+namespace rainbow
+{
+    class Data;
+}
+
 namespace rainbow::audio
 {
     struct IAudioFile : private NonCopyable<IAudioFile>
@@ -26,6 +31,15 @@ namespace rainbow::audio
         void rewind() { seek(0); }
         virtual bool seek(int64_t offset) = 0;
 
+        /// <summary>
+        ///   Returns the whole sound as cooked PCM if it is already in memory;
+        ///   <c>nullptr</c> otherwise.
+        /// </summary>
+        virtual auto pcm() const -> std::shared_ptr<const Data>
+        {
+            return {};
+        }
+
         virtual /* explicit */ operator bool() const = 0;
     };
 }  // namespace rainbow::audio
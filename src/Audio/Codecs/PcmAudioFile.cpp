@@ -0,0 +1,130 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Audio/Codecs/PcmAudioFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "Common/Logging.h"
+#include "Common/TypeCast.h"
+
+using rainbow::Data;
+using rainbow::narrow_cast;
+using rainbow::audio::PcmAudioFile;
+using rainbow::cooker::PCMHeader;
+
+bool PcmAudioFile::signature_matches(const std::array<uint8_t, 8>& signature)
+{
+    uint32_t magic = 0;
+    std::memcpy(&magic, signature.data(), sizeof(magic));
+    return magic == PCMHeader::kMagic;
+}
+
+auto PcmAudioFile::decode(IAudioFile& file) -> Data
+{
+    if (!file || file.channels() <= 0)
+        return {};
+
+    const size_t size = file.size();
+    if (size == 0)
+        return {};
+
+    const auto header = make_header(file);
+
+    auto buffer = std::make_unique<uint8_t[]>(sizeof(header) + size);
+    std::memcpy(buffer.get(), &header, sizeof(header));
+
+    file.rewind();
+    if (file.read(buffer.get() + sizeof(header), size) != size)
+    {
+        LOGE("PCM: Failed to decode sound");
+        return {};
+    }
+
+    return {buffer.release(), sizeof(header) + size, Data::Ownership::Owner};
+}
+
+auto PcmAudioFile::make_header(const IAudioFile& file) -> PCMHeader
+{
+    return {
+        PCMHeader::kMagic,
+        cooker::kFormatVersion,
+        narrow_cast<uint16_t>(file.channels()),
+        narrow_cast<uint32_t>(file.rate()),
+        narrow_cast<uint32_t>(file.size() /
+                              (file.channels() * sizeof(int16_t))),
+    };
+}
+
+PcmAudioFile::PcmAudioFile(Data data)
+    : PcmAudioFile(std::make_shared<const Data>(std::move(data)))
+{
+}
+
+PcmAudioFile::PcmAudioFile(std::shared_ptr<const Data> data)
+    : data_(std::move(data)),
+      header_(cooker::header_of<PCMHeader>(data_->bytes(), data_->size()))
+{
+    if (header_ == nullptr)
+    {
+        LOGE("PCM: Unsupported version");
+        return;
+    }
+
+    if (header_->channels == 0 || data_->size() - sizeof(*header_) < size())
+    {
+        LOGE("PCM: File is truncated");
+        header_ = nullptr;
+    }
+}
+
+auto PcmAudioFile::channels() const -> int
+{
+    return header_ == nullptr ? 0 : header_->channels;
+}
+
+auto PcmAudioFile::rate() const -> int
+{
+    return header_ == nullptr ? 0 : header_->rate;
+}
+
+auto PcmAudioFile::size() const -> size_t
+{
+    return header_ == nullptr
+               ? 0
+               : static_cast<size_t>(header_->frames) * header_->channels *
+                     sizeof(int16_t);
+}
+
+auto PcmAudioFile::read(void* dst, size_t size) -> size_t
+{
+    const auto buffer = static_cast<uint8_t*>(dst);
+    const auto read = std::min(size, this->size() - position_);
+    if (read > 0)
+    {
+        std::copy_n(data_->bytes() + sizeof(PCMHeader) + position_,
+                    read,
+                    buffer);
+        position_ += read;
+    }
+
+    std::fill(buffer + read, buffer + size, 0);
+    return read;
+}
+
+bool PcmAudioFile::seek(int64_t offset)
+{
+    if (offset < 0 || static_cast<size_t>(offset) > size())
+        return false;
+
+    position_ = static_cast<size_t>(offset);
+    return true;
+}
+
+auto PcmAudioFile::pcm() const -> std::shared_ptr<const Data>
+{
+    return header_ == nullptr ? nullptr : data_;
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_CODECS_PCMAUDIOFILE_H_
+#define AUDIO_CODECS_PCMAUDIOFILE_H_
+
+#include <array>
+#include <memory>
+
+#include "Audio/AudioFile.h"
+#include "Common/Data.h"
+#include "Cooker/Formats.h"
+
+namespace rainbow::audio
+{
+    /// <summary>16-bit PCM pre-decoded by the asset cooker.</summary>
+    class PcmAudioFile final : public IAudioFile
+    {
+    public:
+        static bool signature_matches(const std::array<uint8_t, 8>& signature);
+
+        /// <summary>
+        ///   Decodes all of <paramref name="file"/> into a buffer that can be
+        ///   played back by <see cref="PcmAudioFile"/>.
+        /// </summary>
+        /// <returns>
+        ///   The decoded buffer; empty if the file could not be decoded.
+        /// </returns>
+        static auto decode(IAudioFile& file) -> Data;
+
+        /// <summary>
+        ///   Returns the header of the buffer that <see cref="decode"/> would
+        ///   create for <paramref name="file"/>.
+        /// </summary>
+        static auto make_header(const IAudioFile& file) -> cooker::PCMHeader;
+
+        explicit PcmAudioFile(Data data);
+
+        /// <summary>
+        ///   Plays back a buffer shared with other files, e.g. one from the
+        ///   <see cref="AssetCache"/>.
+        /// </summary>
+        explicit PcmAudioFile(std::shared_ptr<const Data> data);
+
+        auto channels() const -> int override;
+        auto rate() const -> int override;
+        auto size() const -> size_t override;
+
+        auto read(void*, size_t) -> size_t override;
+        bool seek(int64_t) override;
+        auto pcm() const -> std::shared_ptr<const Data> override;
+
+        explicit operator bool() const override { return header_ != nullptr; }
+
+    private:
+        std::shared_ptr<const Data> data_;
+        const cooker::PCMHeader* header_;
+        size_t position_ = 0;
+    };
+}  // namespace rainbow::audio
+
+#endif
@@ -0,0 +1,135 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Audio/Mixing.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define USE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define USE_NEON 1
+#endif
+
+using rainbow::audio::Resampler;
+
+namespace
+{
+    constexpr float kSampleScale = 1.0F / 32768.0F;
+}  // namespace
+
+void rainbow::audio::clamp(float* samples, size_t count)
+{
+    size_t i = 0;
+#if defined(USE_SSE2)
+    const auto lower = _mm_set1_ps(-1.0F);
+    const auto upper = _mm_set1_ps(1.0F);
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto s = _mm_loadu_ps(samples + i);
+        _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(s, lower), upper));
+    }
+#elif defined(USE_NEON)
+    const auto lower = vdupq_n_f32(-1.0F);
+    const auto upper = vdupq_n_f32(1.0F);
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto s = vld1q_f32(samples + i);
+        vst1q_f32(samples + i, vminq_f32(vmaxq_f32(s, lower), upper));
+    }
+#endif
+    for (; i < count; ++i)
+        samples[i] = std::clamp(samples[i], -1.0F, 1.0F);
+}
+
+void rainbow::audio::mix(float* out,
+                         const int16_t* samples,
+                         size_t count,
+                         float volume)
+{
+    const float gain = volume * kSampleScale;
+    size_t i = 0;
+#if defined(USE_SSE2)
+    const auto g = _mm_set1_ps(gain);
+    for (; i + 8 <= count; i += 8)
+    {
+        const auto s =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        // Sign-extend by unpacking into the upper halves and shifting back.
+        const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(out + i,
+                      _mm_add_ps(_mm_loadu_ps(out + i),
+                                 _mm_mul_ps(_mm_cvtepi32_ps(lo), g)));
+        _mm_storeu_ps(out + i + 4,
+                      _mm_add_ps(_mm_loadu_ps(out + i + 4),
+                                 _mm_mul_ps(_mm_cvtepi32_ps(hi), g)));
+    }
+#elif defined(USE_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        const auto s = vld1q_s16(samples + i);
+        const auto lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+        const auto hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+        vst1q_f32(out + i, vmlaq_n_f32(vld1q_f32(out + i), lo, gain));
+        vst1q_f32(out + i + 4, vmlaq_n_f32(vld1q_f32(out + i + 4), hi, gain));
+    }
+#endif
+    for (; i < count; ++i)
+        out[i] += samples[i] * gain;
+}
+
+void Resampler::reset(int channels, int rate, int output_rate)
+{
+    channels_ = channels;
+    step_ = static_cast<uint32_t>((static_cast<uint64_t>(rate) << 16) /
+                                  static_cast<uint64_t>(output_rate));
+
+    // Start two frames behind so that both ends of the first interpolation
+    // are read from the source.
+    phase_ = 2 * kOne;
+    previous_.fill(0);
+    next_.fill(0);
+}
+
+auto Resampler::process(const int16_t* in,
+                        size_t in_frames,
+                        size_t& consumed,
+                        int16_t* out,
+                        size_t out_frames) -> size_t
+{
+    consumed = 0;
+    size_t written = 0;
+    while (written < out_frames)
+    {
+        while (phase_ >= kOne)
+        {
+            if (consumed == in_frames)
+                return written;
+
+            const auto frame = in + consumed * channels_;
+            previous_ = next_;
+            next_[0] = frame[0];
+            next_[1] = channels_ == 1 ? frame[0] : frame[1];
+            phase_ -= kOne;
+            ++consumed;
+        }
+
+        for (int c = 0; c < kOutputChannels; ++c)
+        {
+            const int64_t delta = next_[c] - previous_[c];
+            out[c] =
+                static_cast<int16_t>(previous_[c] + ((delta * phase_) >> 16));
+        }
+
+        out += kOutputChannels;
+        phase_ += step_;
+        ++written;
+    }
+
+    return written;
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_MIXING_H_
+#define AUDIO_MIXING_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace rainbow::audio
+{
+    /// <summary>Number of channels the software mixer outputs.</summary>
+    constexpr int kOutputChannels = 2;
+
+    /// <summary>Clamps samples to [-1, 1].</summary>
+    void clamp(float* samples, size_t count);
+
+    /// <summary>
+    ///   Adds <paramref name="count"/> 16-bit samples, scaled by
+    ///   <paramref name="volume"/>, to <paramref name="out"/>.
+    /// </summary>
+    void mix(float* out, const int16_t* samples, size_t count, float volume);
+
+    /// <summary>
+    ///   Converts interleaved 16-bit frames to stereo at another sample rate,
+    ///   using linear interpolation.
+    /// </summary>
+    /// <remarks>
+    ///   Mono sources are duplicated to both channels. Only the first two
+    ///   channels of sources with more than two channels are kept.
+    /// </remarks>
+    class Resampler
+    {
+    public:
+        /// <summary>Prepares the resampler for a new source.</summary>
+        void reset(int channels, int rate, int output_rate);
+
+        /// <summary>
+        ///   Resamples up to <paramref name="in_frames"/> frames from
+        ///   <paramref name="in"/> into at most <paramref name="out_frames"/>
+        ///   stereo frames.
+        /// </summary>
+        /// <param name="consumed">
+        ///   Set to the number of input frames that were used up.
+        /// </param>
+        /// <returns>Number of frames written.</returns>
+        auto process(const int16_t* in,
+                     size_t in_frames,
+                     size_t& consumed,
+                     int16_t* out,
+                     size_t out_frames) -> size_t;
+
+    private:
+        static constexpr uint32_t kOne = 1U << 16;
+
+        int channels_ = 0;
+        uint32_t step_ = kOne;
+        uint32_t phase_ = 0;
+        std::array<int16_t, kOutputChannels> previous_{};
+        std::array<int16_t, kOutputChannels> next_{};
+    };
+}  // namespace rainbow::audio
+
+#endif
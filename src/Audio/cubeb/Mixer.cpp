@@ -4,22 +4,62 @@
 
 #include "Audio/cubeb/Mixer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+#include "Audio/Codecs/PcmAudioFile.h"
 #include "Common/Error.h"
 #include "Common/Logging.h"
 
 using rainbow::czstring;
+using rainbow::Data;
+using rainbow::RingBuffer;
 using rainbow::audio::Channel;
+using rainbow::audio::ChannelQueue;
 using rainbow::audio::ChannelState;
 using rainbow::audio::CubebMixer;
+using rainbow::audio::IAudioFile;
+using rainbow::audio::kOutputChannels;
+using rainbow::audio::PcmAudioFile;
 using rainbow::audio::Sound;
 
 namespace
 {
     constexpr uint32_t kBufferSamples = 512;
+    constexpr uint32_t kDefaultSampleRate = 44100;
+
+    /// <summary>Maximum number of frames mixed at a time.</summary>
+    constexpr size_t kMixFrames = 512;
+
+    /// <summary>Number of frames decoded ahead for streamed sounds.</summary>
+    constexpr size_t kStreamFrames = 8192;
+
+    /// <summary>
+    ///   Number of frames the decoder thread decodes before a streamed sound
+    ///   starts playing.
+    /// </summary>
+    constexpr size_t kPrefillFrames = 2048;
+
+    /// <summary>
+    ///   Number of bytes the decoder thread decodes into memory between
+    ///   topping up streams.
+    /// </summary>
+    constexpr size_t kDecodeChunkSize = 64 * 1024;
+
+    /// <summary>How often the decoder thread tops up streams.</summary>
+    constexpr auto kDecodeInterval = std::chrono::milliseconds(10);
+
+    /// <summary>
+    ///   Number of commands per channel that can be queued for the audio
+    ///   thread before they start piling up on the game thread.
+    /// </summary>
+    constexpr int kCommandsPerChannel = 8;
 
     CubebMixer* cubeb_mixer = nullptr;
 
-    auto as_index(Sound* sound)
+    auto as_index(const Sound* sound)
     {
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
         return reinterpret_cast<intptr_t>(sound);
@@ -27,34 +67,160 @@ namespace
 
     void reset_channel(Channel& ch)
     {
-        cubeb_stream_stop(ch.stream);
-        cubeb_stream_destroy(ch.stream);
-        ch.stream = nullptr;
         ch.source.reset();
         ch.source_index = 0;
-        ch.state = ChannelState::Stopped;
         ch.loop_count = 0;
+        ch.volume = 1.0F;
+        ch.input.reset();
+        ch.input_size = 0;
+        ch.input_offset = 0;
+        ch.stream.reset();
+        ch.end_of_stream = false;
+        ch.ready = false;
+    }
+
+    /// <summary>Returns whether a channel has no more data to play.</summary>
+    auto is_exhausted(const Channel& ch)
+    {
+        return ch.stream == nullptr ||
+               (ch.end_of_stream && ch.stream->empty());
+    }
+
+    /// <summary>
+    ///   Takes one loop, if there are any left. The game thread may set the
+    ///   loop count at any time.
+    /// </summary>
+    auto take_loop(Channel& ch)
+    {
+        auto count = ch.loop_count.load();
+        while (count > 0)
+        {
+            if (ch.loop_count.compare_exchange_weak(count, count - 1))
+                return true;
+        }
+        return false;
+    }
+
+    /// <summary>
+    ///   Reads up to <paramref name="frames"/> frames, rewinding the source
+    ///   while there are loops left.
+    /// </summary>
+    auto read_frames(Channel& ch, int16_t* dst, size_t frames) -> size_t
+    {
+        auto& source = *ch.source;
+        const auto frame_size = source.channels() * sizeof(int16_t);
+        auto read = source.read(dst, frames * frame_size) / frame_size;
+        while (read < frames && take_loop(ch))
+        {
+            source.rewind();
+            const auto additional_read =
+                source.read(dst + read * source.channels(),
+                            (frames - read) * frame_size) /
+                frame_size;
+            if (additional_read == 0)
+                break;
+
+            read += additional_read;
+        }
+        return read;
+    }
+
+    /// <summary>
+    ///   Reads up to <paramref name="frames"/> frames on the audio thread.
+    ///   Streamed sounds are read from what the decoder thread has decoded.
+    /// </summary>
+    auto pull_frames(Channel& ch, int16_t* dst, size_t frames) -> size_t
+    {
+        if (ch.stream == nullptr)
+            return read_frames(ch, dst, frames);
+
+        const auto channels = ch.source->channels();
+        const auto available = ch.stream->size() / channels;
+        const auto count = std::min(frames, available) * channels;
+        return ch.stream->pop(dst, count) / channels;
+    }
+
+    auto data_callback(cubeb_stream* /* stream */,
+                       void* user_data,
+                       const void* /* input_buffer */,
+                       void* output_buffer,
+                       long num_frames) -> long
+    {
+        auto& mixer = *static_cast<CubebMixer*>(user_data);
+        mixer.mix(static_cast<float*>(output_buffer),
+                  static_cast<size_t>(num_frames));
+        return num_frames;
     }
 
     void state_callback(cubeb_stream* /* stream */,
-                        void* user_data,
+                        void* /* user_data */,
                         cubeb_state state)
     {
-        switch (state)
+        if (state == CUBEB_STATE_ERROR)
+            LOGE("cubeb: Output stream stopped due to an error");
+    }
+}  // namespace
+
+ChannelQueue::ChannelQueue(int max_channels)
+    : commands_(max_channels * kCommandsPerChannel),
+      events_(max_channels * 2)
+{
+}
+
+void ChannelQueue::apply_commands()
+{
+    Command command;
+    while (commands_.pop(command))
+    {
+        auto& ch = *command.channel;
+        switch (command.type)
         {
-            case CUBEB_STATE_DRAINED:
-            case CUBEB_STATE_ERROR:
-            {
-                auto& channel = *static_cast<Channel*>(user_data);
-                cubeb_mixer->release_channel(channel);
+            case CommandType::Play:
+                ch.mix_state = ChannelState::Playing;
                 break;
-            }
-
-            default:
+            case CommandType::Pause:
+                if (ch.mix_state == ChannelState::Playing)
+                    ch.mix_state = ChannelState::Paused;
+                break;
+            case CommandType::Resume:
+                if (ch.mix_state == ChannelState::Paused)
+                    ch.mix_state = ChannelState::Playing;
+                break;
+            case CommandType::Stop:
+                ch.mix_state = ChannelState::Stopped;
+                push(Event{EventType::Stopped, &ch});
+                break;
+            case CommandType::SetVolume:
+                ch.volume = command.volume;
                 break;
         }
     }
-}  // namespace
+}
+
+void ChannelQueue::finish(Channel& channel)
+{
+    channel.mix_state = ChannelState::Stopped;
+    push(Event{EventType::Finished, &channel});
+}
+
+void ChannelQueue::flush()
+{
+    const auto sent = commands_.push(pending_.data(), pending_.size());
+    pending_.erase(pending_.begin(), pending_.begin() + sent);
+}
+
+void ChannelQueue::send(CommandType type, Channel& channel, float volume)
+{
+    const Command command{type, &channel, volume};
+    if (!pending_.empty() || !commands_.push(command))
+        pending_.push_back(command);
+}
+
+void ChannelQueue::push(const Event& event)
+{
+    [[maybe_unused]] const bool pushed = events_.push(event);
+    R_ASSERT(pushed, "Event queue should never be full");
+}
 
 bool CubebMixer::initialize(int max_channels)
 {
@@ -67,13 +233,49 @@ bool CubebMixer::initialize(int max_channels)
 
     LOGI("cubeb: Using %s backend", cubeb_get_backend_id(context_));
 
-    drain_.reserve(max_channels);
-    thread_id_ = std::this_thread::get_id();
-    channels_ = BoundedPool<Channel>{
-        []() -> Channel {
-            return {nullptr, nullptr, 0, ChannelState::Stopped, 0};
-        },
-        max_channels};
+    uint32_t rate = 0;
+    if (cubeb_get_preferred_sample_rate(context_, &rate) != CUBEB_OK ||
+        rate == 0)
+    {
+        LOGW("cubeb: Failed to get preferred sample rate");
+        rate = kDefaultSampleRate;
+    }
+
+    cubeb_stream_params stream_params{
+        /* format */ CUBEB_SAMPLE_FLOAT32NE,
+        /* rate */ rate,
+        /* channels */ kOutputChannels,
+        /* layout */ CUBEB_LAYOUT_STEREO,
+        /* prefs */ CUBEB_STREAM_PREF_NONE,
+    };
+    uint32_t latency = 0;
+    if (cubeb_get_min_latency(context_, &stream_params, &latency) != CUBEB_OK)
+        LOGW("cubeb: Failed to get minimum latency");
+
+    max_channels_ = max_channels;
+    rate_ = static_cast<int>(rate);
+    channels_ = std::make_unique<Channel[]>(max_channels);
+    retired_.reserve(max_channels);
+    queue_ = std::make_unique<ChannelQueue>(max_channels);
+    scratch_ = std::make_unique<int16_t[]>(kMixFrames * kOutputChannels);
+    decoder_ = std::thread([this] { run_decoder(); });
+
+    const auto result = cubeb_stream_init(context_,
+                                          &stream_,
+                                          "Rainbow Audio",
+                                          nullptr,
+                                          nullptr,
+                                          nullptr,
+                                          &stream_params,
+                                          std::max(kBufferSamples, latency),
+                                          &data_callback,
+                                          &state_callback,
+                                          this);
+    if (result != CUBEB_OK || cubeb_stream_start(stream_) != CUBEB_OK)
+    {
+        LOGF("cubeb: Failed to start output stream");
+        return false;
+    }
 
     cubeb_mixer = this;
     return true;
@@ -81,157 +283,588 @@ bool CubebMixer::initialize(int max_channels)
 
 void CubebMixer::clear()
 {
-    for_each(channels_, [this](auto&& ch) {
-        if (ch.state != ChannelState::Stopped)
-            release_channel(ch);
+    std::for_each_n(channels_.get(), max_channels_, [this](auto&& ch) {
+        release_channel(ch);
     });
     process();
+    for (auto&& [_, sound] : sounds_)
+        evict(sound);
     sounds_.clear();
 }
 
 void CubebMixer::process()
 {
-    std::lock_guard<std::mutex> guard(drain_lock_);
-    if (!drain_.empty())
-    {
-        for (auto&& ch : drain_)
-            release_channel(*ch);
-        drain_.clear();
-    }
+    queue_->flush();
+
+    // There are no mixes while the stream is stopped.
+    if (suspended_)
+        queue_->apply_commands();
+
+    queue_->handle_events([this](Channel& ch) { retire(ch); });
+
+    if (pending_decodes_ > 0)
+        collect_decoded();
+
+    // A stopped channel may still be read by a decoder pass that was already
+    // in progress. Wait until it has finished before letting go of the source.
+    const auto decodes = decodes_.load();
+    auto i = std::remove_if(
+        retired_.begin(), retired_.end(), [this, decodes](Channel* ch) {
+            if (decodes <= ch->decodes_at_stop)
+                return false;
+
+            // A sound in memory that stops playing may be dropped to make
+            // room for another.
+            if (ch->stream == nullptr)
+                ++releases_;
+
+            reset_channel(*ch);
+            return true;
+        });
+    retired_.erase(i, retired_.end());
+
+    reclaim();
 }
 
 void CubebMixer::suspend(bool should_suspend)
 {
-    suspend(should_suspend ? &cubeb_stream_stop : &cubeb_stream_start);
+    if (stream_ == nullptr || should_suspend == suspended_)
+        return;
+
+    if (should_suspend)
+        cubeb_stream_stop(stream_);
+    else
+        cubeb_stream_start(stream_);
+    suspended_ = should_suspend;
 }
 
-auto CubebMixer::create_stream(Sound* source) -> Channel*
+void CubebMixer::mix(float* out, size_t frames)
 {
-    if (channels_.empty())
-        return nullptr;
+    queue_->apply_commands();
+
+    std::fill_n(out, frames * kOutputChannels, 0.0F);
 
-    const auto index = as_index(source);
-    auto path = sounds_[index].c_str();
-    auto audio_file = IAudioFile::open(path);
-    if (!*audio_file)
+    for (size_t offset = 0; offset < frames; offset += kMixFrames)
+    {
+        auto buffer = out + offset * kOutputChannels;
+        const auto count = std::min(frames - offset, kMixFrames);
+        std::for_each_n(channels_.get(), max_channels_, [&](auto&& ch) {
+            if (ch.mix_state != ChannelState::Playing || !ch.ready ||
+                render(ch, buffer, count))
+            {
+                return;
+            }
+
+            queue_->finish(ch);
+        });
+    }
+
+    clamp(out, frames * kOutputChannels);
+}
+
+auto CubebMixer::play(Sound* sound) -> Channel*
+{
+    auto channel =
+        std::find_if(channels_.get(),
+                     channels_.get() + max_channels_,
+                     [](auto&& ch) {
+                         return ch.state == ChannelState::Stopped &&
+                                ch.source == nullptr;
+                     });
+    if (channel == channels_.get() + max_channels_)
         return nullptr;
 
-    cubeb_stream_params stream_params{
-        /* format */ CUBEB_SAMPLE_S16LE,
-        /* rate */ static_cast<uint32_t>(audio_file->rate()),
-        /* channels */ static_cast<uint32_t>(audio_file->channels()),
-        /* layout */ audio_file->channels() == 1
-            ? static_cast<cubeb_channel_layout>(CUBEB_LAYOUT_MONO)
-            : static_cast<cubeb_channel_layout>(CUBEB_LAYOUT_STEREO),
-        /* prefs */ CUBEB_STREAM_PREF_NONE,
-    };
-    uint32_t latency = 0;
-    if (cubeb_get_min_latency(context_, &stream_params, &latency) != CUBEB_OK)
-        LOGW("cubeb: Failed to get minimum latency");
+    const auto index = as_index(sound);
+    auto& data = sounds_[index];
+    data.last_played = ++clock_;
 
-    auto& channel = *channels_.next();
-    channel.source = std::move(audio_file);
-    channel.source_index = index;
-
-    auto process = []([[maybe_unused]] cubeb_stream* stream,
-                      void* user_data,
-                      const void* /* input_buffer */,
-                      void* output_buffer,
-                      long num_frames) -> long {
-        NOT_USED(stream);
-        auto& channel = *static_cast<Channel*>(user_data);
-        R_ASSERT(stream == channel.stream, "This shouldn't happen.");
-        auto& source = *channel.source;
-        const auto frame_size = source.channels() * sizeof(int16_t);
-        const auto read = source.read(output_buffer, num_frames * frame_size);
-        const auto frames = static_cast<long>(read / frame_size);
-        if (frames < num_frames && channel.loop_count > 0)
-        {
-            --channel.loop_count;
-            source.rewind();
-            const auto additional_read =
-                source.read(static_cast<uint8_t*>(output_buffer) + read,
-                            (num_frames - frames) * frame_size);
-            return static_cast<long>(frames + (additional_read / frame_size));
-        }
-        return frames;
-    };
+    std::unique_ptr<IAudioFile> audio_file;
+    if (data.pcm != nullptr)
+    {
+        audio_file = std::make_unique<PcmAudioFile>(data.pcm);
+    }
+    else
+    {
+        audio_file = IAudioFile::open(data.path.c_str());
+        if (!*audio_file)
+            return nullptr;
+
+        // Sounds that were dropped to make room are decoded again on the
+        // decoder thread, and streamed in the meantime.
+        if (data.decode && !data.decoding && data.no_room_at != releases_)
+            request_decode(index, data, *audio_file);
+    }
 
-    const auto result = cubeb_stream_init(context_,
-                                          &channel.stream,
-                                          "Rainbow Audio",
-                                          nullptr,
-                                          nullptr,
-                                          nullptr,
-                                          &stream_params,
-                                          std::max(kBufferSamples, latency),
-                                          process,
-                                          &state_callback,
-                                          &channel);
-    if (result != CUBEB_OK)
+    auto& ch = *channel;
+    ch.passthrough = audio_file->rate() == rate_ &&
+                     audio_file->channels() == kOutputChannels;
+    if (!ch.passthrough)
     {
-        LOGE("Failed to initialize stream for '%s'", path);
-        return nullptr;
+        ch.resampler.reset(audio_file->channels(), audio_file->rate(), rate_);
+        ch.input =
+            std::make_unique<int16_t[]>(kMixFrames * audio_file->channels());
+    }
+    ch.source = std::move(audio_file);
+    ch.source_index = index;
+
+    // Streamed sounds are decoded ahead on the decoder thread, and start
+    // playing once it has decoded the first block.
+    const bool streamed = data.pcm == nullptr;
+    if (streamed)
+    {
+        ch.stream = std::make_unique<RingBuffer<int16_t>>(
+            kStreamFrames * ch.source->channels());
+    }
+    else
+    {
+        ch.ready = true;
     }
-    return &channel;
+
+    ch.state = ChannelState::Playing;
+    queue_->send(CommandType::Play, ch);
+    if (streamed)
+        wake_decoder();
+    return &ch;
 }
 
-void CubebMixer::release_channel(Channel& channel)
+void CubebMixer::pause(Channel& channel)
 {
+    if (channel.state != ChannelState::Playing)
+        return;
+
+    channel.state = ChannelState::Paused;
+    queue_->send(CommandType::Pause, channel);
+}
 
-    if (std::this_thread::get_id() != thread_id_)
+auto CubebMixer::resume(Channel& channel) -> bool
+{
+    switch (channel.state)
     {
-        std::lock_guard<std::mutex> guard(drain_lock_);
-        drain_.push_back(&channel);
+        case ChannelState::Stopped:
+            return false;
+        case ChannelState::Playing:
+            return true;
+        case ChannelState::Paused:
+            break;
+    }
+
+    channel.state = ChannelState::Playing;
+    queue_->send(CommandType::Resume, channel);
+    return true;
+}
+
+void CubebMixer::release_channel(Channel& channel)
+{
+    if (channel.state.exchange(ChannelState::Stopped) == ChannelState::Stopped)
+        return;
+
+    // The channel is retired once the audio thread has let go of it.
+    queue_->send(CommandType::Stop, channel);
+}
+
+void CubebMixer::set_loop_count(Channel& channel, int count)
+{
+    if (channel.state == ChannelState::Stopped)
         return;
+
+    channel.loop_count = count;
+
+    // The decoder may already have reached the end of a streamed sound,
+    // e.g. if it is shorter than what is decoded ahead. The source is kept
+    // until the channel is released, so it can still be rewound.
+    if (count > 0 && channel.stream != nullptr &&
+        channel.end_of_stream.exchange(false))
+    {
+        wake_decoder();
     }
+}
+
+void CubebMixer::set_volume(Channel& channel, float volume)
+{
+    if (channel.state == ChannelState::Stopped)
+        return;
 
-    reset_channel(channel);
-    channels_.release(channel);
+    queue_->send(CommandType::SetVolume, channel, volume);
 }
 
 void CubebMixer::remove_path(intptr_t index)
 {
-    for_each(channels_, [this, index](auto&& ch) {
+    std::for_each_n(channels_.get(), max_channels_, [this, index](auto&& ch) {
         if (ch.source_index == index)
             release_channel(ch);
     });
-    sounds_.erase(index);
+
+    auto i = sounds_.find(index);
+    if (i == sounds_.end())
+        return;
+
+    evict(i->second);
+    sounds_.erase(i);
 }
 
-auto CubebMixer::store_path(czstring path) -> intptr_t
+auto CubebMixer::store_path(czstring path, bool decode) -> intptr_t
 {
     static intptr_t index = 0;
-    auto [i, _] = sounds_.insert_or_assign(++index, path);
+    auto [i, _] =
+        sounds_.insert_or_assign(++index, SoundData{path, nullptr, decode, 0});
     NOT_USED(_);
+
+    if (decode)
+        this->decode(i->second);
     return i->first;
 }
 
+#ifdef RAINBOW_TEST
+auto CubebMixer::is_decoded(const Sound* sound) const -> bool
+{
+    auto i = sounds_.find(as_index(sound));
+    return i != sounds_.end() && i->second.pcm != nullptr;
+}
+#endif
+
 CubebMixer::~CubebMixer()
 {
-    for_each(channels_, [](auto&& ch) {
-        if (ch.state != ChannelState::Stopped)
-            reset_channel(ch);
-    });
+    if (stream_ != nullptr)
+    {
+        cubeb_stream_stop(stream_);
+        cubeb_stream_destroy(stream_);
+    }
+
+    if (decoder_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(decoder_lock_);
+            decoder_should_quit_ = true;
+        }
+        decoder_wake_.notify_one();
+        decoder_.join();
+    }
+
     cubeb_destroy(context_);
 }
 
-void CubebMixer::suspend(int (*suspend)(cubeb_stream* stream))
+void CubebMixer::collect_decoded()
 {
-    for_each(channels_, [suspend](auto&& ch) {
-        if (ch.state == ChannelState::Playing)
-            suspend(ch.stream);
-    });
+    std::vector<DecodeResult> results;
+    {
+        std::lock_guard<std::mutex> guard(decoder_lock_);
+        results.swap(decode_results_);
+    }
+
+    pending_decodes_ -= results.size();
+    for (auto&& result : results)
+    {
+        auto i = sounds_.find(result.index);
+        if (i == sounds_.end() || result.pcm == nullptr)
+        {
+            // The sound was released, or could not be decoded.
+            release_decoded(result.size);
+            if (i != sounds_.end())
+            {
+                i->second.decoding = false;
+                i->second.decode = false;
+            }
+            continue;
+        }
+
+        auto& sound = i->second;
+        sound.decoding = false;
+        sound.decoded_size = result.size;
+        sound.pcm = std::move(result.pcm);
+    }
+}
+
+void CubebMixer::decode(SoundData& sound)
+{
+    auto file = IAudioFile::open(sound.path.c_str());
+    if (!*file)
+        return;
+
+    // Cooked sounds are already in the format that is played back.
+    if (auto pcm = file->pcm())
+    {
+        sound.pcm = std::move(pcm);
+        return;
+    }
+
+    const auto size = sizeof(cooker::PCMHeader) + file->size();
+    if (!make_room(sound, size))
+        return;
+
+    auto data = PcmAudioFile::decode(*file);
+    if (!data)
+    {
+        sound.decode = false;
+        return;
+    }
+
+    sound.decoded_size = data.size();
+    sound.pcm = std::make_shared<const Data>(std::move(data));
+    decoded_size_ += sound.decoded_size;
+}
+
+auto CubebMixer::decode_some(DecodeJob& job) -> bool
+{
+    constexpr auto kHeaderSize = sizeof(cooker::PCMHeader);
+
+    if (job.file == nullptr)
+    {
+        job.file = IAudioFile::open(job.path.c_str());
+        if (!*job.file || kHeaderSize + job.file->size() != job.size)
+            return true;
+
+        const auto header = PcmAudioFile::make_header(*job.file);
+        job.buffer = std::make_unique<uint8_t[]>(job.size);
+        std::memcpy(job.buffer.get(), &header, kHeaderSize);
+        job.offset = kHeaderSize;
+    }
+
+    const auto size = std::min(job.size - job.offset, kDecodeChunkSize);
+    if (job.file->read(job.buffer.get() + job.offset, size) != size)
+    {
+        LOGE("cubeb: Failed to decode '%s'", job.path.c_str());
+        job.buffer.reset();
+        return true;
+    }
+
+    job.offset += size;
+    return job.offset == job.size;
+}
+
+void CubebMixer::evict(SoundData& sound)
+{
+    if (sound.pcm == nullptr)
+        return;
+
+    // Channels that are still playing the sound keep it in memory.
+    if (sound.decoded_size > 0 && sound.pcm.use_count() > 1)
+        evicted_.push_back(std::move(sound.pcm));
+    else
+        release_decoded(sound.decoded_size);
+
+    sound.pcm.reset();
+    sound.decoded_size = 0;
+}
+
+void CubebMixer::reclaim()
+{
+    auto i = std::remove_if(
+        evicted_.begin(), evicted_.end(), [this](auto&& pcm) {
+            if (pcm.use_count() > 1)
+                return false;
+
+            release_decoded(pcm->size());
+            return true;
+        });
+    evicted_.erase(i, evicted_.end());
+}
+
+void CubebMixer::release_decoded(size_t size)
+{
+    decoded_size_ -= size;
+    ++releases_;
+}
+
+auto CubebMixer::make_room(SoundData& sound, size_t size) -> bool
+{
+    if (size > max_decoded_size_)
+    {
+        LOGW("cubeb: '%s' is too large to be kept in memory (%zu bytes)",
+             sound.path.c_str(),
+             size);
+        sound.decode = false;
+        return false;
+    }
+
+    reclaim();
+    while (decoded_size_ + size > max_decoded_size_)
+    {
+        SoundData* lru = nullptr;
+        for (auto&& [_, data] : sounds_)
+        {
+            if (data.decoded_size == 0 || data.pcm.use_count() > 1)
+                continue;
+
+            if (lru == nullptr || data.last_played < lru->last_played)
+                lru = &data;
+        }
+
+        if (lru == nullptr)
+        {
+            LOGW("cubeb: Decoded sounds limit reached, streaming '%s'",
+                 sound.path.c_str());
+            sound.no_room_at = releases_;
+            return false;
+        }
+
+        evict(*lru);
+    }
+
+    return true;
+}
+
+void CubebMixer::request_decode(intptr_t index,
+                                SoundData& sound,
+                                const IAudioFile& file)
+{
+    // Cooked sounds are already in the format that is played back.
+    if (auto pcm = file.pcm())
+    {
+        sound.pcm = std::move(pcm);
+        return;
+    }
+
+    const auto size = sizeof(cooker::PCMHeader) + file.size();
+    if (!make_room(sound, size))
+        return;
+
+    // Reserve room for the sound while it is being decoded.
+    decoded_size_ += size;
+    sound.decoding = true;
+    ++pending_decodes_;
+    {
+        std::lock_guard<std::mutex> guard(decoder_lock_);
+        decode_jobs_.push_back({index, sound.path, size, nullptr, nullptr, 0});
+    }
+    wake_decoder();
+}
+
+auto CubebMixer::render(Channel& ch, float* out, size_t frames) -> bool
+{
+    auto scratch = scratch_.get();
+    if (ch.passthrough)
+    {
+        const auto read = pull_frames(ch, scratch, frames);
+        audio::mix(out, scratch, read * kOutputChannels, ch.volume);
+        return read == frames || !is_exhausted(ch);
+    }
+
+    const auto channels = ch.source->channels();
+    size_t written = 0;
+    while (written < frames)
+    {
+        if (ch.input_offset == ch.input_size)
+        {
+            ch.input_size = pull_frames(ch, ch.input.get(), kMixFrames);
+            ch.input_offset = 0;
+            if (ch.input_size == 0)
+                break;
+        }
+
+        size_t consumed = 0;
+        written += ch.resampler.process(
+            ch.input.get() + ch.input_offset * channels,
+            ch.input_size - ch.input_offset,
+            consumed,
+            scratch + written * kOutputChannels,
+            frames - written);
+        ch.input_offset += consumed;
+    }
+
+    audio::mix(out, scratch, written * kOutputChannels, ch.volume);
+    return written == frames || !is_exhausted(ch);
+}
+
+void CubebMixer::retire(Channel& channel)
+{
+    channel.decodes_at_stop = decodes_.load();
+    retired_.push_back(&channel);
+}
+
+void CubebMixer::run_decoder()
+{
+    std::vector<int16_t> buffer;
+    std::vector<DecodeJob> jobs;
+    while (true)
+    {
+        std::for_each_n(channels_.get(), max_channels_, [&](auto&& ch) {
+            if (ch.state == ChannelState::Stopped || ch.stream == nullptr ||
+                ch.end_of_stream)
+            {
+                return;
+            }
+
+            // Decode a small block first, so that new channels start playing
+            // as soon as possible.
+            const auto channels = ch.source->channels();
+            const auto space = ch.stream->space() / channels;
+            const auto frames =
+                ch.ready ? space : std::min(space, kPrefillFrames);
+            if (frames == 0)
+                return;
+
+            buffer.resize(frames * channels);
+            const auto read = read_frames(ch, buffer.data(), frames);
+            ch.stream->push(buffer.data(), read * channels);
+            if (read < frames)
+            {
+                ch.end_of_stream = true;
+
+                // A loop may have been added after the read came up short.
+                // Either we see it here, or set_loop_count() sees that the
+                // stream has ended.
+                if (ch.loop_count > 0)
+                    ch.end_of_stream = false;
+            }
+            ch.ready = true;
+        });
+        ++decodes_;
+
+        // Sounds are decoded into memory a chunk at a time, so that streams
+        // are kept topped up meanwhile.
+        const bool done = !jobs.empty() && decode_some(jobs.front());
+
+        std::unique_lock<std::mutex> lock(decoder_lock_);
+        if (done)
+        {
+            auto& job = jobs.front();
+            std::shared_ptr<const Data> pcm;
+            if (job.buffer != nullptr)
+            {
+                pcm = std::make_shared<const Data>(job.buffer.release(),
+                                                   job.size,
+                                                   Data::Ownership::Owner);
+            }
+            decode_results_.push_back({job.index, job.size, std::move(pcm)});
+            jobs.erase(jobs.begin());
+        }
+
+        std::move(decode_jobs_.begin(),
+                  decode_jobs_.end(),
+                  std::back_inserter(jobs));
+        decode_jobs_.clear();
+
+        if (jobs.empty())
+        {
+            decoder_wake_.wait_for(lock, kDecodeInterval, [this] {
+                return decoder_should_wake_ || decoder_should_quit_;
+            });
+        }
+        if (decoder_should_quit_)
+            break;
+
+        decoder_should_wake_ = false;
+    }
+}
+
+void CubebMixer::wake_decoder()
+{
+    {
+        std::lock_guard<std::mutex> guard(decoder_lock_);
+        decoder_should_wake_ = true;
+    }
+    decoder_wake_.notify_one();
 }
 
 auto rainbow::audio::load_sound(czstring path) -> Sound*
 {
-    return load_stream(path);
+    auto index = cubeb_mixer->store_path(path, true);
+    return reinterpret_cast<Sound*>(index);
 }
 
 auto rainbow::audio::load_stream(czstring path) -> Sound*
 {
-    auto index = cubeb_mixer->store_path(path);
+    auto index = cubeb_mixer->store_path(path, false);
     return reinterpret_cast<Sound*>(index);
 }
 
@@ -247,8 +880,11 @@ bool rainbow::audio::is_paused(Channel* channel)
 
 bool rainbow::audio::is_playing(Channel* channel)
 {
-    return channel != nullptr && (channel->state == ChannelState::Playing ||
-                                  channel->state == ChannelState::Paused);
+    if (channel == nullptr)
+        return false;
+
+    const auto state = channel->state.load();
+    return state == ChannelState::Playing || state == ChannelState::Paused;
 }
 
 void rainbow::audio::set_loop_count(Channel* channel, int count)
@@ -256,7 +892,7 @@ void rainbow::audio::set_loop_count(Channel* channel, int count)
     if (channel == nullptr)
         return;
 
-    channel->loop_count = count;
+    cubeb_mixer->set_loop_count(*channel, count);
 }
 
 void rainbow::audio::set_volume(Channel* channel, float volume)
@@ -264,45 +900,35 @@ void rainbow::audio::set_volume(Channel* channel, float volume)
     if (channel == nullptr)
         return;
 
-    cubeb_stream_set_volume(channel->stream, volume);
+    cubeb_mixer->set_volume(*channel, volume);
 }
 
 void rainbow::audio::set_world_position(Channel*, Vec2f) {}
 
 void rainbow::audio::pause(Channel* channel)
 {
-    if (channel == nullptr || channel->stream == nullptr ||
-        channel->state == ChannelState::Paused)
-    {
+    if (channel == nullptr)
         return;
-    }
 
-    cubeb_stream_stop(channel->stream);
-    channel->state = ChannelState::Paused;
+    cubeb_mixer->pause(*channel);
 }
 
 auto rainbow::audio::play(Channel* channel) -> Channel*
 {
-    if (channel == nullptr || channel->stream == nullptr)
+    if (channel == nullptr)
         return nullptr;
 
-    if (channel->state == ChannelState::Playing)
-        return channel;
-
-    cubeb_stream_start(channel->stream);
-    channel->state = ChannelState::Playing;
-    return channel;
+    return cubeb_mixer->resume(*channel) ? channel : nullptr;
 }
 
 auto rainbow::audio::play(Sound* sound, Vec2f) -> Channel*
 {
-    auto channel = cubeb_mixer->create_stream(sound);
-    return play(channel);
+    return cubeb_mixer->play(sound);
 }
 
 void rainbow::audio::stop(Channel* channel)
 {
-    if (channel == nullptr || channel->state == ChannelState::Stopped)
+    if (channel == nullptr)
         return;
 
     cubeb_mixer->release_channel(*channel);
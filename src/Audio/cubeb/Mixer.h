@@ -5,9 +5,14 @@
 #ifndef AUDIO_CUBEB_MIXER_H_
 #define AUDIO_CUBEB_MIXER_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 // clang-format off
 #include "ThirdParty/DisableWarnings.h"
@@ -18,7 +23,10 @@
 
 #include "Audio/AudioFile.h"
 #include "Audio/Mixer.h"
-#include "Memory/BoundedPool.h"
+#include "Audio/Mixing.h"
+#include "Common/Data.h"
+#include "Common/NonCopyable.h"
+#include "Threading/RingBuffer.h"
 
 namespace rainbow::audio
 {
@@ -31,42 +39,441 @@ namespace rainbow::audio
         Paused,
     };
 
+    /// <summary>A voice in the software mixer.</summary>
+    /// <remarks>
+    ///   <c>state</c> is owned by the game thread, which forwards changes to
+    ///   the audio thread through <see cref="CubebMixer"/>'s command queue.
+    ///   The game thread only touches <c>source</c> while the channel is
+    ///   stopped. Sounds in memory are read by the audio thread while the
+    ///   channel is playing. Streamed sounds are read by the decoder thread,
+    ///   which keeps <c>stream</c> topped up for the audio thread.
+    /// </remarks>
     struct Channel
     {
-        cubeb_stream* stream;
         std::unique_ptr<IAudioFile> source;
-        intptr_t source_index;
-        ChannelState state;
-        int loop_count;
+        intptr_t source_index = 0;
+        std::atomic<ChannelState> state{ChannelState::Stopped};
+        std::atomic<int> loop_count{0};
+
+        /// <summary>State and volume as seen by the audio thread.</summary>
+        ChannelState mix_state = ChannelState::Stopped;
+        float volume = 1.0F;
+
+        /// <summary>
+        ///   Whether the source can be mixed as is, without resampling.
+        /// </summary>
+        bool passthrough = false;
+
+        /// <summary>Converts the source to the output format.</summary>
+        Resampler resampler;
+
+        /// <summary>Source frames waiting to be resampled.</summary>
+        std::unique_ptr<int16_t[]> input;
+        size_t input_size = 0;
+        size_t input_offset = 0;
+
+        /// <summary>Decoded frames of a streamed sound.</summary>
+        std::unique_ptr<RingBuffer<int16_t>> stream;
+
+        /// <summary>
+        ///   Set by the decoder thread when there is nothing more to decode.
+        /// </summary>
+        std::atomic<bool> end_of_stream{false};
+
+        /// <summary>
+        ///   Whether there is anything to play yet. Streamed sounds are ready
+        ///   once the decoder thread has decoded the first block.
+        /// </summary>
+        std::atomic<bool> ready{false};
+
+        /// <summary>
+        ///   Number of decoder passes done when the channel was stopped.
+        /// </summary>
+        uint64_t decodes_at_stop = 0;
     };
 
+    /// <summary>
+    ///   Passes channel commands from the game thread to the audio thread,
+    ///   and events back, without either side ever blocking the other.
+    /// </summary>
+    /// <remarks>
+    ///   Commands are applied by the audio thread at the start of each buffer.
+    ///   If the command ring is full, commands wait on the game thread and are
+    ///   sent in order on the next <see cref="flush"/>. The event ring never
+    ///   fills up, because a channel has at most one event of each kind
+    ///   outstanding and is not reused until the game thread has seen them.
+    /// </remarks>
+    class ChannelQueue : private NonCopyable<ChannelQueue>
+    {
+    public:
+        enum class CommandType
+        {
+            Play,
+            Pause,
+            Resume,
+            Stop,
+            SetVolume,
+        };
+
+        /// <summary>A request from the game thread.</summary>
+        struct Command
+        {
+            CommandType type;
+            Channel* channel;
+            float volume;
+        };
+
+        enum class EventType
+        {
+            /// <summary>The channel ran out of data.</summary>
+            Finished,
+
+            /// <summary>The channel was stopped by the game thread.</summary>
+            Stopped,
+        };
+
+        /// <summary>A notification from the audio thread.</summary>
+        struct Event
+        {
+            EventType type;
+            Channel* channel;
+        };
+
+        explicit ChannelQueue(int max_channels);
+
+        /// <summary>
+        ///   Returns the number of commands waiting for room in the ring.
+        /// </summary>
+        [[nodiscard]] auto pending() const { return pending_.size(); }
+
+        /// <summary>
+        ///   Applies queued commands. Audio thread, or game thread while
+        ///   there are no mixes.
+        /// </summary>
+        void apply_commands();
+
+        /// <summary>
+        ///   Stops a channel that ran out of data, and tells the game thread.
+        ///   Audio thread only.
+        /// </summary>
+        void finish(Channel&);
+
+        /// <summary>
+        ///   Sends commands that did not fit in the ring earlier. Game thread
+        ///   only.
+        /// </summary>
+        void flush();
+
+        /// <summary>
+        ///   Handles events from the audio thread. Calls
+        ///   <paramref name="retire"/> once for every channel that the audio
+        ///   thread has let go of. Game thread only.
+        /// </summary>
+        template <typename F>
+        void handle_events(F&& retire)
+        {
+            Event event;
+            while (events_.pop(event))
+            {
+                auto& ch = *event.channel;
+                switch (event.type)
+                {
+                    case EventType::Finished:
+                        // If the channel was stopped in the meantime, wait
+                        // for the audio thread to acknowledge it instead.
+                        if (ch.state.exchange(ChannelState::Stopped) !=
+                            ChannelState::Stopped)
+                        {
+                            retire(ch);
+                        }
+                        break;
+                    case EventType::Stopped:
+                        retire(ch);
+                        break;
+                }
+            }
+        }
+
+        /// <summary>
+        ///   Queues a command for the audio thread. Game thread only.
+        /// </summary>
+        void send(CommandType, Channel&, float volume = 0.0F);
+
+    private:
+        /// <summary>Commands for the audio thread.</summary>
+        RingBuffer<Command> commands_;
+
+        /// <summary>
+        ///   Commands that did not fit in the ring, sent on next
+        ///   <see cref="flush"/>.
+        /// </summary>
+        std::vector<Command> pending_;
+
+        /// <summary>Events for the game thread.</summary>
+        RingBuffer<Event> events_;
+
+        void push(const Event&);
+    };
+
+    /// <summary>
+    ///   Mixes all channels in software into a single cubeb stream.
+    /// </summary>
+    /// <remarks>
+    ///   Sounds loaded with <see cref="load_sound"/> are decoded once, and
+    ///   played back from memory by all channels. Sounds that were cooked to
+    ///   PCM are mapped instead. Decoded sounds that are not playing are
+    ///   dropped, least recently played first, to stay within
+    ///   <see cref="CubebMixer::kMaxDecodedSize"/>. Sounds that don't fit are
+    ///   streamed instead. Streamed sounds are decoded ahead on a separate
+    ///   thread, so that the audio thread never waits on disk or decoder.
+    ///   <para>
+    ///     The game thread never touches the audio thread's view of a channel
+    ///     directly. Commands are passed through a lock-free queue and applied
+    ///     at the start of the next buffer, and the audio thread reports back
+    ///     through another, so that neither side ever blocks the other.
+    ///   </para>
+    /// </remarks>
     class CubebMixer
     {
     public:
+        /// <summary>Maximum number of bytes of decoded sounds.</summary>
+        static constexpr size_t kMaxDecodedSize = 16 * 1024 * 1024;
+
         bool initialize(int max_channels);
 
         void clear();
         void process();
         void suspend(bool should_suspend);
 
-        auto create_stream(Sound*) -> Channel*;
+        /// <summary>
+        ///   Mixes <paramref name="frames"/> frames of all playing channels
+        ///   into <paramref name="out"/>. Called on the audio thread.
+        /// </summary>
+        void mix(float* out, size_t frames);
+
+        /// <summary>Starts playing a sound on a free channel.</summary>
+        auto play(Sound*) -> Channel*;
+
+        void pause(Channel&);
+        auto resume(Channel&) -> bool;
         void release_channel(Channel&);
+        void set_loop_count(Channel&, int count);
+        void set_volume(Channel&, float volume);
 
         void remove_path(intptr_t index);
-        auto store_path(czstring path) -> intptr_t;
+
+        /// <summary>Stores the path to a sound.</summary>
+        /// <param name="path">Path to the sound.</param>
+        /// <param name="decode">
+        ///   Whether the sound should be decoded up front.
+        /// </param>
+        auto store_path(czstring path, bool decode) -> intptr_t;
+
+#ifdef RAINBOW_TEST
+        [[nodiscard]] auto decoded_size() const { return decoded_size_; }
+
+        void set_max_decoded_size(size_t size) { max_decoded_size_ = size; }
+
+        [[nodiscard]] auto is_decoded(const Sound*) const -> bool;
+#endif
 
     protected:
         ~CubebMixer();
 
     private:
-        std::mutex drain_lock_;
-        std::vector<Channel*> drain_;
-        std::thread::id thread_id_;
-        BoundedPool<Channel> channels_;
-        absl::flat_hash_map<intptr_t, std::string> sounds_;
+        using CommandType = ChannelQueue::CommandType;
+
+        struct SoundData
+        {
+            std::string path;
+
+            /// <summary>Decoded sound, if it is in memory.</summary>
+            std::shared_ptr<const Data> pcm;
+
+            /// <summary>Whether the sound should be kept decoded.</summary>
+            bool decode = false;
+
+            /// <summary>When the sound was last played.</summary>
+            uint64_t last_played = 0;
+
+            /// <summary>
+            ///   Number of bytes decoded into <c>pcm</c>; zero if it was
+            ///   mapped.
+            /// </summary>
+            size_t decoded_size = 0;
+
+            /// <summary>
+            ///   Whether the decoder thread is decoding the sound.
+            /// </summary>
+            bool decoding = false;
+
+            /// <summary>
+            ///   Value of <see cref="releases_"/> when there was no room to
+            ///   decode the sound. It is not tried again until something is
+            ///   released.
+            /// </summary>
+            uint64_t no_room_at = std::numeric_limits<uint64_t>::max();
+        };
+
+        /// <summary>
+        ///   A sound being decoded into memory on the decoder thread.
+        /// </summary>
+        struct DecodeJob
+        {
+            intptr_t index;
+            std::string path;
+
+            /// <summary>Bytes reserved for the decoded sound.</summary>
+            size_t size;
+
+            std::unique_ptr<IAudioFile> file;
+            std::unique_ptr<uint8_t[]> buffer;
+            size_t offset;
+        };
+
+        struct DecodeResult
+        {
+            intptr_t index;
+            size_t size;
+
+            /// <summary>Decoded sound; <c>nullptr</c> if it failed.</summary>
+            std::shared_ptr<const Data> pcm;
+        };
+
+        std::unique_ptr<Channel[]> channels_;
+        int max_channels_ = 0;
+        int rate_ = 0;
+
+        /// <summary>
+        ///   Stopped channels waiting for the decoder thread to let go.
+        /// </summary>
+        std::vector<Channel*> retired_;
+
+        /// <summary>Channel commands and events.</summary>
+        std::unique_ptr<ChannelQueue> queue_;
+
+        /// <summary>Scratch buffer for the audio thread.</summary>
+        std::unique_ptr<int16_t[]> scratch_;
+
+        /// <summary>
+        ///   Thread decoding streamed sounds ahead of playback.
+        /// </summary>
+        std::thread decoder_;
+        std::mutex decoder_lock_;
+        std::condition_variable decoder_wake_;
+        bool decoder_should_wake_ = false;
+        bool decoder_should_quit_ = false;
+
+        /// <summary>Number of passes the decoder thread has done.</summary>
+        std::atomic<uint64_t> decodes_{0};
+
+        /// <summary>
+        ///   Sounds waiting to be decoded, and sounds that have been decoded.
+        ///   Both are guarded by <see cref="decoder_lock_"/>.
+        /// </summary>
+        std::vector<DecodeJob> decode_jobs_;
+        std::vector<DecodeResult> decode_results_;
+
+        /// <summary>Number of sounds sent to the decoder thread.</summary>
+        size_t pending_decodes_ = 0;
+
+        absl::flat_hash_map<intptr_t, SoundData> sounds_;
+
+        /// <summary>
+        ///   Decoded sounds that were dropped while still playing. They count
+        ///   towards the limit until the channels let go of them.
+        /// </summary>
+        std::vector<std::shared_ptr<const Data>> evicted_;
+
+        /// <summary>
+        ///   Total size of decoded sounds, including evicted ones that are
+        ///   still playing.
+        /// </summary>
+        size_t decoded_size_ = 0;
+
+        size_t max_decoded_size_ = kMaxDecodedSize;
+
+        /// <summary>
+        ///   Incremented whenever decoded sounds are freed or stop playing,
+        ///   which may make room for others.
+        /// </summary>
+        uint64_t releases_ = 0;
+
+        /// <summary>Incremented every time a sound is played.</summary>
+        uint64_t clock_ = 0;
+
         cubeb* context_ = nullptr;
+        cubeb_stream* stream_ = nullptr;
+        bool suspended_ = false;
+
+        /// <summary>
+        ///   Takes sounds decoded by the decoder thread.
+        /// </summary>
+        void collect_decoded();
+
+        /// <summary>
+        ///   Decodes <paramref name="sound"/> into memory, making room for it
+        ///   if necessary.
+        /// </summary>
+        void decode(SoundData& sound);
+
+        /// <summary>
+        ///   Decodes the next part of <paramref name="job"/>. Called on the
+        ///   decoder thread.
+        /// </summary>
+        /// <returns>Whether the job is done.</returns>
+        auto decode_some(DecodeJob& job) -> bool;
+
+        /// <summary>
+        ///   Drops the decoded buffer of <paramref name="sound"/>. If it is
+        ///   still playing, it is released once it is no longer used.
+        /// </summary>
+        void evict(SoundData& sound);
+
+        /// <summary>
+        ///   Drops decoded sounds that are not playing, least recently played
+        ///   first, until there is room for <paramref name="size"/> more
+        ///   bytes.
+        /// </summary>
+        /// <returns>
+        ///   Whether <paramref name="sound"/> can be decoded.
+        /// </returns>
+        auto make_room(SoundData& sound, size_t size) -> bool;
+
+        /// <summary>
+        ///   Releases evicted sounds that are no longer playing.
+        /// </summary>
+        void reclaim();
+
+        /// <summary>
+        ///   Returns <paramref name="size"/> bytes of decoded sounds to the
+        ///   budget.
+        /// </summary>
+        void release_decoded(size_t size);
+
+        /// <summary>
+        ///   Starts decoding <paramref name="sound"/> on the decoder thread.
+        ///   <paramref name="file"/> is the sound's file, already opened.
+        /// </summary>
+        void request_decode(intptr_t index,
+                            SoundData& sound,
+                            const IAudioFile& file);
+
+        auto render(Channel&, float* out, size_t frames) -> bool;
+
+        /// <summary>
+        ///   Hands a stopped channel back once no other thread is using it.
+        /// </summary>
+        void retire(Channel&);
+
+        /// <summary>
+        ///   Tops up the streams of all playing channels, and decodes sounds
+        ///   into memory.
+        /// </summary>
+        void run_decoder();
 
-        void suspend(int (*suspend)(cubeb_stream*));
+        /// <summary>Wakes the decoder thread.</summary>
+        void wake_decoder();
     };
 
     using Mixer = TMixer<CubebMixer>;
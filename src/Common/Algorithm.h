@@ -97,6 +97,22 @@ namespace rainbow
         return i - (i >> 1);
     }
 
+    /// <summary>Computes the 64-bit FNV-1a hash of a byte buffer.</summary>
+    /// <remarks>
+    ///   Unlike <c>std::hash</c>, the result is stable across runs and
+    ///   platforms, and is therefore suitable for keys stored on disk.
+    /// </remarks>
+    constexpr auto fnv1a(const uint8_t* data, size_t size) -> uint64_t
+    {
+        uint64_t hash = 0xcbf29ce484222325;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= data[i];
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
     /// <summary>
     ///   Returns whether <paramref name="x"/> is practically zero. A number is
     ///   considered almost zero if it's within <c>10 * ε</c>. On some hardware,
@@ -14,6 +14,12 @@
 
 namespace rainbow
 {
+    namespace detail
+    {
+        /// <summary>Unmaps a memory-mapped file view.</summary>
+        void unmap(void* address, size_t size);
+    }  // namespace detail
+
     /// <summary>Wrapper for byte buffers.</summary>
     /// <remarks>
     ///   <para>
@@ -35,6 +41,12 @@ namespace rainbow
         {
             Owner,
             Reference,
+
+            /// <summary>
+            ///   Buffer is a read-only, memory-mapped view of a file. Unlike
+            ///   buffers read from disk, it is not null-terminated.
+            /// </summary>
+            Mapped,
         };
 
         template <typename T, size_t N>
@@ -73,10 +85,18 @@ namespace rainbow
 
         ~Data()
         {
-            if (ownership_ != Ownership::Owner)
-                return;
-
-            operator delete(data_);
+            switch (ownership_)
+            {
+                case Ownership::Owner:
+                    operator delete(data_);
+                    break;
+                case Ownership::Reference:
+                    break;
+                case Ownership::Mapped:
+                    if (data_ != nullptr)
+                        detail::unmap(data_, size_);
+                    break;
+            }
         }
 
         template <typename T>
@@ -91,6 +111,12 @@ namespace rainbow
         /// </returns>
         [[nodiscard]] auto bytes() const { return as<uint8_t*>(); }
 
+        /// <summary>Returns whether this buffer is memory-mapped.</summary>
+        [[nodiscard]] auto is_mapped() const
+        {
+            return ownership_ == Ownership::Mapped;
+        }
+
         /// <summary>Returns the size of this buffer.</summary>
         [[nodiscard]] auto size() const { return size_; }
 
@@ -122,7 +148,7 @@ namespace rainbow
         size_t size_ = 0;
 
         /// <summary>
-        ///   Whether the buffer should be freed on destruction.
+        ///   Whether the buffer should be freed or unmapped on destruction.
         /// </summary>
         Ownership ownership_ = Ownership::Owner;
     };
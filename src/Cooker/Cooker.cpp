@@ -0,0 +1,720 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Cooker/Cooker.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// clang-format off
+#include "ThirdParty/DisableWarnings.h"
+#include <ft2build.h>  // NOLINT(llvm-include-order)
+#include FT_FREETYPE_H
+#include "ThirdParty/ReenableWarnings.h"
+// clang-format on
+
+#include <imgui/imstb_rectpack.h>
+#include <panini/panini.hpp>
+#include <physfs.h>
+
+#include "Audio/AudioFile.h"
+#include "Common/Data.h"
+#include "Common/Logging.h"
+#include "Common/TypeCast.h"
+#include "Cooker/Formats.h"
+#include "FileSystem/Bundle.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
+#include "Graphics/Image.h"
+#include "Graphics/PixelFormat.h"
+#include "Text/FontCache.h"
+
+using namespace std::literals::string_view_literals;
+
+using rainbow::czstring;
+using rainbow::Data;
+using rainbow::FontCache;
+using rainbow::Image;
+using rainbow::narrow_cast;
+using rainbow::WriteableFile;
+using rainbow::cooker::GlyphAtlasHeader;
+using rainbow::cooker::GlyphRecord;
+using rainbow::cooker::PCMHeader;
+using rainbow::cooker::TextureFormat;
+using rainbow::cooker::TextureHeader;
+using rainbow::graphics::Dithering;
+using rainbow::graphics::PixelFormat;
+
+namespace
+{
+    constexpr char kCookINI[] = "cook.ini";
+    constexpr char kUsage[] =
+        "Usage: rainbow --cook [--pixel-format rgba4444|rgba5551|rgb565] "
+        "[--dithering ordered|error-diffusion] [--max-pcm-seconds <seconds>] "
+        "<assets> <output>";
+
+    constexpr float kDefaultMaxPCMSeconds = 5.0F;
+    constexpr int kMinAtlasSize = 64;
+
+    /// <summary>26.6 fixed-point pixel coordinates.</summary>
+    constexpr int kPixelFormat = 64;
+
+    struct Options
+    {
+        PixelFormat pixel_format = PixelFormat::RGBA8888;
+        Dithering dithering = Dithering::None;
+        float max_pcm_seconds = kDefaultMaxPCMSeconds;
+        czstring assets = nullptr;
+        czstring output = nullptr;
+    };
+
+    struct FontSpec
+    {
+        std::string path;
+        std::vector<int> sizes;
+        std::vector<uint32_t> code_points;
+    };
+
+    struct FreeType
+    {
+        FT_Library library = nullptr;
+        FT_Face face = nullptr;
+
+        ~FreeType()
+        {
+            if (face != nullptr)
+                FT_Done_Face(face);
+            if (library != nullptr)
+                FT_Done_FreeType(library);
+        }
+    };
+
+    struct Glyph
+    {
+        GlyphRecord record;
+        std::vector<uint8_t> bitmap;
+    };
+
+    template <typename T>
+    void append(std::vector<uint8_t>& blob, const T& value)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        blob.insert(blob.end(), bytes, bytes + sizeof(value));
+    }
+
+    /// <summary>
+    ///   Calls <paramref name="f"/> with every comma-separated token in
+    ///   <paramref name="value"/>.
+    /// </summary>
+    template <typename F>
+    void for_each_token(std::string_view value, F&& f)
+    {
+        while (!value.empty())
+        {
+            const auto comma = value.find(',');
+            auto token = value.substr(0, comma);
+            while (!token.empty() && token.front() == ' ')
+                token.remove_prefix(1);
+            while (!token.empty() && token.back() == ' ')
+                token.remove_suffix(1);
+            if (!token.empty())
+                f(std::string{token});
+
+            if (comma == std::string_view::npos)
+                break;
+
+            value.remove_prefix(comma + 1);
+        }
+    }
+
+    /// <summary>
+    ///   Parses code points and code point ranges, e.g.
+    ///   <c>0x20-0x7e, 0xa0-0xff, 0x2026</c>.
+    /// </summary>
+    auto parse_code_points(std::string_view value)
+    {
+        std::vector<uint32_t> code_points;
+        for_each_token(value, [&code_points](const std::string& token) {
+            char* end = nullptr;
+            const auto first = std::strtoul(token.c_str(), &end, 0);
+            auto last = first;
+            if (*end == '-')
+                last = std::strtoul(end + 1, nullptr, 0);
+            for (auto c = first; c <= last; ++c)
+                code_points.push_back(narrow_cast<uint32_t>(c));
+        });
+        return code_points;
+    }
+
+    auto parse_sizes(std::string_view value)
+    {
+        std::vector<int> sizes;
+        for_each_token(value, [&sizes](const std::string& token) {
+            const auto size = std::atoi(token.c_str());
+            if (size > 0)
+                sizes.push_back(size);
+        });
+        return sizes;
+    }
+
+    auto read_cook_ini()
+    {
+        std::vector<FontSpec> fonts;
+        if (!rainbow::filesystem::exists(kCookINI))
+            return fonts;
+
+        const auto ini =
+            rainbow::File::read(kCookINI, rainbow::FileType::Asset);
+        panini::parse(  //
+            ini.as<const char*>(),
+            [&fonts](panini::State state,
+                     std::string_view section,
+                     std::string_view key,
+                     std::string_view value) {
+                if (state == panini::State::Error)
+                {
+                    LOGE("Error parsing %s:%s: %s",
+                         kCookINI,
+                         section.data(),
+                         key.data());
+                    return;
+                }
+
+                if (section.empty())
+                    return;
+
+                if (fonts.empty() || fonts.back().path != section)
+                    fonts.push_back({std::string{section}, {}, {}});
+
+                auto& font = fonts.back();
+                if (key == "Sizes"sv)
+                    font.sizes = parse_sizes(value);
+                else if (key == "Characters"sv)
+                    font.code_points = parse_code_points(value);
+            });
+
+        for (auto&& font : fonts)
+        {
+            if (font.code_points.empty())
+                font.code_points = parse_code_points("0x20-0x7e");
+        }
+
+        return fonts;
+    }
+
+    auto parse_options(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            if (arg == "--pixel-format"sv && i + 1 < argc)
+            {
+                const std::string_view format = argv[++i];
+                if (format == "rgba8888"sv)
+                    options.pixel_format = PixelFormat::RGBA8888;
+                else if (format == "rgba4444"sv)
+                    options.pixel_format = PixelFormat::RGBA4444;
+                else if (format == "rgba5551"sv)
+                    options.pixel_format = PixelFormat::RGBA5551;
+                else if (format == "rgb565"sv)
+                    options.pixel_format = PixelFormat::RGB565;
+                else
+                    return false;
+            }
+            else if (arg == "--dithering"sv && i + 1 < argc)
+            {
+                const std::string_view dithering = argv[++i];
+                if (dithering == "none"sv)
+                    options.dithering = Dithering::None;
+                else if (dithering == "ordered"sv)
+                    options.dithering = Dithering::Ordered;
+                else if (dithering == "error-diffusion"sv)
+                    options.dithering = Dithering::ErrorDiffusion;
+                else
+                    return false;
+            }
+            else if (arg == "--max-pcm-seconds"sv && i + 1 < argc)
+            {
+                options.max_pcm_seconds = std::strtof(argv[++i], nullptr);
+            }
+            else if (options.assets == nullptr)
+            {
+                options.assets = argv[i];
+            }
+            else if (options.output == nullptr)
+            {
+                options.output = argv[i];
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return options.assets != nullptr && options.output != nullptr;
+    }
+
+    /// <summary>
+    ///   Mounts <paramref name="assets"/> in place of the bundle, and makes
+    ///   <paramref name="output"/> the write directory, creating it if
+    ///   necessary.
+    /// </summary>
+    auto mount(czstring assets, czstring output)
+    {
+        PHYSFS_unmount(rainbow::filesystem::bundle().assets_path());
+        if (auto write_dir = PHYSFS_getWriteDir(); write_dir != nullptr)
+            PHYSFS_unmount(write_dir);
+
+        if (PHYSFS_mount(assets, nullptr, 0) == 0)
+        {
+            LOGE("Cooker: Failed to mount '%s': %s",
+                 assets,
+                 PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+            return false;
+        }
+
+        const auto output_path =
+            rainbow::filesystem::Path{rainbow::system::absolute_path(output)};
+        if (!rainbow::system::is_directory(output_path.c_str()))
+        {
+            const auto parent = output_path.parent_path();
+            const auto name = output_path.filename();
+            if (PHYSFS_setWriteDir(parent.c_str()) == 0 ||
+                PHYSFS_mkdir(name.c_str()) == 0)
+            {
+                LOGE("Cooker: Failed to create '%s': %s",
+                     output,
+                     PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+                return false;
+            }
+        }
+
+        if (PHYSFS_setWriteDir(output_path.c_str()) == 0)
+        {
+            LOGE("Cooker: Failed to open '%s' for writing: %s",
+                 output,
+                 PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+            return false;
+        }
+
+        return true;
+    }
+
+    template <typename F>
+    void for_each_file(const std::string& directory, F&& f)
+    {
+        auto files = PHYSFS_enumerateFiles(directory.c_str());
+        for (auto i = files; *i != nullptr; ++i)
+        {
+            auto path = directory.empty() ? std::string{*i}
+                                          : directory + '/' + *i;
+            if (rainbow::filesystem::is_directory(path.c_str()))
+                for_each_file(path, f);
+            else
+                f(path);
+        }
+        PHYSFS_freeList(files);
+    }
+
+    auto write(const std::string& path, const void* data, size_t size)
+    {
+        const auto slash = path.rfind('/');
+        if (slash != std::string::npos)
+        {
+            const auto directory = path.substr(0, slash);
+            if (!rainbow::filesystem::create_directories(directory.c_str()))
+                return false;
+        }
+
+        auto file = WriteableFile::open(path.c_str());
+        return file && (size == 0 || file.write(data, size) == size);
+    }
+
+    auto write(const std::string& path, const std::vector<uint8_t>& blob)
+    {
+        return write(path, blob.data(), blob.size());
+    }
+
+    auto write(const std::string& path, const Data& data)
+    {
+        return write(path, data.bytes(), data.size());
+    }
+
+    auto render_glyphs(FT_Face face,
+                       int font_size,
+                       std::vector<uint32_t> glyphs)
+    {
+        std::sort(glyphs.begin(), glyphs.end());
+        glyphs.erase(std::unique(glyphs.begin(), glyphs.end()), glyphs.end());
+
+        FT_Set_Char_Size(face, 0, font_size * kPixelFormat, 0, FontCache::kDPI);
+
+        std::vector<Glyph> rendered;
+        rendered.reserve(glyphs.size());
+        for (auto glyph_index : glyphs)
+        {
+            if (FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER) != FT_Err_Ok)
+                continue;
+
+            const FT_GlyphSlot slot = face->glyph;
+            const FT_Bitmap& bitmap = slot->bitmap;
+            if (bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
+                continue;
+
+            Glyph& glyph = rendered.emplace_back();
+            glyph.record.glyph_index = glyph_index;
+            glyph.record.font_size = narrow_cast<int16_t>(font_size);
+            glyph.record.left = narrow_cast<int16_t>(slot->bitmap_left);
+            glyph.record.top = narrow_cast<int16_t>(slot->bitmap_top);
+            glyph.record.width = narrow_cast<uint16_t>(bitmap.width);
+            glyph.record.height = narrow_cast<uint16_t>(bitmap.rows);
+
+            glyph.bitmap.resize(static_cast<size_t>(bitmap.width) *
+                                bitmap.rows);
+            for (uint32_t row = 0; row < bitmap.rows; ++row)
+            {
+                std::copy_n(bitmap.buffer + row * bitmap.pitch,
+                            bitmap.width,
+                            glyph.bitmap.data() + row * bitmap.width);
+            }
+        }
+
+        return rendered;
+    }
+
+    /// <summary>
+    ///   Packs the rectangles into the smallest power-of-two atlas that fits
+    ///   within the font cache. Returns the atlas size; 0 if they don't fit.
+    /// </summary>
+    auto pack(std::vector<stbrp_rect>& rects) -> std::pair<int, int>
+    {
+        int width = kMinAtlasSize;
+        int height = kMinAtlasSize;
+        std::vector<stbrp_node> nodes;
+        while (height <= FontCache::kTextureSize)
+        {
+            nodes.resize(width);
+            stbrp_context context;
+            stbrp_init_target(&context,
+                              width,
+                              height,
+                              nodes.data(),
+                              narrow_cast<int>(nodes.size()));
+            stbrp_pack_rects(
+                &context, rects.data(), narrow_cast<int>(rects.size()));
+            if (std::all_of(rects.begin(), rects.end(), [](auto&& rect) {
+                    return rect.was_packed != 0;
+                }))
+            {
+                return {width, height};
+            }
+
+            if (width == height)
+                width *= 2;
+            else
+                height *= 2;
+        }
+
+        return {0, 0};
+    }
+}  // namespace
+
+auto rainbow::cooker::bake_glyph_atlas(const Data& font,
+                                       ArrayView<int> font_sizes,
+                                       ArrayView<uint32_t> code_points)
+    -> std::vector<uint8_t>
+{
+    FreeType ft;
+    if (FT_Init_FreeType(&ft.library) != FT_Err_Ok ||
+        FT_New_Memory_Face(ft.library,
+                           font.as<FT_Byte*>(),
+                           narrow_cast<FT_Long>(font.size()),
+                           0,
+                           &ft.face) != FT_Err_Ok ||
+        FT_Select_Charmap(ft.face, FT_ENCODING_UNICODE) != FT_Err_Ok)
+    {
+        LOGE("Cooker: Failed to load font face");
+        return {};
+    }
+
+    std::vector<uint32_t> glyph_indices;
+    for (auto code_point : code_points)
+    {
+        const auto glyph_index = FT_Get_Char_Index(ft.face, code_point);
+        if (glyph_index != 0)
+            glyph_indices.push_back(glyph_index);
+    }
+
+    std::vector<Glyph> glyphs;
+    for (auto font_size : font_sizes)
+    {
+        auto rendered = render_glyphs(ft.face, font_size, glyph_indices);
+        std::move(rendered.begin(), rendered.end(), std::back_inserter(glyphs));
+    }
+
+    constexpr auto kMargin = FontCache::kGlyphMargin;
+    std::vector<stbrp_rect> rects;
+    rects.reserve(glyphs.size());
+    for (auto&& glyph : glyphs)
+    {
+        rects.push_back({
+            narrow_cast<int>(rects.size()),
+            static_cast<stbrp_coord>(glyph.record.width + kMargin * 2),
+            static_cast<stbrp_coord>(glyph.record.height + kMargin * 2),
+            0,
+            0,
+            0,
+        });
+    }
+
+    const auto [width, height] = pack(rects);
+    if (width == 0)
+    {
+        LOGE("Cooker: Glyphs do not fit in a %ix%i atlas",
+             FontCache::kTextureSize,
+             FontCache::kTextureSize);
+        return {};
+    }
+
+    const GlyphAtlasHeader header{
+        GlyphAtlasHeader::kMagic,
+        kFormatVersion,
+        0,
+        narrow_cast<uint32_t>(glyphs.size()),
+        narrow_cast<uint16_t>(width),
+        narrow_cast<uint16_t>(height),
+    };
+
+    std::vector<uint8_t> blob;
+    blob.reserve(sizeof(header) + sizeof(GlyphRecord) * glyphs.size() +
+                 width * height);
+    append(blob, header);
+
+    for (auto&& rect : rects)
+    {
+        auto& record = glyphs[rect.id].record;
+        record.x = narrow_cast<uint16_t>(rect.x + kMargin);
+        record.y = narrow_cast<uint16_t>(rect.y + kMargin);
+        append(blob, record);
+    }
+
+    const auto pixels = blob.size();
+    blob.resize(pixels + width * height);
+    for (auto&& glyph : glyphs)
+    {
+        const auto& record = glyph.record;
+        for (uint32_t row = 0; row < record.height; ++row)
+        {
+            std::copy_n(
+                glyph.bitmap.data() + row * record.width,
+                record.width,
+                blob.data() + pixels + (record.y + row) * width + record.x);
+        }
+    }
+
+    return blob;
+}
+
+auto rainbow::cooker::cook_pcm(audio::IAudioFile& file) -> std::vector<uint8_t>
+{
+    if (!file || file.channels() <= 0)
+        return {};
+
+    const size_t size = file.size();
+    const PCMHeader header{
+        PCMHeader::kMagic,
+        kFormatVersion,
+        narrow_cast<uint16_t>(file.channels()),
+        narrow_cast<uint32_t>(file.rate()),
+        narrow_cast<uint32_t>(size / (file.channels() * sizeof(int16_t))),
+    };
+
+    std::vector<uint8_t> blob;
+    blob.reserve(sizeof(header) + size);
+    append(blob, header);
+    blob.resize(sizeof(header) + size);
+
+    file.rewind();
+    if (file.read(blob.data() + sizeof(header), size) != size)
+    {
+        LOGE("Cooker: Failed to decode sound");
+        return {};
+    }
+
+    return blob;
+}
+
+auto rainbow::cooker::cook_texture(const Data& data,
+                                   PixelFormat pixel_format,
+                                   Dithering dithering) -> std::vector<uint8_t>
+{
+    const auto image =
+        graphics::convert(Image::decode(data, 1.0F), pixel_format, dithering);
+    if (image.data == nullptr)
+        return {};
+
+    TextureFormat format;
+    uint32_t bytes_per_pixel = 2;
+    switch (image.format)
+    {
+        case Image::Format::PNG:
+        case Image::Format::RGBA:
+        case Image::Format::SVG:
+            if (image.channels == 4 && image.depth == 32)
+            {
+                format = TextureFormat::RGBA8888;
+                bytes_per_pixel = 4;
+                break;
+            }
+            if (image.channels == 2 && image.depth == 16)
+            {
+                format = TextureFormat::LuminanceAlpha;
+                break;
+            }
+            return {};
+        case Image::Format::RGBA4444:
+            format = TextureFormat::RGBA4444;
+            break;
+        case Image::Format::RGBA5551:
+            format = TextureFormat::RGBA5551;
+            break;
+        case Image::Format::RGB565:
+            format = TextureFormat::RGB565;
+            break;
+        default:
+            return {};
+    }
+
+    const size_t size =
+        static_cast<size_t>(image.width) * image.height * bytes_per_pixel;
+    const TextureHeader header{
+        TextureHeader::kMagic,
+        kFormatVersion,
+        format,
+        image.width,
+        image.height,
+    };
+
+    std::vector<uint8_t> blob;
+    blob.reserve(sizeof(header) + size);
+    append(blob, header);
+    blob.insert(blob.end(), image.data, image.data + size);
+    return blob;
+}
+
+auto rainbow::cooker::run(int argc, char* argv[]) -> int
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        LOGE("%s", kUsage);
+        return 1;
+    }
+
+    if (!mount(options.assets, options.output))
+        return 1;
+
+    const auto fonts = read_cook_ini();
+
+    int cooked = 0;
+    int copied = 0;
+    int failed = 0;
+    auto commit = [&failed](const std::string& path, auto&& blob) {
+        if (write(path, blob))
+            return true;
+
+        LOGE("Cooker: Failed to write '%s'", path.c_str());
+        ++failed;
+        return false;
+    };
+
+    for_each_file("", [&](const std::string& path) {
+        if (path == kCookINI)
+            return;
+
+        if (ends_with(path, ".png"))
+        {
+            const auto data = File::map(path.c_str(), FileType::Asset);
+            auto blob =
+                cook_texture(data, options.pixel_format, options.dithering);
+            if (!blob.empty())
+            {
+                cooked += commit(path, blob) ? 1 : 0;
+                return;
+            }
+
+            LOGW("Cooker: Failed to cook '%s', copying as is", path.c_str());
+        }
+#ifndef RAINBOW_AUDIO_FMOD
+        else if (ends_with(path, ".ogg"))
+        {
+            auto sound = audio::IAudioFile::open(path.c_str());
+            const auto frames =
+                *sound ? sound->size() / (sound->channels() * sizeof(int16_t))
+                       : 0;
+            if (frames > 0 &&
+                frames <= options.max_pcm_seconds * sound->rate())
+            {
+                auto blob = cook_pcm(*sound);
+                if (!blob.empty())
+                {
+                    cooked += commit(path, blob) ? 1 : 0;
+                    return;
+                }
+            }
+        }
+#endif  // !RAINBOW_AUDIO_FMOD
+
+        copied +=
+            commit(path, File::map(path.c_str(), FileType::Asset)) ? 1 : 0;
+    });
+
+    for (auto&& font : fonts)
+    {
+        if (!filesystem::is_regular_file(font.path.c_str()) ||
+            font.sizes.empty())
+        {
+            LOGE("Cooker: Invalid font declaration: %s", font.path.c_str());
+            ++failed;
+            continue;
+        }
+
+        const auto data = File::map(font.path.c_str(), FileType::Asset);
+        auto blob = bake_glyph_atlas(data,
+                                     {font.sizes.data(), font.sizes.size()},
+                                     {font.code_points.data(),
+                                      font.code_points.size()});
+        if (blob.empty())
+        {
+            LOGE("Cooker: Failed to bake glyphs for %s", font.path.c_str());
+            ++failed;
+            continue;
+        }
+
+        cooked += commit(font.path + ".atlas", blob) ? 1 : 0;
+    }
+
+    std::printf("%s -> %s (%i cooked, %i copied, %i failed)\n",
+                options.assets,
+                options.output,
+                cooked,
+                copied,
+                failed);
+    return failed == 0 ? 0 : 1;
+}
+
+auto rainbow::cooker::should_cook(out<int> argc, out<char**> argv) -> bool
+{
+    if (argc < 2 || std::string_view{argv[1]} != "--cook"sv)
+        return false;
+
+    --argc;
+    ++argv;
+    return true;
+}
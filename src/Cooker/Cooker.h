@@ -0,0 +1,98 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef COOKER_COOKER_H_
+#define COOKER_COOKER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Common/Functional.h"
+#include "Memory/Array.h"
+
+namespace rainbow
+{
+    class Data;
+}  // namespace rainbow
+
+namespace rainbow::audio
+{
+    struct IAudioFile;
+}  // namespace rainbow::audio
+
+namespace rainbow::graphics
+{
+    enum class Dithering;
+    enum class PixelFormat;
+}  // namespace rainbow::graphics
+
+/// <summary>
+///   Offline asset cooker. Preprocesses an assets directory into forms that
+///   can be uploaded or played without decoding. See <c>Cooker/Formats.h</c>.
+/// </summary>
+/// <remarks>
+///   <para>
+///     Usage: <c>rainbow --cook [options] &lt;assets&gt; &lt;output&gt;</c>
+///   </para>
+///   <list type="bullet">
+///     <item>
+///       PNGs are decoded, optionally converted to a 16-bit pixel format with
+///       <c>--pixel-format rgba4444|rgba5551|rgb565</c>, and stored as raw
+///       texture blobs under the same name.
+///     </item>
+///     <item>
+///       Sounds no longer than <c>--max-pcm-seconds</c> (default 5) are
+///       decoded to 16-bit PCM and stored under the same name.
+///     </item>
+///     <item>
+///       Fonts declared in <c>cook.ini</c> get a pre-baked glyph atlas,
+///       <c>&lt;font&gt;.atlas</c>:
+///       <code>
+///         [fonts/Font.otf]
+///         Sizes = 16, 24
+///         Characters = 0x20-0x7e, 0xa0-0xff
+///       </code>
+///     </item>
+///     <item>Everything else is copied as is.</item>
+///   </list>
+/// </remarks>
+namespace rainbow::cooker
+{
+    /// <summary>
+    ///   Bakes glyphs for the specified code points and font sizes into a
+    ///   single-channel atlas. Returns an empty buffer on failure.
+    /// </summary>
+    auto bake_glyph_atlas(const Data& font,
+                          ArrayView<int> font_sizes,
+                          ArrayView<uint32_t> code_points)
+        -> std::vector<uint8_t>;
+
+    /// <summary>
+    ///   Decodes a sound into 16-bit PCM. Returns an empty buffer on failure.
+    /// </summary>
+    auto cook_pcm(audio::IAudioFile& file) -> std::vector<uint8_t>;
+
+    /// <summary>
+    ///   Decodes an image into a texture blob, converting it to the specified
+    ///   pixel format. Returns an empty buffer if the image is compressed or
+    ///   cannot be decoded.
+    /// </summary>
+    auto cook_texture(const Data& data,
+                      graphics::PixelFormat pixel_format,
+                      graphics::Dithering dithering) -> std::vector<uint8_t>;
+
+    /// <summary>
+    ///   Cooks <c>argv[1]</c> into <c>argv[2]</c>. Returns the process exit
+    ///   code.
+    /// </summary>
+    auto run(int argc, char* argv[]) -> int;
+
+    /// <summary>
+    ///   Returns whether the <c>--cook</c> flag was passed, in which case it
+    ///   is also consumed.
+    /// </summary>
+    auto should_cook(out<int> argc, out<char**> argv) -> bool;
+}  // namespace rainbow::cooker
+
+#endif
@@ -0,0 +1,121 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef COOKER_FORMATS_H_
+#define COOKER_FORMATS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "Common/Algorithm.h"
+
+/// <summary>
+///   Formats written by the asset cooker (<c>rainbow --cook</c>). All
+///   integers are little-endian, and payloads immediately follow their
+///   headers.
+/// </summary>
+namespace rainbow::cooker
+{
+    constexpr uint16_t kFormatVersion = 1;
+
+    /// <summary>Pixel layout of a cooked texture.</summary>
+    enum class TextureFormat : uint16_t
+    {
+        RGBA8888,
+        LuminanceAlpha,  ///< 8-bit grey + 8-bit alpha.
+        RGBA4444,
+        RGBA5551,
+        RGB565,
+    };
+
+    /// <summary>Header of a texture ready to be uploaded as-is.</summary>
+    struct TextureHeader
+    {
+        static constexpr uint32_t kMagic = make_fourcc('R', 'T', 'E', 'X');
+
+        uint32_t magic;
+        uint16_t version;
+        TextureFormat format;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    static_assert(sizeof(TextureHeader) == 16);
+
+    /// <summary>
+    ///   Header of a pre-baked glyph atlas. It is followed by
+    ///   <c>glyph_count</c> <see cref="GlyphRecord"/>s, then
+    ///   <c>width</c> * <c>height</c> bytes of 8-bit coverage.
+    /// </summary>
+    /// <remarks>
+    ///   Atlases are stored next to their font, e.g. <c>font.ttf.atlas</c>.
+    /// </remarks>
+    struct GlyphAtlasHeader
+    {
+        static constexpr uint32_t kMagic = make_fourcc('R', 'G', 'L', 'A');
+
+        uint32_t magic;
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t glyph_count;
+        uint16_t width;
+        uint16_t height;
+    };
+
+    static_assert(sizeof(GlyphAtlasHeader) == 16);
+
+    /// <summary>A glyph, and where it is found in the atlas.</summary>
+    struct GlyphRecord
+    {
+        uint32_t glyph_index;
+        int16_t font_size;
+        int16_t left;  ///< <c>FT_GlyphSlot::bitmap_left</c>
+        int16_t top;   ///< <c>FT_GlyphSlot::bitmap_top</c>
+        uint16_t width;
+        uint16_t height;
+        uint16_t x;
+        uint16_t y;
+        uint16_t reserved;
+    };
+
+    static_assert(sizeof(GlyphRecord) == 20);
+
+    /// <summary>Header of decoded, interleaved 16-bit PCM.</summary>
+    struct PCMHeader
+    {
+        static constexpr uint32_t kMagic = make_fourcc('R', 'P', 'C', 'M');
+
+        uint32_t magic;
+        uint16_t version;
+        uint16_t channels;
+        uint32_t rate;
+        uint32_t frames;
+    };
+
+    static_assert(sizeof(PCMHeader) == 16);
+
+    /// <summary>
+    ///   Returns the header at the start of the buffer if it is of the
+    ///   expected type and version; <c>nullptr</c> otherwise.
+    /// </summary>
+    template <typename T>
+    auto header_of(const uint8_t* data, size_t size) -> const T*
+    {
+        if (data == nullptr || size < sizeof(T))
+            return nullptr;
+
+        uint32_t magic = 0;
+        uint16_t version = 0;
+        std::memcpy(&magic, data, sizeof(magic));
+        std::memcpy(&version, data + sizeof(magic), sizeof(version));
+        if (magic != T::kMagic || version != kFormatVersion)
+            return nullptr;
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return reinterpret_cast<const T*>(data);
+    }
+}  // namespace rainbow::cooker
+
+#endif
@@ -6,6 +6,7 @@
 
 #include "Common/Logging.h"
 #include "Common/Random.h"
+#include "FileSystem/FileSystem.h"
 #include "Script/NoGame.h"
 
 #ifdef USE_PHYSICS
@@ -14,7 +15,34 @@
 
 namespace
 {
+    constexpr size_t kAssetCacheBudget = 64 * 1024 * 1024;
     constexpr int kMaxAudioChannels = 24;
+
+    auto io_thread_count() -> size_t
+    {
+#ifdef RAINBOW_JS
+        // Threads are not available without SharedArrayBuffer.
+        return 0;
+#else
+        // I/O threads mostly sit waiting on the disk; a couple is plenty.
+        return 2;
+#endif
+    }
+
+    auto raster_cache_directory() -> rainbow::filesystem::Path
+    {
+        constexpr char kRasterCacheDirectory[] = "rasters";
+
+        namespace filesystem = rainbow::filesystem;
+        const auto& preferences = filesystem::preferences_directory();
+        if (preferences.empty() ||
+            !filesystem::create_directories(kRasterCacheDirectory))
+        {
+            return {};
+        }
+
+        return preferences / kRasterCacheDirectory;
+    }
 }  // namespace
 
 namespace rainbow
@@ -22,7 +50,9 @@ namespace rainbow
     Random random;  // NOLINT(cert-err58-cpp)
 
     Director::Director()
-        : active_(true), terminated_(false), error_(ErrorCode::Success)
+        : active_(true), terminated_(false), error_(ErrorCode::Success),
+          io_(io_thread_count()), asset_cache_(kAssetCacheBudget),
+          raster_cache_(raster_cache_directory())
     {
         if (std::error_code error = mixer_.initialize(kMaxAudioChannels))
             terminate(error);
@@ -61,6 +91,7 @@ namespace rainbow
 
         script_.reset();
         timer_manager_.clear();
+        io_.clear();
         render_queue_.clear();
         mixer_.clear();
 
@@ -76,6 +107,7 @@ namespace rainbow
         R_ASSERT(!terminated_, "App should have terminated by now");
 
         timer_manager_.update(dt);
+        io_.update();
         script_->update(dt);
 
         graphics::update(*script_, render_queue_, dt);
@@ -102,6 +134,8 @@ namespace rainbow
         R_ASSERT(!terminated_, "App should have terminated by now");
 
         script_->on_memory_warning();
+        asset_cache_.purge();
+        raster_cache_.clear();
     }
 
     void Director::start()
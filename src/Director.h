@@ -7,6 +7,9 @@
 
 #include "Audio/Mixer.h"
 #include "Common/Global.h"
+#include "FileSystem/AssetCache.h"
+#include "FileSystem/AsyncIO.h"
+#include "Graphics/RasterCache.h"
 #include "Graphics/RenderQueue.h"
 #include "Graphics/Renderer.h"
 #include "Input/Input.h"
@@ -33,6 +36,12 @@ namespace rainbow
         void init(const Vec2i& screen);
 
         [[nodiscard]] auto active() const { return active_; }
+
+        [[nodiscard]] auto asset_cache() -> AssetCache&
+        {
+            return asset_cache_;
+        }
+
         [[nodiscard]] auto error() const { return error_; }
 
         [[nodiscard]] auto font_cache() -> FontCache&
@@ -46,6 +55,7 @@ namespace rainbow
         }
 
         [[nodiscard]] auto input() -> Input& { return input_; }
+        [[nodiscard]] auto io() -> AsyncIO& { return io_; }
         [[nodiscard]] auto mixer() -> audio::Mixer& { return mixer_; }
 
         [[nodiscard]] auto render_queue() -> graphics::RenderQueue&
@@ -121,10 +131,13 @@ namespace rainbow
         bool terminated_;
         std::error_code error_;
         TimerManager timer_manager_;
+        AsyncIO io_;
+        AssetCache asset_cache_;
         std::unique_ptr<GameBase> script_;
         graphics::RenderQueue render_queue_;
         Input input_;
         graphics::Context renderer_;
+        graphics::RasterCache raster_cache_;
         audio::Mixer mixer_;
         Typesetter typesetter_;
 
@@ -0,0 +1,166 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "FileSystem/AssetCache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Common/Algorithm.h"
+
+using rainbow::AssetCache;
+using rainbow::czstring;
+using rainbow::Data;
+using rainbow::FileType;
+
+auto AssetCache::key_of(const Data& content, uint64_t parameters) -> Key
+{
+    return {fnv1a(content.bytes(), content.size()), parameters};
+}
+
+AssetCache::AssetCache(size_t budget) : budget_(budget)
+{
+    make_global();
+}
+
+auto AssetCache::count() const -> size_t
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+auto AssetCache::size() const -> size_t
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+auto AssetCache::load(czstring path, FileType file_type) -> Handle<Data>
+{
+    auto source = std::make_pair(std::string{path}, file_type);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto i = paths_.find(source);
+        if (i != paths_.end())
+        {
+            auto entry = entries_.find(i->second);
+            if (entry != entries_.end())
+            {
+                entry->second.last_used = ++clock_;
+                return std::static_pointer_cast<const Data>(
+                    entry->second.asset);
+            }
+        }
+    }
+
+    auto data = File::map(path, file_type);
+    if (!data)
+        return nullptr;
+
+    const auto key = key_of(data);
+    auto asset = get<Data>(key, [&data] { return std::move(data); });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    paths_.insert_or_assign(std::move(source), key);
+    return asset;
+}
+
+void AssetCache::invalidate(std::string_view path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto i = paths_.begin(); i != paths_.end();)
+    {
+        if (i->first.first == path)
+            paths_.erase(i++);
+        else
+            ++i;
+    }
+}
+
+void AssetCache::purge()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    trim(0);
+}
+
+void AssetCache::set_budget(size_t budget)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = budget;
+    trim(budget_);
+}
+
+auto AssetCache::find(const Key& key) -> std::shared_ptr<const void>
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto i = entries_.find(key);
+    if (i == entries_.end())
+        return nullptr;
+
+    i->second.last_used = ++clock_;
+    return i->second.asset;
+}
+
+auto AssetCache::store(const Key& key,
+                       std::shared_ptr<const void> asset,
+                       size_t size) -> std::shared_ptr<const void>
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Another thread may have produced the same asset in the meantime.
+    auto [i, inserted] =
+        entries_.try_emplace(key, Entry{std::move(asset), size, ++clock_});
+    if (!inserted)
+    {
+        i->second.last_used = clock_;
+        return i->second.asset;
+    }
+
+    size_ += size;
+
+    // Make sure we don't evict the entry we just added.
+    auto result = i->second.asset;
+    trim(budget_);
+    return result;
+}
+
+void AssetCache::trim(size_t target)
+{
+    if (size_ <= target)
+        return;
+
+    std::vector<std::pair<uint64_t, Key>> unused;
+    for (auto&& [key, entry] : entries_)
+    {
+        if (entry.asset.use_count() == 1)
+            unused.emplace_back(entry.last_used, key);
+    }
+
+    std::sort(std::begin(unused),
+              std::end(unused),
+              [](auto&& lhs, auto&& rhs) { return lhs.first < rhs.first; });
+
+    const auto count = entries_.size();
+    for (auto&& [last_used, key] : unused)
+    {
+        if (size_ <= target)
+            break;
+
+        auto i = entries_.find(key);
+        size_ -= i->second.size;
+        entries_.erase(i);
+    }
+
+    if (entries_.size() == count)
+        return;
+
+    // Forget paths whose contents were evicted.
+    for (auto i = paths_.begin(); i != paths_.end();)
+    {
+        if (entries_.contains(i->second))
+            ++i;
+        else
+            paths_.erase(i++);
+    }
+}
@@ -0,0 +1,166 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef FILESYSTEM_ASSETCACHE_H_
+#define FILESYSTEM_ASSETCACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "Common/Data.h"
+#include "Common/Global.h"
+#include "FileSystem/File.h"
+
+namespace rainbow
+{
+    /// <summary>Returns the number of bytes held by an asset.</summary>
+    inline auto size_of(const Data& data) { return data.size(); }
+
+    /// <summary>
+    ///   Engine-wide cache of immutable, refcounted assets shared between
+    ///   subsystems.
+    /// </summary>
+    /// <remarks>
+    ///   <para>
+    ///     Entries are keyed on a hash of the source data and a hash of the
+    ///     parameters it was processed with. The same content loaded under
+    ///     different paths therefore only needs to be processed once.
+    ///   </para>
+    ///   <para>
+    ///     Assets are destroyed once both the cache and all users have let go
+    ///     of them. The cache itself holds on to entries until it goes over
+    ///     budget, or is purged; least recently used entries go first. Entries
+    ///     that are still in use are never evicted, so the budget may be
+    ///     temporarily exceeded.
+    ///   </para>
+    ///   <para>
+    ///     The size of an asset of type <c>T</c> is determined by an
+    ///     unqualified call to <c>size_of(const T&amp;)</c>.
+    ///   </para>
+    /// </remarks>
+    class AssetCache : public Global<AssetCache>
+    {
+    public:
+        template <typename T>
+        using Handle = std::shared_ptr<const T>;
+
+        struct Key
+        {
+            uint64_t content;
+            uint64_t parameters;
+
+            template <typename H>
+            friend auto AbslHashValue(H hash_state, const Key& k) -> H
+            {
+                return H::combine(
+                    std::move(hash_state), k.content, k.parameters);
+            }
+
+            friend auto operator==(const Key& lhs, const Key& rhs) -> bool
+            {
+                return lhs.content == rhs.content &&
+                       lhs.parameters == rhs.parameters;
+            }
+        };
+
+        /// <summary>
+        ///   Returns the key of <paramref name="content"/> processed with
+        ///   parameters hashing to <paramref name="parameters"/>.
+        /// </summary>
+        static auto key_of(const Data& content, uint64_t parameters = 0)
+            -> Key;
+
+        /// <summary>
+        ///   Creates a cache that starts evicting unused entries when it holds
+        ///   more than <paramref name="budget"/> bytes.
+        /// </summary>
+        explicit AssetCache(size_t budget);
+
+        [[nodiscard]] auto budget() const { return budget_; }
+
+        /// <summary>Returns the number of cached entries.</summary>
+        [[nodiscard]] auto count() const -> size_t;
+
+        /// <summary>Returns the number of bytes held by the cache.</summary>
+        [[nodiscard]] auto size() const -> size_t;
+
+        /// <summary>
+        ///   Returns the asset at <paramref name="key"/>.
+        ///   <paramref name="produce"/> is only called, without holding any
+        ///   locks, if there is no such asset in the cache.
+        /// </summary>
+        template <typename T, typename F>
+        auto get(const Key& key, F&& produce) -> Handle<T>
+        {
+            if (auto asset = find(key))
+                return std::static_pointer_cast<const T>(asset);
+
+            auto asset = std::make_shared<const T>(produce());
+            const auto size = size_of(*asset);
+            return std::static_pointer_cast<const T>(
+                store(key, std::move(asset), size));
+        }
+
+        /// <summary>
+        ///   Returns the contents of the file at specified path. Files with
+        ///   identical contents share the same buffer.
+        /// </summary>
+        /// <remarks>
+        ///   Returns <c>nullptr</c> if the file could not be read. Failures
+        ///   are not cached. The key of a path is remembered for as long as
+        ///   its entry is cached, so the file is only read and hashed again
+        ///   after it has been evicted or invalidated.
+        /// </remarks>
+        auto load(czstring path, FileType file_type) -> Handle<Data>;
+
+        /// <summary>
+        ///   Forgets the contents of the file at specified path, e.g. because
+        ///   it was modified. The next <see cref="load"/> reads it again.
+        /// </summary>
+        void invalidate(std::string_view path);
+
+        /// <summary>Evicts all entries that are no longer in use.</summary>
+        void purge();
+
+        /// <summary>
+        ///   Sets the number of bytes the cache may hold before it starts
+        ///   evicting entries.
+        /// </summary>
+        void set_budget(size_t budget);
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<const void> asset;
+            size_t size;
+            uint64_t last_used;
+        };
+
+        absl::flat_hash_map<Key, Entry> entries_;
+        absl::flat_hash_map<std::pair<std::string, FileType>, Key> paths_;
+        size_t budget_;
+        size_t size_ = 0;
+        uint64_t clock_ = 0;
+        mutable std::mutex mutex_;
+
+        auto find(const Key&) -> std::shared_ptr<const void>;
+        auto store(const Key&, std::shared_ptr<const void> asset, size_t size)
+            -> std::shared_ptr<const void>;
+
+        /// <summary>
+        ///   Evicts unused entries, least recently used first, until the cache
+        ///   holds no more than <paramref name="target"/> bytes.
+        /// </summary>
+        /// <remarks>The cache must be locked.</remarks>
+        void trim(size_t target);
+    };
+}  // namespace rainbow
+
+#endif
@@ -0,0 +1,272 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "FileSystem/AsyncIO.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "Common/TypeCast.h"
+#include "FileSystem/FileSystem.h"
+
+using rainbow::AsyncIO;
+using rainbow::czstring;
+using rainbow::Data;
+using rainbow::FileType;
+using rainbow::IOPriority;
+
+AsyncIO::AsyncIO(size_t num_threads) : pool_(num_threads)
+{
+    make_global();
+}
+
+AsyncIO::~AsyncIO()
+{
+    // Drop pending reads, but make sure writes are not lost. Writes held
+    // back by one in flight are picked up by its worker before the pool
+    // joins.
+    clear();
+    while (process_next())
+    {
+    }
+}
+
+auto AsyncIO::pending() const -> size_t
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::accumulate(std::begin(queues_),
+                           std::end(queues_),
+                           in_flight_ + completed_.size(),
+                           [](size_t sum, auto&& queue) {
+                               return sum + queue.size();
+                           });
+}
+
+auto AsyncIO::cancel(RequestId id) -> bool
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto&& queue : queues_)
+    {
+        auto i = std::find_if(
+            std::begin(queue), std::end(queue), [id](auto&& request) {
+                return request->id == id;
+            });
+        if (i != std::end(queue))
+        {
+            queue.erase(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AsyncIO::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto&& queue : queues_)
+    {
+        queue.erase(std::remove_if(std::begin(queue),
+                                   std::end(queue),
+                                   [](auto&& request) {
+                                       return !request->is_write;
+                                   }),
+                    std::end(queue));
+        for (auto&& request : queue)
+            request->on_write = nullptr;
+    }
+    completed_.clear();
+    ++generation_;
+}
+
+auto AsyncIO::read(czstring path,
+                   FileType file_type,
+                   IOPriority priority,
+                   ReadCallback callback) -> RequestId
+{
+    return enqueue(priority,
+                   std::make_unique<Request>(Request{0,
+                                                     0,
+                                                     false,
+                                                     path,
+                                                     file_type,
+                                                     {},
+                                                     std::move(callback),
+                                                     {},
+                                                     false}));
+}
+
+auto AsyncIO::write(czstring path,
+                    Data data,
+                    IOPriority priority,
+                    WriteCallback callback) -> RequestId
+{
+    return enqueue(priority,
+                   std::make_unique<Request>(Request{0,
+                                                     0,
+                                                     true,
+                                                     path,
+                                                     FileType::UserFile,
+                                                     std::move(data),
+                                                     {},
+                                                     std::move(callback),
+                                                     false}));
+}
+
+auto AsyncIO::write(czstring path,
+                    const void* buffer,
+                    size_t size,
+                    IOPriority priority,
+                    WriteCallback callback) -> RequestId
+{
+    auto snapshot = std::make_unique<uint8_t[]>(size);  // NOLINT
+    std::copy_n(static_cast<const uint8_t*>(buffer), size, snapshot.get());
+    return write(path,
+                 {snapshot.release(), size, Data::Ownership::Owner},
+                 priority,
+                 std::move(callback));
+}
+
+void AsyncIO::update()
+{
+    if (pool_.size() == 0)
+    {
+        while (process_next())
+        {
+        }
+    }
+
+    std::vector<std::unique_ptr<Request>> completed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        completed.swap(completed_);
+    }
+
+    for (auto&& request : completed)
+    {
+        if (request->is_write)
+        {
+            if (request->on_write)
+                request->on_write(request->success);
+        }
+        else if (request->on_read)
+        {
+            request->on_read(std::move(request->data));
+        }
+    }
+}
+
+auto AsyncIO::enqueue(IOPriority priority, std::unique_ptr<Request> request)
+    -> RequestId
+{
+    RequestId id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Skip zero on wrap-around; it is reserved for "no request".
+        if (++next_id_ == 0)
+            ++next_id_;
+
+        id = next_id_;
+        request->id = id;
+        request->generation = generation_;
+        queues_[to_underlying_type(priority)].push_back(std::move(request));
+    }
+
+    if (pool_.size() > 0)
+    {
+        // Keep going; writes held back by this one may now be ready.
+        pool_.submit([this] {
+            while (process_next())
+            {
+            }
+        });
+    }
+
+    return id;
+}
+
+auto AsyncIO::is_ready(const Request& request) const -> bool
+{
+    if (!request.is_write)
+        return true;
+
+    if (std::find(std::begin(writing_), std::end(writing_), request.path) !=
+        std::end(writing_))
+    {
+        return false;
+    }
+
+    // Request ids are handed out in order, modulo wrap-around.
+    return std::none_of(
+        std::begin(queues_), std::end(queues_), [&request](auto&& queue) {
+            return std::any_of(
+                std::begin(queue), std::end(queue), [&request](auto&& r) {
+                    return r->is_write && r->path == request.path &&
+                           static_cast<int32_t>(r->id - request.id) < 0;
+                });
+        });
+}
+
+auto AsyncIO::process_next() -> bool
+{
+    std::unique_ptr<Request> request;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto queue = std::rbegin(queues_);
+             queue != std::rend(queues_) && request == nullptr;
+             ++queue)
+        {
+            auto i = std::find_if(
+                std::begin(*queue), std::end(*queue), [this](auto&& r) {
+                    return is_ready(*r);
+                });
+            if (i != std::end(*queue))
+            {
+                request = std::move(*i);
+                queue->erase(i);
+            }
+        }
+
+        // The request this task was submitted for may have been cancelled,
+        // served by another task, or held back by a write to the same path.
+        if (request == nullptr)
+            return false;
+
+        ++in_flight_;
+        if (request->is_write)
+            writing_.push_back(request->path);
+    }
+
+    if (request->is_write)
+    {
+        request->success = filesystem::write_atomically(request->path.c_str(),
+                                                        request->data);
+    }
+    else
+    {
+        auto data = File::read(request->path.c_str(), request->file_type);
+        const bool success = static_cast<bool>(data);
+        request = std::make_unique<Request>(Request{request->id,
+                                                    request->generation,
+                                                    false,
+                                                    std::move(request->path),
+                                                    request->file_type,
+                                                    std::move(data),
+                                                    std::move(request->on_read),
+                                                    {},
+                                                    success});
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    --in_flight_;
+    if (request->is_write)
+    {
+        writing_.erase(std::find(
+            std::begin(writing_), std::end(writing_), request->path));
+    }
+    if (request->generation == generation_)
+        completed_.push_back(std::move(request));
+    return true;
+}
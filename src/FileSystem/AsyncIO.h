@@ -0,0 +1,158 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef FILESYSTEM_ASYNCIO_H_
+#define FILESYSTEM_ASYNCIO_H_
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/Data.h"
+#include "Common/Global.h"
+#include "FileSystem/File.h"
+#include "Threading/ThreadPool.h"
+
+namespace rainbow
+{
+    enum class IOPriority
+    {
+        Low,
+        Normal,
+        High
+    };
+
+    /// <summary>
+    ///   Reads and writes files on a small pool of I/O threads. Completion
+    ///   callbacks are always invoked on the thread calling
+    ///   <see cref="update"/>, i.e. the game thread.
+    /// </summary>
+    /// <remarks>
+    ///   Pending requests are served in order of priority, then in the order
+    ///   they were made. Requests that have already been picked up by an I/O
+    ///   thread cannot be cancelled. Writes to the same path are always
+    ///   applied in the order they were made, regardless of priority.
+    /// </remarks>
+    class AsyncIO : public Global<AsyncIO>
+    {
+    public:
+        using ReadCallback = std::function<void(Data)>;
+        using WriteCallback = std::function<void(bool)>;
+
+        /// <summary>Identifies a request. Zero is never a valid id.</summary>
+        using RequestId = uint32_t;
+
+        /// <summary>
+        ///   Creates a service with specified number of I/O threads.
+        /// </summary>
+        /// <remarks>
+        ///   Without threads, pending requests are served in
+        ///   <see cref="update"/> instead.
+        /// </remarks>
+        explicit AsyncIO(size_t num_threads);
+
+        /// <summary>
+        ///   Drops pending reads, but blocks until all writes have completed.
+        /// </summary>
+        ~AsyncIO();
+
+        /// <summary>Returns the number of requests not yet delivered.</summary>
+        [[nodiscard]] auto pending() const -> size_t;
+
+        /// <summary>
+        ///   Cancels specified request if it has not been started. Its
+        ///   callback will not be invoked.
+        /// </summary>
+        /// <returns>Whether the request was cancelled.</returns>
+        auto cancel(RequestId id) -> bool;
+
+        /// <summary>
+        ///   Cancels all pending reads and drops the callbacks of all
+        ///   requests, including those that are already being served.
+        /// </summary>
+        /// <remarks>
+        ///   Pending writes are not cancelled so that no data is lost, e.g.
+        ///   when the game is restarted right after saving.
+        /// </remarks>
+        void clear();
+
+        /// <summary>
+        ///   Reads the file at specified path. <paramref name="callback"/>
+        ///   receives its contents, or an empty buffer on failure.
+        /// </summary>
+        auto read(czstring path,
+                  FileType file_type,
+                  IOPriority priority,
+                  ReadCallback callback) -> RequestId;
+
+        /// <summary>
+        ///   Writes <paramref name="data"/> to specified path in the user data
+        ///   directory. <paramref name="callback"/> receives whether the file
+        ///   was replaced.
+        /// </summary>
+        /// <remarks>
+        ///   The file is replaced atomically, i.e. it is never left partially
+        ///   written. See <see cref="filesystem::write_atomically"/>. If
+        ///   <paramref name="data"/> does not own its buffer, the buffer must
+        ///   outlive the request.
+        /// </remarks>
+        auto write(czstring path,
+                   Data data,
+                   IOPriority priority,
+                   WriteCallback callback) -> RequestId;
+
+        /// <summary>
+        ///   Same as above, but writes a snapshot of <paramref name="buffer"/>
+        ///   so that it can be modified as soon as this call returns.
+        /// </summary>
+        auto write(czstring path,
+                   const void* buffer,
+                   size_t size,
+                   IOPriority priority,
+                   WriteCallback callback) -> RequestId;
+
+        /// <summary>Invokes callbacks of completed requests.</summary>
+        void update();
+
+    private:
+        struct Request
+        {
+            RequestId id;
+            uint32_t generation;
+            bool is_write;
+            std::string path;
+            FileType file_type;
+
+            // Data to write, or the contents that were read.
+            Data data;
+
+            ReadCallback on_read;
+            WriteCallback on_write;
+            bool success;
+        };
+
+        std::array<std::deque<std::unique_ptr<Request>>, 3> queues_;
+        std::vector<std::unique_ptr<Request>> completed_;
+        std::vector<std::string> writing_;  // Paths being written
+        size_t in_flight_ = 0;
+        RequestId next_id_ = 0;
+        uint32_t generation_ = 0;
+        mutable std::mutex mutex_;
+
+        // Must be destroyed first as its workers reference the members above.
+        ThreadPool pool_;
+
+        auto enqueue(IOPriority priority, std::unique_ptr<Request> request)
+            -> RequestId;
+        [[nodiscard]] auto is_ready(const Request& request) const -> bool;
+        auto process_next() -> bool;
+    };
+}  // namespace rainbow
+
+#endif
@@ -10,11 +10,13 @@ using rainbow::filesystem::Path;
 
 namespace
 {
-    auto is_zip_file(const Path& path)
+    auto is_archive(const Path& path)
     {
         constexpr std::array<uint8_t, 4> kPKZIP{'P', 'K', 0x03, 0x04};
+        constexpr std::array<uint8_t, 4> kRPAK{'R', 'P', 'A', 'K'};
         auto header = rainbow::system::file_header(path.c_str());
-        return memcmp(header.data(), kPKZIP.data(), kPKZIP.size()) == 0;
+        return memcmp(header.data(), kPKZIP.data(), kPKZIP.size()) == 0 ||
+               memcmp(header.data(), kRPAK.data(), kRPAK.size()) == 0;
     }
 }  // namespace
 
@@ -37,7 +39,7 @@ Bundle::Bundle(ArrayView<zstring> args) : main_script_(nullptr)
 
         if (system::is_regular_file(script_path.c_str()))
         {
-            if (is_zip_file(script_path))
+            if (is_archive(script_path))
             {
                 assets_path_ = std::move(script_path);
                 return;
@@ -5,6 +5,7 @@
 #ifndef FILESYSTEM_FILE_H_
 #define FILESYSTEM_FILE_H_
 
+#include <algorithm>
 #include <climits>
 #include <cstdint>
 #include <functional>
@@ -15,6 +16,9 @@
 #include "Common/Logging.h"
 #include "Common/NonCopyable.h"
 #include "Common/String.h"
+#include "FileSystem/FileSystem.h"
+#include "FileSystem/MappedFile.h"
+#include "FileSystem/Pack.h"
 #include "Platform/Macros.h"
 
 #ifdef RAINBOW_OS_ANDROID
@@ -93,6 +97,49 @@ namespace rainbow
             return read(file);
         }
 
+        /// <summary>
+        ///   Maps the file at specified path into memory if it lives directly
+        ///   on disk. Uncompressed members of mounted packs are returned
+        ///   without copying. Other archive members, and files that cannot be
+        ///   mapped, are read into memory instead.
+        /// </summary>
+        /// <remarks>
+        ///   Unlike <see cref="read"/>, the returned buffer is not necessarily
+        ///   null-terminated. Use it only where the size is respected. Pack
+        ///   members are only valid for as long as the pack stays mounted.
+        /// </remarks>
+        static auto map(czstring path, FileType file_type) -> Data
+        {
+#ifndef RAINBOW_OS_ANDROID
+            if (!is_empty(path))
+            {
+                const auto resolved_path = T::resolve_path(path, file_type);
+                const auto real_dir = PHYSFS_getRealDir(resolved_path.c_str());
+
+                // Files inside archives resolve to the archive itself.
+                if (real_dir != nullptr && system::is_directory(real_dir))
+                {
+                    filesystem::Path real_path{real_dir};
+                    real_path /= resolved_path;
+                    auto file = MappedFile::open(real_path.c_str());
+                    if (file)
+                        return file.release();
+                }
+                else if (real_dir != nullptr)
+                {
+                    const auto name = resolved_path.generic_string();
+                    const auto start =
+                        std::min(name.find_first_not_of('/'), name.size());
+                    auto data = pack::view(
+                        real_dir, std::string_view{name}.substr(start));
+                    if (data)
+                        return data;
+                }
+            }
+#endif
+            return read(path, file_type);
+        }
+
         constexpr TFile() = default;
         TFile(TFile&& file) noexcept : T(std::move(file)) {}
 
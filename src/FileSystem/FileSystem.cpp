@@ -4,12 +4,23 @@
 
 #include "FileSystem/FileSystem.h"
 
+#include <atomic>
+#include <cstdio>
+#include <string>
+
 #include "Platform/Macros.h"
 #if HAS_FILESYSTEM
 #    include <filesystem>
 #else
 #    include <climits>
 #    include <sys/stat.h>
+#endif
+#ifdef RAINBOW_OS_WINDOWS
+#    define WIN32_LEAN_AND_MEAN
+#    include <Windows.h>
+#    include <io.h>
+#else
+#    include <fcntl.h>
 #    include <unistd.h>
 #endif
 
@@ -20,12 +31,57 @@ extern ANativeActivity* g_native_activity;
 
 #include <physfs.h>
 
+#include "Common/Data.h"
 #include "Common/Logging.h"
 #include "FileSystem/Bundle.h"
+#include "FileSystem/Pack.h"
 
 namespace
 {
     const rainbow::Bundle* g_bundle{};
+
+    /// <summary>
+    ///   Flushes <paramref name="file"/> all the way to disk before closing it.
+    /// </summary>
+    auto sync_and_close(FILE* file) -> bool
+    {
+        bool synced = std::fflush(file) == 0;
+#ifdef RAINBOW_OS_WINDOWS
+        synced = synced && _commit(_fileno(file)) == 0;
+#else
+        synced = synced && fsync(fileno(file)) == 0;
+#endif
+        return std::fclose(file) == 0 && synced;
+    }
+
+    /// <summary>
+    ///   Renames <paramref name="from"/> to <paramref name="to"/>, replacing
+    ///   the destination in a single step.
+    /// </summary>
+    auto replace_file(const std::string& from, const std::string& to) -> bool
+    {
+#ifdef RAINBOW_OS_WINDOWS
+        return MoveFileExA(from.c_str(),
+                           to.c_str(),
+                           MOVEFILE_REPLACE_EXISTING |
+                               MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    /// <summary>Makes a rename within specified directory durable.</summary>
+    void sync_directory([[maybe_unused]] const std::string& path)
+    {
+#ifndef RAINBOW_OS_WINDOWS
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        fsync(fd);
+        close(fd);
+#endif
+    }
 }  // namespace
 
 auto rainbow::filesystem::bundle() -> const Bundle&
@@ -67,6 +123,7 @@ void rainbow::filesystem::initialize(const Bundle& bundle,
     }
 
     PHYSFS_permitSymbolicLinks(static_cast<int>(allow_symlinks));
+    pack::register_archiver();
 
     if (!is_empty(bundle.assets_path()) &&
         PHYSFS_mount(bundle.assets_path(), nullptr, 0) == 0)
@@ -152,6 +209,45 @@ auto rainbow::filesystem::remove(czstring path) -> bool
     return PHYSFS_delete(path) != 0;
 }
 
+auto rainbow::filesystem::write_atomically(czstring path, const Data& data)
+    -> bool
+{
+    // Each write gets its own temporary file so that concurrent writes to the
+    // same path cannot interleave.
+    static std::atomic<uint32_t> s_counter{0};
+
+    const auto write_dir = PHYSFS_getWriteDir();
+    if (write_dir == nullptr || is_empty(path))
+        return false;
+
+    Path target{write_dir};
+    target /= path;
+    const auto target_path = target.string();
+    const auto temp_path =
+        target_path + '.' + std::to_string(s_counter++) + ".tmp";
+
+    auto file = std::fopen(temp_path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        LOGE("Failed to create '%s'", temp_path.c_str());
+        return false;
+    }
+
+    const bool written =
+        data.size() == 0 ||
+        std::fwrite(data.bytes(), data.size(), 1, file) == 1;
+    if (!sync_and_close(file) || !written ||
+        !replace_file(temp_path, target_path))
+    {
+        LOGE("Failed to write '%s'", target_path.c_str());
+        std::remove(temp_path.c_str());
+        return false;
+    }
+
+    sync_directory(target.parent_path().string());
+    return true;
+}
+
 auto rainbow::system::absolute_path(czstring path) -> std::string
 {
 #if HAS_FILESYSTEM
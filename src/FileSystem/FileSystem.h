@@ -13,6 +13,7 @@
 namespace rainbow
 {
     class Bundle;
+    class Data;
 }  // namespace rainbow
 
 namespace rainbow::filesystem
@@ -77,6 +78,15 @@ namespace rainbow::filesystem
     /// <summary>Removes a file or empty directory.</summary>
     auto remove(czstring path) -> bool;
     inline auto remove(const Path& path) { return remove(path.c_str()); }
+
+    /// <summary>
+    ///   Writes <paramref name="data"/> to specified path in the user data
+    ///   directory. The data is first written to a temporary file, flushed to
+    ///   disk, then renamed over the destination. The file is left either
+    ///   untouched or completely written should the process die midway.
+    /// </summary>
+    /// <returns>Whether the file was replaced.</returns>
+    auto write_atomically(czstring path, const Data& data) -> bool;
 }  // namespace rainbow::filesystem
 
 namespace rainbow::system
@@ -0,0 +1,104 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "FileSystem/MappedFile.h"
+
+#include "Platform/Macros.h"
+#ifdef RAINBOW_OS_WINDOWS
+#    define WIN32_LEAN_AND_MEAN
+#    include <Windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "Common/Logging.h"
+
+using rainbow::czstring;
+using rainbow::MappedFile;
+
+auto MappedFile::open(czstring path) -> MappedFile
+{
+#ifdef RAINBOW_OS_WINDOWS
+    auto file = CreateFileA(path,
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return {};
+
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return {};
+    }
+
+    auto mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+        return {};
+
+    // The view keeps the mapping alive after its handle is closed.
+    auto address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (address == nullptr)
+    {
+        LOGW("Failed to map '%s' into memory", path);
+        return {};
+    }
+
+    return {address, static_cast<size_t>(file_size.QuadPart)};
+#else
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return {};
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return {};
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+
+    // The mapping holds its own reference to the file.
+    auto address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+    if (address == MAP_FAILED)
+    {
+        LOGW("Failed to map '%s' into memory", path);
+        return {};
+    }
+
+    return {address, size};
+#endif
+}
+
+void rainbow::detail::unmap(void* address, [[maybe_unused]] size_t size)
+{
+#ifdef RAINBOW_OS_WINDOWS
+    UnmapViewOfFile(address);
+#else
+    munmap(address, size);
+#endif
+}
+
+void MappedFile::close()
+{
+    if (address_ == nullptr)
+        return;
+
+    detail::unmap(address_, size_);
+    address_ = nullptr;
+    size_ = 0;
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef FILESYSTEM_MAPPEDFILE_H_
+#define FILESYSTEM_MAPPEDFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Common/Data.h"
+#include "Common/NonCopyable.h"
+#include "Common/String.h"
+
+namespace rainbow
+{
+    /// <summary>Read-only, memory-mapped view of a file on disk.</summary>
+    /// <remarks>
+    ///   Pages are loaded on demand and are backed by the file itself, so the
+    ///   operating system can reclaim them under memory pressure.
+    /// </remarks>
+    class MappedFile : private NonCopyable<MappedFile>
+    {
+    public:
+        /// <summary>Maps the file at specified system path.</summary>
+        /// <returns>
+        ///   Mapped file on success; an empty instance if the file does not
+        ///   exist, is empty, or could not be mapped.
+        /// </returns>
+        static auto open(czstring path) -> MappedFile;
+
+        MappedFile() = default;
+
+        MappedFile(MappedFile&& file) noexcept
+            : address_(file.address_), size_(file.size_)
+        {
+            file.address_ = nullptr;
+            file.size_ = 0;
+        }
+
+        ~MappedFile() { close(); }
+
+        [[nodiscard]] auto data() const
+        {
+            return static_cast<const uint8_t*>(address_);
+        }
+
+        [[nodiscard]] auto size() const { return size_; }
+
+        auto operator=(MappedFile&& file) noexcept -> MappedFile&
+        {
+            if (&file != this)
+            {
+                close();
+                address_ = file.address_;
+                size_ = file.size_;
+                file.address_ = nullptr;
+                file.size_ = 0;
+            }
+            return *this;
+        }
+
+        /// <summary>
+        ///   Transfers the mapping to a <see cref="Data"/> object, which
+        ///   unmaps it on destruction.
+        /// </summary>
+        [[nodiscard]] auto release() -> Data
+        {
+            Data data{address_, size_, Data::Ownership::Mapped};
+            address_ = nullptr;
+            size_ = 0;
+            return data;
+        }
+
+        explicit operator bool() const { return address_ != nullptr; }
+
+    private:
+        void* address_ = nullptr;
+        size_t size_ = 0;
+
+        MappedFile(void* address, size_t size) : address_(address), size_(size)
+        {
+        }
+
+        void close();
+    };
+}  // namespace rainbow
+
+#endif
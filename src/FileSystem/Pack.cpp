@@ -0,0 +1,567 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "FileSystem/Pack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <physfs.h>
+
+#include "Common/Logging.h"
+#include "FileSystem/MappedFile.h"
+
+using rainbow::Data;
+using rainbow::MappedFile;
+using rainbow::pack::Compression;
+using rainbow::pack::Entry;
+using rainbow::pack::Header;
+using rainbow::pack::Reader;
+
+namespace
+{
+    constexpr uint32_t kMinMatch = 4;
+
+    /// <summary>Returns the offset of the table of contents.</summary>
+    constexpr auto entries_offset(uint32_t slot_count) -> uint64_t
+    {
+        // Entries contain 64-bit integers and must be 8-byte aligned.
+        return (sizeof(Header) + slot_count * sizeof(uint32_t) + 7) & ~7ULL;
+    }
+
+    auto read_length(const uint8_t*& src, const uint8_t* end, size_t& length)
+    {
+        uint8_t b = 0;
+        do
+        {
+            if (src == end)
+                return false;
+
+            b = *src++;
+            length += b;
+        } while (b == 255);
+        return true;
+    }
+
+    /// <summary>An open file inside a mounted pack.</summary>
+    struct Stream
+    {
+        const Reader* pack = nullptr;
+        const Entry* entry = nullptr;
+        const uint8_t* data = nullptr;
+        std::unique_ptr<uint8_t[]> buffer;  // NOLINT(*-avoid-c-arrays)
+        uint64_t position = 0;
+    };
+
+    /// <summary>A mounted pack.</summary>
+    struct Archive
+    {
+        PHYSFS_Io* io;
+        std::string name;
+        Reader reader;
+
+        Archive(PHYSFS_Io* io_, const char* name_, Data data)
+            : io(io_), name(name_), reader(std::move(data))
+        {
+        }
+    };
+
+    /// <summary>Mounted packs, used to look up views of entries.</summary>
+    std::mutex archives_lock;
+    std::vector<Archive*> archives;
+
+    auto open_stream(const Reader& pack, const Entry& entry) -> PHYSFS_Io*;
+
+    auto stream_of(PHYSFS_Io* io) { return static_cast<Stream*>(io->opaque); }
+
+    auto stream_read(PHYSFS_Io* io, void* buffer, PHYSFS_uint64 length)
+        -> PHYSFS_sint64
+    {
+        auto stream = stream_of(io);
+        const auto count =
+            std::min(length, stream->entry->size - stream->position);
+        if (count > 0)
+        {
+            std::memcpy(buffer, stream->data + stream->position, count);
+            stream->position += count;
+        }
+        return static_cast<PHYSFS_sint64>(count);
+    }
+
+    auto stream_write(PHYSFS_Io*, const void*, PHYSFS_uint64) -> PHYSFS_sint64
+    {
+        PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+        return -1;
+    }
+
+    auto stream_seek(PHYSFS_Io* io, PHYSFS_uint64 offset) -> int
+    {
+        auto stream = stream_of(io);
+        if (offset > stream->entry->size)
+        {
+            PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+            return 0;
+        }
+
+        stream->position = offset;
+        return 1;
+    }
+
+    auto stream_tell(PHYSFS_Io* io) -> PHYSFS_sint64
+    {
+        return static_cast<PHYSFS_sint64>(stream_of(io)->position);
+    }
+
+    auto stream_length(PHYSFS_Io* io) -> PHYSFS_sint64
+    {
+        return stream_of(io)->entry->size;
+    }
+
+    auto stream_duplicate(PHYSFS_Io* io) -> PHYSFS_Io*
+    {
+        auto stream = stream_of(io);
+        return open_stream(*stream->pack, *stream->entry);
+    }
+
+    auto stream_flush(PHYSFS_Io*) -> int { return 1; }
+
+    void stream_destroy(PHYSFS_Io* io)
+    {
+        delete stream_of(io);  // NOLINT(cppcoreguidelines-owning-memory)
+        delete io;             // NOLINT(cppcoreguidelines-owning-memory)
+    }
+
+    auto open_stream(const Reader& pack, const Entry& entry) -> PHYSFS_Io*
+    {
+        auto stream = std::make_unique<Stream>();
+        stream->pack = &pack;
+        stream->entry = &entry;
+
+        // Uncompressed entries are read straight from the pack.
+        stream->data = pack.view(entry);
+        if (stream->data == nullptr)
+        {
+            // NOLINTNEXTLINE(*-avoid-c-arrays)
+            stream->buffer = std::make_unique<uint8_t[]>(entry.size);
+            if (!pack.read(entry, stream->buffer.get()))
+            {
+                PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+                return nullptr;
+            }
+
+            stream->data = stream->buffer.get();
+        }
+
+        return new PHYSFS_Io{  // NOLINT(cppcoreguidelines-owning-memory)
+            0,
+            stream.release(),
+            stream_read,
+            stream_write,
+            stream_seek,
+            stream_tell,
+            stream_length,
+            stream_duplicate,
+            stream_flush,
+            stream_destroy,
+        };
+    }
+
+    auto reader_of(void* opaque) -> const Reader&
+    {
+        return static_cast<Archive*>(opaque)->reader;
+    }
+
+    auto read_all(PHYSFS_Io* io) -> Data
+    {
+        const auto length = io->length(io);
+        if (length <= 0 || io->seek(io, 0) == 0)
+            return {};
+
+        const auto size = static_cast<size_t>(length);
+        auto buffer = std::make_unique<uint8_t[]>(size);  // NOLINT
+        if (io->read(io, buffer.get(), size) != length)
+            return {};
+
+        return {buffer.release(), size, Data::Ownership::Owner};
+    }
+
+    /// <summary>
+    ///   Maps packs that live directly on disk. Anything else, e.g. packs
+    ///   inside other archives, is read into memory.
+    /// </summary>
+    auto map_or_read(PHYSFS_Io* io, const char* name) -> Data
+    {
+        auto file = MappedFile::open(name);
+        if (file && static_cast<PHYSFS_sint64>(file.size()) == io->length(io))
+            return file.release();
+
+        return read_all(io);
+    }
+
+    auto open_archive(PHYSFS_Io* io,
+                      const char* name,
+                      int for_write,
+                      int* claimed) -> void*
+    {
+        uint8_t header[sizeof(Header)];  // NOLINT(*-avoid-c-arrays)
+        if (io->read(io, header, sizeof(header)) != sizeof(header) ||
+            !rainbow::pack::is_pack(header, sizeof(header)))
+        {
+            return nullptr;
+        }
+
+        *claimed = 1;
+        if (for_write != 0)
+        {
+            PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+            return nullptr;
+        }
+
+        auto archive =
+            std::make_unique<Archive>(io, name, map_or_read(io, name));
+        if (!archive->reader)
+        {
+            PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> guard(archives_lock);
+        archives.push_back(archive.get());
+        return archive.release();
+    }
+
+    auto enumerate(void* opaque,
+                   const char* dirname,
+                   PHYSFS_EnumerateCallback callback,
+                   const char* origdir,
+                   void* callbackdata) -> PHYSFS_EnumerateCallbackResult
+    {
+        auto result = PHYSFS_ENUM_OK;
+        reader_of(opaque).enumerate(dirname, [&](std::string_view name) {
+            const std::string filename{name};
+            result = callback(callbackdata, origdir, filename.c_str());
+            return result == PHYSFS_ENUM_OK;
+        });
+        return result;
+    }
+
+    auto open_read(void* opaque, const char* name) -> PHYSFS_Io*
+    {
+        const auto& reader = reader_of(opaque);
+        auto entry = reader.find(name);
+        if (entry == nullptr)
+        {
+            PHYSFS_setErrorCode(reader.is_directory(name)
+                                    ? PHYSFS_ERR_NOT_A_FILE
+                                    : PHYSFS_ERR_NOT_FOUND);
+            return nullptr;
+        }
+
+        return open_stream(reader, *entry);
+    }
+
+    auto open_write(void*, const char*) -> PHYSFS_Io*
+    {
+        PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+        return nullptr;
+    }
+
+    auto remove_file(void*, const char*) -> int
+    {
+        PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+        return 0;
+    }
+
+    auto stat_file(void* opaque, const char* name, PHYSFS_Stat* stat) -> int
+    {
+        const auto& reader = reader_of(opaque);
+        if (auto entry = reader.find(name))
+        {
+            stat->filesize = entry->size;
+            stat->filetype = PHYSFS_FILETYPE_REGULAR;
+        }
+        else if (reader.is_directory(name))
+        {
+            stat->filesize = 0;
+            stat->filetype = PHYSFS_FILETYPE_DIRECTORY;
+        }
+        else
+        {
+            PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+            return 0;
+        }
+
+        stat->modtime = -1;
+        stat->createtime = -1;
+        stat->accesstime = -1;
+        stat->readonly = 1;
+        return 1;
+    }
+
+    void close_archive(void* opaque)
+    {
+        auto archive = static_cast<Archive*>(opaque);
+        {
+            std::lock_guard<std::mutex> guard(archives_lock);
+            archives.erase(
+                std::find(archives.begin(), archives.end(), archive));
+        }
+
+        archive->io->destroy(archive->io);
+        delete archive;  // NOLINT(cppcoreguidelines-owning-memory)
+    }
+}  // namespace
+
+auto rainbow::pack::is_pack(const uint8_t* data, size_t size) -> bool
+{
+    if (size < sizeof(Header))
+        return false;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    return header.magic == kMagic && header.version == kVersion;
+}
+
+auto rainbow::pack::lz4_decompress(const uint8_t* src,
+                                   size_t src_size,
+                                   uint8_t* dst,
+                                   size_t dst_size) -> bool
+{
+    const uint8_t* const src_end = src + src_size;
+    uint8_t* const dst_begin = dst;
+    uint8_t* const dst_end = dst + dst_size;
+
+    while (src < src_end)
+    {
+        const uint8_t token = *src++;
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !read_length(src, src_end, literals))
+            return false;
+
+        if (literals > static_cast<size_t>(src_end - src) ||
+            literals > static_cast<size_t>(dst_end - dst))
+        {
+            return false;
+        }
+
+        std::memcpy(dst, src, literals);
+        src += literals;
+        dst += literals;
+
+        // The last sequence consists of literals only.
+        if (src == src_end)
+            break;
+
+        if (src_end - src < 2)
+            return false;
+
+        const size_t offset = src[0] | (src[1] << 8);
+        src += 2;
+        if (offset == 0 || offset > static_cast<size_t>(dst - dst_begin))
+            return false;
+
+        size_t length = token & 0xf;
+        if (length == 15 && !read_length(src, src_end, length))
+            return false;
+
+        length += kMinMatch;
+        if (length > static_cast<size_t>(dst_end - dst))
+            return false;
+
+        // Matches may overlap with the bytes they produce, so copy one byte
+        // at a time.
+        const uint8_t* match = dst - offset;
+        for (size_t i = 0; i < length; ++i)
+            dst[i] = match[i];
+        dst += length;
+    }
+
+    return dst == dst_end;
+}
+
+void rainbow::pack::register_archiver()
+{
+    static const PHYSFS_Archiver archiver{
+        0,
+        {
+            "RPK",
+            "Rainbow asset pack",
+            "Bifrost Entertainment AS and Tommy Nguyen",
+            "https://github.com/tido64/rainbow",
+            0,
+        },
+        open_archive,
+        enumerate,
+        open_read,
+        open_write,
+        open_write,
+        remove_file,
+        remove_file,
+        stat_file,
+        close_archive,
+    };
+
+    if (PHYSFS_registerArchiver(&archiver) == 0)
+    {
+        const auto error_code = PHYSFS_getLastErrorCode();
+        LOGE("PhysicsFS: Failed to register pack archiver: %s",
+             PHYSFS_getErrorByCode(error_code));
+    }
+}
+
+auto rainbow::pack::view(czstring archive, std::string_view name) -> Data
+{
+    std::lock_guard<std::mutex> guard(archives_lock);
+    auto i = std::find_if(archives.begin(), archives.end(), [archive](auto a) {
+        return a->name == archive;
+    });
+    if (i == archives.end())
+        return {};
+
+    const auto& reader = (*i)->reader;
+    auto entry = reader.find(name);
+    if (entry == nullptr)
+        return {};
+
+    auto bytes = reader.view(*entry);
+    return bytes == nullptr
+               ? Data{}
+               : Data{bytes, entry->size, Data::Ownership::Reference};
+}
+
+Reader::Reader(Data data) : data_(std::move(data))
+{
+    if (!validate())
+    {
+        LOGE("Pack: Invalid or corrupt pack");
+        entries_ = nullptr;
+        directories_.clear();
+    }
+}
+
+auto Reader::find(std::string_view name) const -> const Entry*
+{
+    if (entries_ == nullptr)
+        return nullptr;
+
+    const auto h = hash(name);
+    const auto mask = header_->slot_count - 1;
+    for (uint32_t i = 0, slot = h & mask; i < header_->slot_count;
+         ++i, slot = (slot + 1) & mask)
+    {
+        const auto index = slots_[slot];
+        if (index == 0)
+            break;
+
+        const auto& entry = entries_[index - 1];
+        if (entry.hash == h && this->name(entry) == name)
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+auto Reader::is_directory(std::string_view name) const -> bool
+{
+    return entries_ != nullptr && (name.empty() || directories_.contains(name));
+}
+
+auto Reader::name(const Entry& entry) const -> std::string_view
+{
+    return {names_ + entry.name_offset, entry.name_length};
+}
+
+auto Reader::read(const Entry& entry, uint8_t* dst) const -> bool
+{
+    const auto src = data_.bytes() + entry.offset;
+    switch (entry.compression)
+    {
+        case Compression::None:
+            std::memcpy(dst, src, entry.size);
+            return true;
+        case Compression::LZ4:
+            return lz4_decompress(src, entry.stored_size, dst, entry.size);
+        default:
+            return false;
+    }
+}
+
+auto Reader::view(const Entry& entry) const -> const uint8_t*
+{
+    return entry.compression != Compression::None
+               ? nullptr
+               : data_.bytes() + entry.offset;
+}
+
+auto Reader::validate() -> bool
+{
+    const auto size = static_cast<uint64_t>(data_.size());
+    if (!data_ || !is_pack(data_.bytes(), data_.size()))
+        return false;
+
+    header_ = data_.as<const Header*>();
+    if (!is_pow2(header_->slot_count) || !is_pow2(header_->alignment) ||
+        header_->slot_count < header_->entry_count)
+    {
+        return false;
+    }
+
+    const auto toc = entries_offset(header_->slot_count);
+    const auto names = toc + uint64_t{header_->entry_count} * sizeof(Entry);
+    if (names + header_->names_size > size)
+        return false;
+
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    slots_ = reinterpret_cast<const uint32_t*>(data_.bytes() + sizeof(Header));
+    entries_ = reinterpret_cast<const Entry*>(data_.bytes() + toc);
+    names_ = reinterpret_cast<const char*>(data_.bytes() + names);
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    for (uint32_t i = 0; i < header_->slot_count; ++i)
+    {
+        if (slots_[i] > header_->entry_count)
+            return false;
+    }
+
+    for (auto&& entry : entries())
+    {
+        if (uint64_t{entry.name_offset} + entry.name_length >=
+                header_->names_size ||
+            names_[entry.name_offset + entry.name_length] != '\0' ||
+            entry.offset + entry.stored_size > size ||
+            entry.offset % header_->alignment != 0)
+        {
+            return false;
+        }
+
+        switch (entry.compression)
+        {
+            case Compression::None:
+                if (entry.stored_size != entry.size)
+                    return false;
+                break;
+            case Compression::LZ4:
+                break;
+            default:
+                return false;
+        }
+
+        const auto entry_name = name(entry);
+        if (entry.hash != hash(entry_name))
+            return false;
+
+        for (auto i = entry_name.find('/'); i != std::string_view::npos;
+             i = entry_name.find('/', i + 1))
+        {
+            directories_.insert(entry_name.substr(0, i));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,222 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef FILESYSTEM_PACK_H_
+#define FILESYSTEM_PACK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <absl/container/flat_hash_set.h>
+
+#include "Common/Algorithm.h"
+#include "Common/Data.h"
+#include "Common/NonCopyable.h"
+#include "Common/String.h"
+
+/// <summary>Rainbow asset pack (.rpk).</summary>
+/// <remarks>
+///   <para>Layout, all integers are little-endian:</para>
+///   <list type="number">
+///     <item><see cref="Header"/></item>
+///     <item>
+///       Hash table of <c>Header::slot_count</c> 32-bit slots. Each slot holds
+///       an entry index + 1, or 0 if empty. Collisions are resolved by linear
+///       probing.
+///     </item>
+///     <item>Table of contents; <c>Header::entry_count</c> entries.</item>
+///     <item>Null-terminated, '/'-separated entry names.</item>
+///     <item>
+///       File contents, each starting at a multiple of
+///       <c>Header::alignment</c> so that uncompressed entries can be used
+///       straight from mapped pages.
+///     </item>
+///   </list>
+///   <para>Packs are built with <c>tools/build-pack.js</c>.</para>
+/// </remarks>
+namespace rainbow::pack
+{
+    constexpr uint32_t kMagic = 0x4b415052;  // "RPAK"
+    constexpr uint32_t kVersion = 1;
+
+    enum class Compression : uint16_t
+    {
+        None,
+        LZ4,
+    };
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t slot_count;
+        uint32_t alignment;
+        uint32_t names_size;
+        uint64_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 32);
+
+    struct Entry
+    {
+        uint64_t hash;
+        uint64_t offset;
+        uint32_t size;
+        uint32_t stored_size;
+        uint32_t name_offset;
+        uint16_t name_length;
+        Compression compression;
+    };
+
+    static_assert(sizeof(Entry) == 32);
+
+    /// <summary>Returns the hash of specified entry name.</summary>
+    inline auto hash(std::string_view name)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto bytes = reinterpret_cast<const uint8_t*>(name.data());
+        return fnv1a(bytes, name.size());
+    }
+
+    /// <summary>Returns whether the buffer starts with a pack header.</summary>
+    auto is_pack(const uint8_t* data, size_t size) -> bool;
+
+    /// <summary>
+    ///   Decompresses an LZ4 block into a buffer of exactly
+    ///   <paramref name="dst_size"/> bytes.
+    /// </summary>
+    /// <returns>
+    ///   <c>true</c> if the block was well-formed and filled the destination.
+    /// </returns>
+    auto lz4_decompress(const uint8_t* src,
+                        size_t src_size,
+                        uint8_t* dst,
+                        size_t dst_size) -> bool;
+
+    /// <summary>
+    ///   Registers the pack archiver with PhysicsFS so that packs can be
+    ///   mounted like directories or zip files.
+    /// </summary>
+    void register_archiver();
+
+    /// <summary>
+    ///   Returns the contents of <paramref name="name"/> in the mounted pack
+    ///   <paramref name="archive"/> without copying. Empty if the pack is not
+    ///   mounted, or the entry does not exist or is compressed.
+    /// </summary>
+    /// <remarks>
+    ///   The returned buffer points straight into the pack and is only valid
+    ///   for as long as the pack stays mounted.
+    /// </remarks>
+    auto view(czstring archive, std::string_view name) -> Data;
+
+    /// <summary>Read-only view of a pack.</summary>
+    class Reader : private NonCopyable<Reader>
+    {
+    public:
+        /// <summary>
+        ///   Opens the pack in <paramref name="data"/>, which is typically
+        ///   memory-mapped. The table of contents is validated up front.
+        /// </summary>
+        explicit Reader(Data data);
+
+        /// <summary>
+        ///   Returns the entry with specified name; <c>nullptr</c> if not
+        ///   found.
+        /// </summary>
+        [[nodiscard]] auto find(std::string_view name) const -> const Entry*;
+
+        /// <summary>
+        ///   Returns whether <paramref name="name"/> is a directory. The empty
+        ///   string denotes the root directory.
+        /// </summary>
+        [[nodiscard]] auto is_directory(std::string_view name) const -> bool;
+
+        /// <summary>Returns the null-terminated name of an entry.</summary>
+        [[nodiscard]] auto name(const Entry& entry) const -> std::string_view;
+
+        /// <summary>
+        ///   Copies the contents of <paramref name="entry"/>, decompressing
+        ///   if necessary. <paramref name="dst"/> must be able to hold
+        ///   <c>entry.size</c> bytes.
+        /// </summary>
+        auto read(const Entry& entry, uint8_t* dst) const -> bool;
+
+        /// <summary>
+        ///   Returns the contents of an uncompressed entry without copying;
+        ///   <c>nullptr</c> if the entry is compressed.
+        /// </summary>
+        [[nodiscard]] auto view(const Entry& entry) const -> const uint8_t*;
+
+        /// <summary>
+        ///   Calls <paramref name="callback"/> with the name of every file and
+        ///   directory directly beneath <paramref name="directory"/>.
+        /// </summary>
+        template <typename F>
+        auto enumerate(std::string_view directory, F&& callback) const
+        {
+            for (auto&& entry : entries())
+            {
+                const auto entry_name = name(entry);
+                if (parent_of(entry_name) == directory &&
+                    !callback(basename(entry_name)))
+                {
+                    return false;
+                }
+            }
+
+            for (auto&& dir : directories_)
+            {
+                if (parent_of(dir) == directory && !callback(basename(dir)))
+                    return false;
+            }
+
+            return true;
+        }
+
+        explicit operator bool() const { return entries_ != nullptr; }
+
+    private:
+        Data data_;
+        const Header* header_ = nullptr;
+        const uint32_t* slots_ = nullptr;
+        const Entry* entries_ = nullptr;
+        const char* names_ = nullptr;
+        absl::flat_hash_set<std::string_view> directories_;
+
+        static auto basename(std::string_view path)
+        {
+            return path.substr(path.rfind('/') + 1);
+        }
+
+        static auto parent_of(std::string_view path)
+        {
+            const auto i = path.rfind('/');
+            return i == std::string_view::npos ? std::string_view{}
+                                               : path.substr(0, i);
+        }
+
+        [[nodiscard]] auto entries() const
+        {
+            struct Range
+            {
+                const Entry* first;
+                const Entry* last;
+
+                [[nodiscard]] auto begin() const { return first; }
+                [[nodiscard]] auto end() const { return last; }
+            };
+
+            return entries_ == nullptr
+                       ? Range{nullptr, nullptr}
+                       : Range{entries_, entries_ + header_->entry_count};
+        }
+
+        auto validate() -> bool;
+    };
+}  // namespace rainbow::pack
+
+#endif
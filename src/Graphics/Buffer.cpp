@@ -81,3 +81,10 @@ void Buffer::upload(const void* data, size_t size) const
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STREAM_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
+
+void Buffer::update(const void* data, size_t size, size_t offset) const
+{
+    glBindBuffer(GL_ARRAY_BUFFER, id_);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -35,6 +35,17 @@ namespace rainbow::graphics
         /// </summary>
         void upload(const void* data, size_t size) const;
 
+        /// <summary>
+        ///   Overwrites <paramref name="size"/> bytes of the GPU buffer,
+        ///   starting at <paramref name="offset"/>, with
+        ///   <paramref name="data"/> without reallocating it.
+        /// </summary>
+        /// <remarks>
+        ///   The buffer must have been uploaded with at least
+        ///   <paramref name="offset"/> + <paramref name="size"/> bytes.
+        /// </remarks>
+        void update(const void* data, size_t size, size_t offset = 0) const;
+
 #ifdef RAINBOW_TEST
         explicit Buffer(const ISolemnlySwearThatIAmOnlyTesting&) : id_(0) {}
 #endif
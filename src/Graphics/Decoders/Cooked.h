@@ -0,0 +1,100 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_DECODERS_COOKED_H_
+#define GRAPHICS_DECODERS_COOKED_H_
+
+#include <algorithm>
+#include <memory>
+
+#include "Common/Logging.h"
+#include "Cooker/Formats.h"
+
+namespace cooked
+{
+    auto header_of(const rainbow::Data& data)
+    {
+        return rainbow::cooker::header_of<rainbow::cooker::TextureHeader>(
+            data.bytes(), data.size());
+    }
+
+    bool check(const rainbow::Data& data)
+    {
+        return header_of(data) != nullptr;
+    }
+
+    /// <summary>
+    ///   Decodes a cooked texture. 8-bit RGBA pixels are used straight from
+    ///   <paramref name="data"/>; other formats are copied.
+    /// </summary>
+    auto decode(const rainbow::Data& data)
+    {
+        using rainbow::Image;
+        using rainbow::cooker::TextureFormat;
+
+        const auto& header = *header_of(data);
+
+        Image::Format format = Image::Format::Unknown;
+        uint32_t depth = 16;
+        uint32_t channels = 4;
+        switch (header.format)
+        {
+            case TextureFormat::RGBA8888:
+                format = Image::Format::RGBA;
+                depth = 32;
+                break;
+            case TextureFormat::LuminanceAlpha:
+                format = Image::Format::PNG;
+                channels = 2;
+                break;
+            case TextureFormat::RGBA4444:
+                format = Image::Format::RGBA4444;
+                break;
+            case TextureFormat::RGBA5551:
+                format = Image::Format::RGBA5551;
+                break;
+            case TextureFormat::RGB565:
+                format = Image::Format::RGB565;
+                channels = 3;
+                break;
+        }
+
+        const size_t size =
+            static_cast<size_t>(header.width) * header.height * (depth / 8);
+        if (format == Image::Format::Unknown ||
+            data.size() - sizeof(header) < size)
+        {
+            LOGE("Cooked texture is invalid or truncated");
+            return Image{};
+        }
+
+        const auto pixels = data.bytes() + sizeof(header);
+        if (format == Image::Format::RGBA)
+        {
+            return Image{
+                format,
+                header.width,
+                header.height,
+                depth,
+                channels,
+                size,
+                pixels,
+            };
+        }
+
+        auto buffer = std::make_unique<uint8_t[]>(size);  // NOLINT
+        std::copy_n(pixels, size, buffer.get());
+        return Image{
+            format,
+            header.width,
+            header.height,
+            depth,
+            channels,
+            size,
+            buffer.release(),
+        };
+    }
+}  // namespace cooked
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "Common/Algorithm.h"
 #include "ThirdParty/NanoSVG/NanoSVG.h"
+#include "Threading/ThreadPool.h"
 
 #define USE_SVG
 
@@ -30,6 +31,20 @@ namespace std
 
 namespace svg
 {
+    /// <summary>
+    ///   Minimum number of rows per tile. Every tile processes all the shapes
+    ///   in the image, so tiles that are too small end up costing more than
+    ///   they save.
+    /// </summary>
+    constexpr int kMinTileHeight = 64;
+
+    /// <summary>
+    ///   Number of rows rasterized, then thrown away, on either side of a
+    ///   tile. NanoSVG fills in the colour of transparent pixels from their
+    ///   neighbours, including those in the rows above and below.
+    /// </summary>
+    constexpr int kTilePadding = 2;
+
     bool check(const rainbow::Data& data)
     {
         const auto p = data.bytes();
@@ -41,14 +56,73 @@ namespace svg
                p[4] == ' ';
     }
 
+    /// <summary>
+    ///   Rasterizes <paramref name="img"/> in <paramref name="num_tiles"/>
+    ///   horizontal tiles concurrently.
+    /// </summary>
+    void rasterize(NSVGimage* img,
+                   float scale,
+                   uint8_t* dst,
+                   int width,
+                   int height,
+                   int stride,
+                   int num_tiles)
+    {
+        // Each tile is rasterized with a few extra rows of its neighbours so
+        // that pixels along the seams come out the same as they would if the
+        // image was rasterized in one go.
+        const int tile_height = (height + num_tiles - 1) / num_tiles;
+        rainbow::ThreadPool::shared().parallel_for(num_tiles, [&](size_t i) {
+            const int y = static_cast<int>(i) * tile_height;
+            if (y >= height)
+                return;
+
+            const int rows = std::min(tile_height, height - y);
+            const int top = std::min(y, kTilePadding);
+            const int bottom = std::min(kTilePadding, height - y - rows);
+            const int padded_rows = top + rows + bottom;
+
+            auto out = dst + static_cast<ptrdiff_t>(y) * stride;
+            std::unique_ptr<uint8_t[]> tile;
+            if (padded_rows != rows)
+            {
+                tile = std::make_unique<uint8_t[]>(
+                    static_cast<size_t>(padded_rows) * stride);
+                out = tile.get();
+            }
+
+            std::unique_ptr<NSVGrasterizer> rasterizer{nsvgCreateRasterizer()};
+            nsvgRasterize(  //
+                rasterizer.get(),
+                img,
+                0.0f,
+                static_cast<float>(top - y),
+                scale,
+                out,
+                width,
+                padded_rows,
+                stride);
+
+            if (tile)
+            {
+                std::copy_n(tile.get() + static_cast<ptrdiff_t>(top) * stride,
+                            static_cast<size_t>(rows) * stride,
+                            dst + static_cast<ptrdiff_t>(y) * stride);
+            }
+        });
+    }
+
     auto decode(const rainbow::Data& data, float scale)
     {
         rainbow::Image image{rainbow::Image::Format::SVG};
 
         std::unique_ptr<NSVGimage> img;
         {
-            auto svg = std::make_unique<char[]>(data.size());
+            // nanosvg parses in place and expects a null-terminated string,
+            // which mapped buffers are not.
+            auto svg = std::make_unique<char[]>(data.size() + 1);
             std::copy(data.bytes(), data.bytes() + data.size(), svg.get());
+            svg[data.size()] = '\0';
             img.reset(nsvgParse(svg.get(), "px", 96.0f));
             if (img == nullptr)
                 return image;
@@ -60,18 +134,20 @@ namespace svg
         image.channels = 4;
         image.size = static_cast<size_t>(image.width) * image.height * 4;
 
+        const int height = static_cast<int>(img->height * scale);
+        const int num_tiles = std::clamp(
+            height / kMinTileHeight,
+            1,
+            static_cast<int>(rainbow::ThreadPool::shared().size()) + 1);
+
         auto buffer = std::make_unique<uint8_t[]>(image.size);
-        std::unique_ptr<NSVGrasterizer> rasterizer{nsvgCreateRasterizer()};
-        nsvgRasterize(  //
-            rasterizer.get(),
-            img.get(),
-            0.0f,
-            0.0f,
-            scale,
-            buffer.get(),
-            img->width * scale,
-            img->height * scale,
-            image.width * 4);
+        rasterize(img.get(),
+                  scale,
+                  buffer.get(),
+                  static_cast<int>(img->width * scale),
+                  height,
+                  static_cast<int>(image.width) * 4,
+                  num_tiles);
 
         image.data = buffer.release();
         return image;
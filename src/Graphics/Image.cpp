@@ -4,11 +4,18 @@
 
 #include "Graphics/Image.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "Common/Data.h"
 #include "Common/Logging.h"
+#include "Graphics/Decoders/Cooked.h"
 #include "Graphics/Decoders/PNG.h"
 #include "Graphics/Decoders/SVG.h"
 #include "Graphics/OpenGL.h"
+#include "Graphics/RasterCache.h"
+#include "Graphics/Resample.h"
+#include "Graphics/Texture.h"
 #ifdef GL_IMG_texture_compression_pvrtc
 #    include "Graphics/Decoders/PVRTC.h"
 #endif  // GL_IMG_texture_compression_pvrtc
@@ -18,9 +25,38 @@
 
 using rainbow::Data;
 using rainbow::Image;
+using rainbow::graphics::Filter;
+
+namespace
+{
+    auto scaled(uint32_t size, float scale)
+    {
+        return std::max(static_cast<uint32_t>(std::lround(size * scale)), 1U);
+    }
+}  // namespace
 
 auto Image::decode(const Data& data, float scale) -> Image
 {
+    return decode(data, scale, Filter::Linear);
+}
+
+auto Image::decode(const Data& data, float scale, Filter filter) -> Image
+{
+    if (cooked::check(data))
+    {
+        auto image = cooked::decode(data);
+        if (scale >= 1.0F || image.data == nullptr ||
+            image.depth != image.channels * 8)
+        {
+            return image;
+        }
+
+        return graphics::resample(image,
+                                  scaled(image.width, scale),
+                                  scaled(image.height, scale),
+                                  filter);
+    }
+
 #ifdef USE_DDS
     if (dds::check(data))
         return dds::decode(data);
@@ -32,10 +68,27 @@ auto Image::decode(const Data& data, float scale) -> Image
 #endif  // USE_PVRTC
 
     if (png::check(data))
-        return png::decode(data);
+    {
+        auto image = png::decode(data);
+        if (scale >= 1.0F || image.data == nullptr)
+            return image;
+
+        return graphics::resample(image,
+                                  scaled(image.width, scale),
+                                  scaled(image.height, scale),
+                                  filter);
+    }
 
     if (svg::check(data))
-        return svg::decode(data, scale);
+    {
+        auto cache = graphics::RasterCache::Get();
+        if (cache == nullptr)
+            return svg::decode(data, scale);
+
+        return cache->get(data, scale, [&data, scale] {
+            return svg::decode(data, scale);  //
+        });
+    }
 
 #ifdef RAINBOW_TEST
     if (memcmp(data.bytes(), "RNBWMOCK", 8) == 0)
@@ -10,6 +10,11 @@
 
 #include "Common/NonCopyable.h"
 
+namespace rainbow::graphics
+{
+    enum class Filter;
+}  // namespace rainbow::graphics
+
 namespace rainbow
 {
     class Data;
@@ -25,8 +30,12 @@ namespace rainbow
             BC3,    // DXT5
             ETC1,   // OpenGL ES standard
             PVRTC,  // iOS, OMAP43xx, PowerVR
+            Luminance,
             PNG,
+            RGB565,  // 16-bit packed
             RGBA,
+            RGBA4444,  // 16-bit packed
+            RGBA5551,  // 16-bit packed
             SVG,
         };
 
@@ -51,6 +60,13 @@ namespace rainbow
         /// </remarks>
         static auto decode(const Data&, float scale) -> Image;
 
+        /// <summary>
+        ///   Creates an Image struct from image data. PNGs are downscaled with
+        ///   the specified filter if <paramref name="scale"/> is less than 1.
+        /// </summary>
+        static auto decode(const Data&, float scale, graphics::Filter filter)
+            -> Image;
+
         Format format;        // NOLINT
         uint32_t width;       // NOLINT
         uint32_t height;      // NOLINT
@@ -95,10 +111,14 @@ namespace rainbow
                 case Format::BC3:
                 case Format::ETC1:
                 case Format::PVRTC:
+                case Format::Luminance:
                 case Format::RGBA:
                     break;
 
                 case Format::PNG:
+                case Format::RGB565:
+                case Format::RGBA4444:
+                case Format::RGBA5551:
                 case Format::SVG:
                 default:
                     delete[] data;
@@ -4,12 +4,16 @@
 
 #include "Graphics/Label.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "Math/Transform.h"
 #include "Script/GameBase.h"
 
 using rainbow::Color;
 using rainbow::czstring;
 using rainbow::GameBase;
+using rainbow::GlyphRendering;
 using rainbow::Label;
 using rainbow::TextAlignment;
 using rainbow::Vec2f;
@@ -65,10 +69,17 @@ auto Label::font_size(int font_size) -> Label&
     return *this;
 }
 
+auto Label::glyph_rendering(GlyphRendering rendering) -> Label&
+{
+    glyph_rendering_ = rendering;
+    set_needs_update(kStaleBuffer);
+    return *this;
+}
+
 auto Label::move(Vec2f delta) -> Label&
 {
     position_ += delta;
-    set_needs_update(kStaleBuffer);
+    set_needs_update(kStalePosition);
     return *this;
 }
 
@@ -76,7 +87,7 @@ auto Label::position(Vec2f position) -> Label&
 {
     position_.x = std::round(position.x);
     position_.y = std::round(position.y);
-    set_needs_update(kStaleBuffer);
+    set_needs_update(kStalePosition);
     return *this;
 }
 
@@ -93,6 +104,11 @@ auto Label::scale(float f) -> Label&
 
 auto Label::text(czstring text) -> Label&
 {
+    // Hold on to the text that is laid out, so that we only need to shape
+    // what has changed.
+    if ((stale_ & kStaleBuffer) == 0)
+        std::swap(previous_text_, text_);
+
     text_ = text;
     set_needs_update(kStaleBuffer);
     return *this;
@@ -100,41 +116,140 @@ auto Label::text(czstring text) -> Label&
 
 void Label::update(GameBase& context)
 {
-    if (stale_ != 0)
-    {
-        update_internal(context);
+    if (update_vertices(context))
         upload();
-        clear_state();
+}
+
+auto Label::update_vertices(GameBase& context) -> bool
+{
+    // Glyphs must be laid out again if their texture page was evicted.
+    auto& font_cache = context.typesetter().font_cache();
+    for (auto&& range : ranges_)
+    {
+        if (range.generation != font_cache.generation(range.page))
+        {
+            set_needs_update(kStaleBuffer);
+            break;
+        }
+
+        font_cache.touch(range.page);
     }
+
+    if (stale_ == 0)
+        return false;
+
+    update_internal(context);
+    clear_state();
+    return true;
 }
 
 void Label::update_internal(GameBase& context)
 {
+    // Changes accumulate until the vertices are uploaded, in case they are
+    // drawn by a LabelBatch in the meantime.
+    size_t first = 0;
+    size_t last = vertices_.size();
+
     if ((stale_ & kStaleBuffer) != 0)
     {
-        vertices_ = context.typesetter().draw_text(
-            text_,
-            position_,
-            TextAttributes{font_face_, font_size_, alignment_},
-            &size_);
-        for (auto&& vx : vertices_)
+        auto mesh = context.typesetter().draw_text(
+            text_, position_, text_attributes(), &size_, previous_text_);
+        previous_text_.clear();
+        for (auto&& vx : mesh.vertices)
             vx.color = color_;
+
+        // Counters and timers tend to only change a few glyphs at a time.
+        if (mesh.vertices.size() == vertices_.size())
+        {
+            auto equal = [](const SpriteVertex& lhs, const SpriteVertex& rhs) {
+                return memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+            };
+            auto head = std::mismatch(vertices_.begin(),
+                                      vertices_.end(),
+                                      mesh.vertices.begin(),
+                                      equal);
+            auto tail = std::mismatch(vertices_.rbegin(),
+                                      vertices_.rend(),
+                                      mesh.vertices.rbegin(),
+                                      equal);
+            const auto begin = head.first - vertices_.begin();
+            const auto end = vertices_.rend() - tail.first;
+            first = narrow_cast<size_t>(begin);
+            last = narrow_cast<size_t>(std::max(begin, end));
+        }
+
+        vertices_ = std::move(mesh.vertices);
+        ranges_ = std::move(mesh.ranges);
+        origin_ = position_;
+        dirty_first_ = std::min(dirty_first_, first);
+        dirty_last_ = std::max(dirty_last_, last);
+        return;
     }
-    else if ((stale_ & kStaleColor) != 0)
+
+    if ((stale_ & kStalePosition) != 0)
+    {
+        const auto delta = position_ - origin_;
+        for (auto&& vx : vertices_)
+            vx.position += delta;
+        origin_ = position_;
+    }
+
+    if ((stale_ & kStaleColor) != 0)
     {
         for (auto&& vx : vertices_)
             vx.color = color_;
     }
+
+    dirty_first_ = std::min(dirty_first_, first);
+    dirty_last_ = std::max(dirty_last_, last);
 }
 
-void Label::upload() const
+void Label::upload()
 {
-    buffer_.upload(vertices_.data(), vertices_.size() * sizeof(vertices_[0]));
+    constexpr auto kVertexSize = sizeof(SpriteVertex);
+
+    // The buffer only needs to be reallocated when the vertex count changes.
+    if (vertices_.size() != buffer_size_)
+    {
+        buffer_.upload(vertices_.data(), vertices_.size() * kVertexSize);
+        buffer_size_ = vertices_.size();
+    }
+    else if (const auto last = std::min(dirty_last_, vertices_.size());
+             dirty_first_ < last)
+    {
+        buffer_.update(vertices_.data() + dirty_first_,
+                       (last - dirty_first_) * kVertexSize,
+                       dirty_first_ * kVertexSize);
+    }
+
+    dirty_first_ = vertices_.size();
+    dirty_last_ = 0;
 }
 
 void rainbow::graphics::draw(Context& ctx, const Label& label)
 {
     auto& font_cache = *FontCache::Get();
-    bind(ctx, font_cache.texture());
-    draw(label.vertex_array(), label.vertex_count());
+    const bool distance_field =
+        label.glyph_rendering() == GlyphRendering::DistanceField;
+    auto context = ctx.shader_manager.use_scoped(
+        distance_field ? ShaderManager::kDistanceFieldProgram
+                       : ShaderManager::kTextProgram);
+    if (distance_field)
+        set_distance_field_smoothing(ctx, label.font_size());
+
+    for (auto&& range : label.glyph_ranges())
+    {
+        bind(ctx, font_cache.texture(range.page));
+        draw_elements(label.vertex_array(), range.first * 6, range.count * 6);
+    }
+}
+
+void rainbow::graphics::set_distance_field_smoothing(Context& ctx,
+                                                     int font_size)
+{
+    // Distance changes by 1 / (2 * spread) per pixel at the size glyphs were
+    // rasterized at; smooth over half a pixel at the given size.
+    const auto smoothing = narrow_cast<float>(FontCache::kDistanceFieldSize) /
+                           (4.0F * FontCache::kDistanceFieldSpread * font_size);
+    glUniform1f(ctx.shader_manager.distance_field_smoothing(), smoothing);
 }
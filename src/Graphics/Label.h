@@ -18,12 +18,20 @@
 #include "Graphics/SpriteVertex.h"
 #include "Graphics/VertexArray.h"
 #include "Math/Vec2.h"
+#include "Text/Typesetter.h"
 
 namespace rainbow
 {
     class GameBase;
 
     /// <summary>Label for displaying text.</summary>
+    /// <remarks>
+    ///   Text is only laid out again when its content, font, size or
+    ///   alignment changes. Moving or recoloring a label updates its existing
+    ///   vertices in place. When only part of the text changes, only the
+    ///   differing span is shaped again, and only the vertices that changed
+    ///   are uploaded.
+    /// </remarks>
     class Label : private NonCopyable<Label>
     {
     public:
@@ -31,6 +39,7 @@ namespace rainbow
         static constexpr uint32_t kStaleBuffer      = 1U << 0;
         static constexpr uint32_t kStaleBufferSize  = 1U << 1;
         static constexpr uint32_t kStaleColor       = 1U << 2;
+        static constexpr uint32_t kStalePosition    = 1U << 3;
         static constexpr uint32_t kStaleMask        = 0xffffU;
         // clang-format on
 
@@ -55,15 +64,42 @@ namespace rainbow
         /// <summary>Returns font size.</summary>
         [[nodiscard]] auto font_size() const { return font_size_; }
 
+        /// <summary>Returns how glyphs are rasterized.</summary>
+        [[nodiscard]] auto glyph_rendering() const { return glyph_rendering_; }
+
+        /// <summary>Returns glyphs grouped by texture page.</summary>
+        [[nodiscard]] auto glyph_ranges() const
+            -> const std::vector<GlyphRange>&
+        {
+            return ranges_;
+        }
+
         /// <summary>Returns label height.</summary>
         [[nodiscard]] auto height() const { return size_.y; }
 
+        /// <summary>
+        ///   Returns whether the text will be laid out again on next update.
+        /// </summary>
+        [[nodiscard]] auto needs_layout() const
+        {
+            return (stale_ & kStaleBuffer) != 0;
+        }
+
         /// <summary>Returns the number of characters.</summary>
         [[nodiscard]] auto length() const
         {
             return narrow_cast<uint32_t>(vertices_.size() / 4);
         }
 
+        /// <summary>
+        ///   Returns the text that is currently laid out, if it is about to be
+        ///   replaced; empty otherwise.
+        /// </summary>
+        [[nodiscard]] auto previous_text() const -> std::string_view
+        {
+            return previous_text_;
+        }
+
         /// <summary>Returns label position.</summary>
         [[nodiscard]] auto position() const { return position_; }
 
@@ -73,12 +109,24 @@ namespace rainbow
         /// <summary>Returns the string.</summary>
         [[nodiscard]] auto text() const { return text_.c_str(); }
 
+        /// <summary>Returns the attributes the text is laid out with.</summary>
+        [[nodiscard]] auto text_attributes() const -> TextAttributes
+        {
+            return {font_face_, font_size_, alignment_, glyph_rendering_};
+        }
+
         /// <summary>Returns the vertex array object.</summary>
         [[nodiscard]] auto vertex_array() const -> const graphics::VertexArray&
         {
             return array_;
         }
 
+        /// <summary>Returns the client vertex buffer.</summary>
+        [[nodiscard]] auto vertices() const -> const std::vector<SpriteVertex>&
+        {
+            return vertices_;
+        }
+
         /// <summary>Returns the vertex count.</summary>
         [[nodiscard]] auto vertex_count() const
         {
@@ -107,6 +155,12 @@ namespace rainbow
         /// <summary>Sets font size.</summary>
         auto font_size(int font_size) -> Label&;
 
+        /// <summary>
+        ///   Sets how glyphs are rasterized. Distance field glyphs are
+        ///   rasterized once and shared by all font sizes.
+        /// </summary>
+        auto glyph_rendering(GlyphRendering rendering) -> Label&;
+
         /// <summary>Moves label by (x,y).</summary>
         auto move(Vec2f) -> Label&;
 
@@ -124,6 +178,13 @@ namespace rainbow
         /// <summary>Populates the vertex array.</summary>
         void update(GameBase&);
 
+        /// <summary>
+        ///   Populates the client vertex buffer without uploading it. Used when
+        ///   the label is drawn as part of a <see cref="LabelBatch"/>.
+        /// </summary>
+        /// <returns>Whether any vertices changed.</returns>
+        auto update_vertices(GameBase&) -> bool;
+
     protected:
         [[nodiscard]] auto state() const { return stale_; }
         [[nodiscard]] auto vertex_buffer() const { return vertices_.data(); }
@@ -134,7 +195,7 @@ namespace rainbow
         void set_needs_update(unsigned int what) { stale_ |= what; }
 
         void update_internal(GameBase&);
-        void upload() const;
+        void upload();
 
     private:
         /// <summary>Flags indicating need for update.</summary>
@@ -146,9 +207,17 @@ namespace rainbow
         /// <summary>Client vertex buffer.</summary>
         std::vector<SpriteVertex> vertices_;
 
+        /// <summary>Glyphs grouped by texture page.</summary>
+        std::vector<GlyphRange> ranges_;
+
         /// <summary>Content of this label.</summary>
         std::string text_;
 
+        /// <summary>
+        ///   Text that is currently laid out, while new text is pending.
+        /// </summary>
+        std::string previous_text_;
+
         /// <summary>Font used to draw the text.</summary>
         std::string font_face_;
 
@@ -158,9 +227,15 @@ namespace rainbow
         /// <summary>Text alignment.</summary>
         TextAlignment alignment_ = TextAlignment::Left;
 
+        /// <summary>How glyphs are rasterized.</summary>
+        GlyphRendering glyph_rendering_ = GlyphRendering::Coverage;
+
         /// <summary>Position of the text (bottom left).</summary>
         Vec2f position_;
 
+        /// <summary>Position the vertices were last laid out at.</summary>
+        Vec2f origin_;
+
         /// <summary>Text colour.</summary>
         Color color_;
 
@@ -175,6 +250,15 @@ namespace rainbow
 
         /// <summary>Vertex buffer.</summary>
         graphics::Buffer buffer_;
+
+        /// <summary>Number of vertices the vertex buffer holds.</summary>
+        size_t buffer_size_ = 0;
+
+        /// <summary>
+        ///   Range of vertices that have changed since they were last uploaded.
+        /// </summary>
+        size_t dirty_first_ = 0;
+        size_t dirty_last_ = 0;
     };
 }  // namespace rainbow
 
@@ -183,6 +267,13 @@ namespace rainbow::graphics
     struct Context;
 
     void draw(Context&, const Label&);
+
+    /// <summary>
+    ///   Sets how much distance field glyphs drawn at
+    ///   <paramref name="font_size"/> are smoothed. The distance field program
+    ///   must be in use.
+    /// </summary>
+    void set_distance_field_smoothing(Context&, int font_size);
 }  // namespace rainbow::graphics
 
 #endif
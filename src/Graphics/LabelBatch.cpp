@@ -0,0 +1,298 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/LabelBatch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include "Graphics/Label.h"
+#include "Script/GameBase.h"
+
+using rainbow::GameBase;
+using rainbow::GlyphRendering;
+using rainbow::Label;
+using rainbow::LabelBatch;
+using rainbow::LayoutRequest;
+using rainbow::SpriteVertex;
+using rainbow::narrow_cast;
+using rainbow::detail::GlyphBatch;
+using rainbow::graphics::Context;
+using rainbow::graphics::ShaderManager;
+
+namespace
+{
+    constexpr uint32_t kNotPlaced = std::numeric_limits<uint32_t>::max();
+
+    struct Span
+    {
+        uint32_t label;
+        uint32_t range;
+        uint32_t page;
+        int font_size;
+    };
+
+    auto source_of(const Label& label) -> GlyphBatch::Source
+    {
+        const int font_size =
+            label.glyph_rendering() == GlyphRendering::DistanceField
+                ? label.font_size()
+                : 0;
+        return {label.vertices(), label.glyph_ranges(), font_size};
+    }
+}  // namespace
+
+void GlyphBatch::rebuild(const std::vector<Source>& sources)
+{
+    // Group glyphs by shader and texture page so that each group can be drawn
+    // with a single call. Distance field glyphs are also smoothed differently
+    // depending on font size.
+    std::vector<Span> spans;
+    layouts_.clear();
+    layouts_.reserve(sources.size());
+    for (uint32_t i = 0; i < sources.size(); ++i)
+    {
+        const auto& source = sources[i];
+        auto& layout = layouts_.emplace_back();
+        layout.font_size = source.font_size;
+        layout.placements.reserve(source.ranges.size());
+        for (uint32_t j = 0; j < source.ranges.size(); ++j)
+        {
+            const auto& range = source.ranges[j];
+            layout.placements.push_back(
+                {range.page, range.first, kNotPlaced, range.count});
+            spans.push_back({i, j, range.page, source.font_size});
+        }
+    }
+
+    std::stable_sort(
+        spans.begin(), spans.end(), [](const Span& lhs, const Span& rhs) {
+            return lhs.font_size < rhs.font_size ||
+                   (lhs.font_size == rhs.font_size && lhs.page < rhs.page);
+        });
+
+    vertices_.clear();
+    draw_calls_.clear();
+    dirty_.clear();
+    uint32_t glyph_count = 0;
+    for (auto&& span : spans)
+    {
+        auto& placement = layouts_[span.label].placements[span.range];
+        if (glyph_count + placement.count > graphics::kMaxSprites)
+        {
+            LOGW("LabelBatch: Hard-coded limit reached (%zu glyphs)",
+                 graphics::kMaxSprites);
+            break;
+        }
+
+        if (draw_calls_.empty() || draw_calls_.back().page != span.page ||
+            draw_calls_.back().font_size != span.font_size)
+        {
+            draw_calls_.push_back({span.page, span.font_size, glyph_count, 0});
+        }
+
+        const auto* vertices =
+            sources[span.label].vertices.data() + placement.source * 4;
+        vertices_.insert(
+            vertices_.end(), vertices, vertices + placement.count * 4);
+        placement.target = glyph_count;
+        draw_calls_.back().count += placement.count;
+        glyph_count += placement.count;
+    }
+}
+
+auto GlyphBatch::update(size_t index, const Source& source) -> bool
+{
+    R_ASSERT(index < layouts_.size(), "Label has not been laid out");
+
+    const auto& layout = layouts_[index];
+    const auto& placements = layout.placements;
+    if (source.font_size != layout.font_size ||
+        source.ranges.size() != placements.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < placements.size(); ++i)
+    {
+        const auto& range = source.ranges[i];
+        const auto& placement = placements[i];
+        if (range.page != placement.page || range.first != placement.source ||
+            range.count != placement.count)
+        {
+            return false;
+        }
+    }
+
+    // Only vertices that differ need to be uploaded again. Counters and
+    // timers tend to only change a few glyphs at a time.
+    auto equal = [](const SpriteVertex& lhs, const SpriteVertex& rhs) {
+        return memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+    };
+    for (auto&& placement : placements)
+    {
+        if (placement.target == kNotPlaced)
+            continue;
+
+        const auto first = vertices_.begin() + placement.target * 4;
+        const auto last = first + placement.count * 4;
+        const auto src = source.vertices.begin() + placement.source * 4;
+
+        const auto head = std::mismatch(first, last, src, equal);
+        if (head.first == last)
+            continue;
+
+        const auto tail =
+            std::mismatch(std::make_reverse_iterator(last),
+                          std::make_reverse_iterator(head.first),
+                          std::make_reverse_iterator(src + placement.count * 4),
+                          equal);
+        std::copy(head.second, tail.second.base(), head.first);
+        dirty_.push_back(
+            {narrow_cast<size_t>(head.first - vertices_.begin()),
+             narrow_cast<size_t>(tail.first.base() - vertices_.begin())});
+    }
+
+    return true;
+}
+
+auto GlyphBatch::take_dirty_ranges() -> std::vector<DirtyRange>
+{
+    std::sort(dirty_.begin(), dirty_.end(), [](auto&& lhs, auto&& rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    std::vector<DirtyRange> ranges;
+    for (auto&& range : dirty_)
+    {
+        if (ranges.empty() || range.first > ranges.back().last)
+            ranges.push_back(range);
+        else
+            ranges.back().last = std::max(ranges.back().last, range.last);
+    }
+
+    dirty_.clear();
+    return ranges;
+}
+
+LabelBatch::LabelBatch()
+{
+    array_.reconfigure([this] { buffer_.bind(); });
+}
+
+void LabelBatch::add(Label& label)
+{
+    R_ASSERT(std::find(labels_.begin(), labels_.end(), &label) ==
+                 labels_.end(),
+             "Label was already added to this batch");
+
+    labels_.push_back(&label);
+    stale_ = true;
+}
+
+void LabelBatch::clear()
+{
+    labels_.clear();
+    stale_ = true;
+}
+
+void LabelBatch::remove(const Label& label)
+{
+    auto i = std::find(labels_.begin(), labels_.end(), &label);
+    if (i == labels_.end())
+        return;
+
+    labels_.erase(i);
+    stale_ = true;
+}
+
+void LabelBatch::rebuild()
+{
+    std::vector<GlyphBatch::Source> sources;
+    sources.reserve(labels_.size());
+    for (auto&& label : labels_)
+        sources.push_back(source_of(*label));
+
+    batch_.rebuild(sources);
+
+    constexpr auto kVertexSize = sizeof(SpriteVertex);
+    const auto& vertices = batch_.vertices();
+    if (vertices.size() != buffer_size_)
+    {
+        buffer_.upload(vertices.data(), vertices.size() * kVertexSize);
+        buffer_size_ = vertices.size();
+    }
+    else
+    {
+        buffer_.update(vertices.data(), vertices.size() * kVertexSize);
+    }
+}
+
+void LabelBatch::draw_impl(Context& ctx) const
+{
+    const auto& draw_calls = batch_.draw_calls();
+    if (draw_calls.empty())
+        return;
+
+    auto& font_cache = *FontCache::Get();
+    auto context = ctx.shader_manager.use_scoped(ShaderManager::kTextProgram);
+    int font_size = 0;
+    for (auto&& call : draw_calls)
+    {
+        if (call.font_size != font_size)
+        {
+            ctx.shader_manager.use(ShaderManager::kDistanceFieldProgram);
+            graphics::set_distance_field_smoothing(ctx, call.font_size);
+            font_size = call.font_size;
+        }
+
+        bind(ctx, font_cache.texture(call.page));
+        draw_elements(array_, call.first * 6, call.count * 6);
+    }
+}
+
+void LabelBatch::update_impl(GameBase& context, uint64_t)
+{
+    // Shape the text of all stale labels up front, so that it can be done in
+    // parallel.
+    std::vector<LayoutRequest> layouts;
+    for (auto&& label : labels_)
+    {
+        if (label->needs_layout())
+        {
+            layouts.push_back({label->text(),
+                               label->text_attributes(),
+                               label->previous_text()});
+        }
+    }
+
+    if (!layouts.empty())
+        context.typesetter().prepare(layouts);
+
+    bool stale = stale_;
+    for (size_t i = 0; i < labels_.size(); ++i)
+    {
+        auto& label = *labels_[i];
+        if (label.update_vertices(context) && !stale)
+            stale = !batch_.update(i, source_of(label));
+    }
+
+    if (stale)
+    {
+        rebuild();
+        stale_ = false;
+        return;
+    }
+
+    constexpr auto kVertexSize = sizeof(SpriteVertex);
+    const auto& vertices = batch_.vertices();
+    for (auto&& range : batch_.take_dirty_ranges())
+    {
+        buffer_.update(vertices.data() + range.first,
+                       (range.last - range.first) * kVertexSize,
+                       range.first * kVertexSize);
+    }
+}
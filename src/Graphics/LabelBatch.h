@@ -0,0 +1,191 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_LABELBATCH_H_
+#define GRAPHICS_LABELBATCH_H_
+
+#include <vector>
+
+#include "Common/NonCopyable.h"
+#include "Graphics/Buffer.h"
+#include "Graphics/Drawable.h"
+#include "Graphics/SpriteVertex.h"
+#include "Graphics/VertexArray.h"
+#include "Text/Typesetter.h"
+
+namespace rainbow
+{
+    class Label;
+
+    namespace detail
+    {
+        /// <summary>
+        ///   Glyphs of a set of labels, grouped by texture page and font
+        ///   size. Does the bookkeeping of <see cref="LabelBatch"/> without
+        ///   touching the GPU.
+        /// </summary>
+        class GlyphBatch
+        {
+        public:
+            struct DrawCall
+            {
+                uint32_t page;
+                int font_size;  // Only set for distance field glyphs
+                uint32_t first;
+                uint32_t count;
+            };
+
+            /// <summary>Vertices [first, last) that have changed.</summary>
+            struct DirtyRange
+            {
+                size_t first;
+                size_t last;
+            };
+
+            /// <summary>The glyphs of a single label.</summary>
+            struct Source
+            {
+                const std::vector<SpriteVertex>& vertices;
+                const std::vector<GlyphRange>& ranges;
+                int font_size;  // Only set for distance field glyphs
+            };
+
+            [[nodiscard]] auto draw_calls() const
+                -> const std::vector<DrawCall>&
+            {
+                return draw_calls_;
+            }
+
+            [[nodiscard]] auto vertices() const
+                -> const std::vector<SpriteVertex>&
+            {
+                return vertices_;
+            }
+
+            /// <summary>
+            ///   Lays out the glyphs of all <paramref name="sources"/> from
+            ///   scratch, in draw call order.
+            /// </summary>
+            void rebuild(const std::vector<Source>& sources);
+
+            /// <summary>
+            ///   Copies the vertices of <paramref name="source"/> that have
+            ///   changed since the last time, to where label
+            ///   <paramref name="index"/> was laid out.
+            /// </summary>
+            /// <returns>
+            ///   <c>false</c> if the glyphs no longer fit where they were laid
+            ///   out, e.g. because their texture page or count changed. The
+            ///   batch must then be rebuilt.
+            /// </returns>
+            auto update(size_t index, const Source& source) -> bool;
+
+            /// <summary>
+            ///   Returns the vertices changed by <see cref="update"/>, sorted
+            ///   and merged, and forgets them.
+            /// </summary>
+            auto take_dirty_ranges() -> std::vector<DirtyRange>;
+
+        private:
+            /// <summary>Where a range of glyphs was laid out.</summary>
+            struct Placement
+            {
+                uint32_t page;
+                uint32_t source;  // First glyph in the label
+                uint32_t target;  // First glyph in the batch
+                uint32_t count;
+            };
+
+            struct Layout
+            {
+                int font_size;
+                std::vector<Placement> placements;
+            };
+
+            std::vector<SpriteVertex> vertices_;
+            std::vector<DrawCall> draw_calls_;
+            std::vector<Layout> layouts_;
+            std::vector<DirtyRange> dirty_;
+        };
+    }  // namespace detail
+
+    /// <summary>A drawable batch of labels.</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Glyphs of all labels are packed into a shared vertex buffer, and
+    ///     are drawn with a single draw call per font texture page. Labels
+    ///     keep their own position, color, and text attributes.
+    ///   </para>
+    ///   <para>
+    ///     When a label changes, only its vertices that differ are uploaded,
+    ///     unless its glyphs moved to a different page or their number
+    ///     changed. The whole batch is then laid out again.
+    ///   </para>
+    ///   <para>
+    ///     Labels are not owned by the batch, and must not also be added to
+    ///     the render queue. Glyphs are drawn grouped by texture page, so
+    ///     overlapping labels may not be drawn in the order they were added.
+    ///   </para>
+    /// </remarks>
+    class LabelBatch final : public IDrawable, private NonCopyable<LabelBatch>
+    {
+    public:
+        LabelBatch();
+
+        /// <summary>Returns a pointer to the beginning.</summary>
+        [[nodiscard]] auto begin() const { return labels_.data(); }
+
+        /// <summary>Returns a pointer to the end.</summary>
+        [[nodiscard]] auto end() const { return begin() + labels_.size(); }
+
+        /// <summary>Returns the number of draw calls needed.</summary>
+        [[nodiscard]] auto draw_count() const
+        {
+            return batch_.draw_calls().size();
+        }
+
+        /// <summary>Returns label count.</summary>
+        [[nodiscard]] auto size() const { return labels_.size(); }
+
+        /// <summary>Adds a label to the batch.</summary>
+        void add(Label&);
+
+        /// <summary>Removes all labels.</summary>
+        void clear();
+
+        /// <summary>Removes a label from the batch.</summary>
+        void remove(const Label&);
+
+    private:
+        /// <summary>Labels drawn by this batch.</summary>
+        std::vector<Label*> labels_;
+
+        /// <summary>
+        ///   Client vertex buffer, and where each label is laid out in it.
+        /// </summary>
+        detail::GlyphBatch batch_;
+
+        /// <summary>Shared, interleaved vertex buffer.</summary>
+        graphics::Buffer buffer_;
+
+        /// <summary>Number of vertices the vertex buffer holds.</summary>
+        size_t buffer_size_ = 0;
+
+        /// <summary>Vertex array object.</summary>
+        graphics::VertexArray array_;
+
+        /// <summary>Whether labels were added or removed.</summary>
+        bool stale_ = false;
+
+        /// <summary>Lays out all labels again and uploads them.</summary>
+        void rebuild();
+
+        // IDrawable implementation details
+
+        void draw_impl(graphics::Context&) const override;
+        void update_impl(GameBase&, uint64_t) override;
+    };
+}  // namespace rainbow
+
+#endif
@@ -16,9 +16,11 @@
 #elif defined(RAINBOW_OS_MACOS)
 #   define GL_SILENCE_DEPRECATION 1
 #   include <OpenGL/gl.h>
+#   include <OpenGL/glext.h>
 #   define glBindVertexArray     glBindVertexArrayAPPLE
 #   define glDeleteVertexArrays  glDeleteVertexArraysAPPLE
 #   define glGenVertexArrays     glGenVertexArraysAPPLE
+#   define glGenerateMipmap      glGenerateMipmapEXT
 #elif defined(RAINBOW_OS_WINDOWS)
 #   include <glad/glad.h>
 #else
@@ -0,0 +1,392 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/PixelFormat.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define USE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define USE_NEON 1
+#endif
+
+#include "Graphics/Image.h"
+
+using rainbow::Image;
+using rainbow::graphics::Dithering;
+using rainbow::graphics::PixelFormat;
+
+namespace
+{
+    constexpr size_t kBytesPerPixel = 4;
+
+    constexpr std::array<std::array<uint8_t, 4>, 4> kBayerMatrix{{
+        {0, 8, 2, 10},
+        {12, 4, 14, 6},
+        {3, 11, 1, 9},
+        {15, 7, 13, 5},
+    }};
+
+    /// <summary>Returns the number of bits per channel.</summary>
+    constexpr auto channel_depth(PixelFormat format) -> std::array<int, 4>
+    {
+        switch (format)
+        {
+            case PixelFormat::RGBA4444:
+                return {4, 4, 4, 4};
+            case PixelFormat::RGBA5551:
+                return {5, 5, 5, 1};
+            case PixelFormat::RGB565:
+                return {5, 6, 5, 0};
+            default:
+                return {8, 8, 8, 8};
+        }
+    }
+
+    /// <summary>
+    ///   Returns whether a channel of specified depth benefits from dithering.
+    ///   1-bit alpha is thresholded to avoid a screen-door effect on edges.
+    /// </summary>
+    constexpr auto is_dithered(int depth) { return depth > 1 && depth < 8; }
+
+    constexpr auto image_format(PixelFormat format)
+    {
+        switch (format)
+        {
+            case PixelFormat::RGBA4444:
+                return Image::Format::RGBA4444;
+            case PixelFormat::RGBA5551:
+                return Image::Format::RGBA5551;
+            case PixelFormat::RGB565:
+                return Image::Format::RGB565;
+            default:
+                return Image::Format::Unknown;
+        }
+    }
+
+    /// <summary>Reduces an 8-bit value to specified depth and back.</summary>
+    constexpr auto quantize(int value, int depth)
+    {
+        const int levels = (1 << depth) - 1;
+        const int q = (value * levels + 127) / 255;
+        return q * 255 / levels;
+    }
+
+    auto pack_pixel(const uint8_t* p, PixelFormat format) -> uint16_t
+    {
+        const uint32_t r = p[0];
+        const uint32_t g = p[1];
+        const uint32_t b = p[2];
+        const uint32_t a = p[3];
+        switch (format)
+        {
+            case PixelFormat::RGBA4444:
+                return static_cast<uint16_t>(((r & 0xf0) << 8) |
+                                             ((g & 0xf0) << 4) | (b & 0xf0) |
+                                             (a >> 4));
+            case PixelFormat::RGBA5551:
+                return static_cast<uint16_t>(((r & 0xf8) << 8) |
+                                             ((g & 0xf8) << 3) |
+                                             ((b & 0xf8) >> 2) | (a >> 7));
+            case PixelFormat::RGB565:
+                return static_cast<uint16_t>(((r & 0xf8) << 8) |
+                                             ((g & 0xfc) << 3) | (b >> 3));
+            default:
+                return 0;
+        }
+    }
+
+#if defined(USE_SSE2)
+    /// <summary>
+    ///   Packs four RGBA pixels. The result is stored in the lower half of each
+    ///   32-bit lane.
+    /// </summary>
+    auto pack_pixels(__m128i p, PixelFormat format) -> __m128i
+    {
+        switch (format)
+        {
+            case PixelFormat::RGBA4444:
+            {
+                const auto r = _mm_slli_epi32(
+                    _mm_and_si128(p, _mm_set1_epi32(0xf0)), 8);
+                const auto g = _mm_and_si128(_mm_srli_epi32(p, 4),
+                                             _mm_set1_epi32(0x0f00));
+                const auto b = _mm_and_si128(_mm_srli_epi32(p, 16),
+                                             _mm_set1_epi32(0x00f0));
+                const auto a = _mm_srli_epi32(p, 28);
+                return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+            }
+            case PixelFormat::RGBA5551:
+            {
+                const auto r = _mm_slli_epi32(
+                    _mm_and_si128(p, _mm_set1_epi32(0xf8)), 8);
+                const auto g = _mm_and_si128(_mm_srli_epi32(p, 5),
+                                             _mm_set1_epi32(0x07c0));
+                const auto b = _mm_and_si128(_mm_srli_epi32(p, 18),
+                                             _mm_set1_epi32(0x003e));
+                const auto a = _mm_srli_epi32(p, 31);
+                return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+            }
+            case PixelFormat::RGB565:
+            {
+                const auto r = _mm_slli_epi32(
+                    _mm_and_si128(p, _mm_set1_epi32(0xf8)), 8);
+                const auto g = _mm_and_si128(_mm_srli_epi32(p, 5),
+                                             _mm_set1_epi32(0x07e0));
+                const auto b = _mm_and_si128(_mm_srli_epi32(p, 19),
+                                             _mm_set1_epi32(0x001f));
+                return _mm_or_si128(_mm_or_si128(r, g), b);
+            }
+            default:
+                return _mm_setzero_si128();
+        }
+    }
+
+    /// <summary>Narrows 2x4 32-bit lanes to 8 16-bit lanes.</summary>
+    auto narrow(__m128i lo, __m128i hi) -> __m128i
+    {
+        // SSE2 only has signed saturation; sign-extend the lower halves so
+        // that saturation becomes a no-op.
+        lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        return _mm_packs_epi32(lo, hi);
+    }
+#elif defined(USE_NEON)
+    /// <summary>
+    ///   Packs 16 deinterleaved RGBA pixels into low and high bytes.
+    /// </summary>
+    auto pack_pixels(const uint8x16x4_t& p, PixelFormat format) -> uint8x16x2_t
+    {
+        const auto r = p.val[0];
+        const auto g = p.val[1];
+        const auto b = p.val[2];
+        const auto a = p.val[3];
+        switch (format)
+        {
+            case PixelFormat::RGBA4444:
+                return {{
+                    vorrq_u8(vandq_u8(b, vdupq_n_u8(0xf0)), vshrq_n_u8(a, 4)),
+                    vorrq_u8(vandq_u8(r, vdupq_n_u8(0xf0)), vshrq_n_u8(g, 4)),
+                }};
+            case PixelFormat::RGBA5551:
+                return {{
+                    vorrq_u8(vorrq_u8(vandq_u8(vshlq_n_u8(g, 3),
+                                               vdupq_n_u8(0xc0)),
+                                      vandq_u8(vshrq_n_u8(b, 2),
+                                               vdupq_n_u8(0x3e))),
+                             vshrq_n_u8(a, 7)),
+                    vorrq_u8(vandq_u8(r, vdupq_n_u8(0xf8)), vshrq_n_u8(g, 5)),
+                }};
+            case PixelFormat::RGB565:
+                return {{
+                    vorrq_u8(vandq_u8(vshlq_n_u8(g, 3), vdupq_n_u8(0xe0)),
+                             vshrq_n_u8(b, 3)),
+                    vorrq_u8(vandq_u8(r, vdupq_n_u8(0xf8)), vshrq_n_u8(g, 5)),
+                }};
+            default:
+                return {{vdupq_n_u8(0), vdupq_n_u8(0)}};
+        }
+    }
+#endif
+
+    /// <summary>
+    ///   Adds <paramref name="pattern"/> to every 16 bytes of
+    ///   <paramref name="src"/> with saturation.
+    /// </summary>
+    void add_saturated(const uint8_t* src,
+                       uint8_t* dst,
+                       size_t size,
+                       const std::array<uint8_t, 16>& pattern)
+    {
+        size_t i = 0;
+#if defined(USE_SSE2)
+        const auto offset =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.data()));
+        for (; i + 16 <= size; i += 16)
+        {
+            const auto p =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                             _mm_adds_epu8(p, offset));
+        }
+#elif defined(USE_NEON)
+        const auto offset = vld1q_u8(pattern.data());
+        for (; i + 16 <= size; i += 16)
+            vst1q_u8(dst + i, vqaddq_u8(vld1q_u8(src + i), offset));
+#endif
+        for (; i < size; ++i)
+        {
+            dst[i] = static_cast<uint8_t>(
+                std::min(src[i] + pattern[i % pattern.size()], 0xff));
+        }
+    }
+
+    /// <summary>
+    ///   Returns the Bayer offsets for a row, laid out as four RGBA pixels.
+    /// </summary>
+    auto ordered_pattern(size_t row, const std::array<int, 4>& depth)
+    {
+        std::array<uint8_t, 16> pattern{};
+        const auto& thresholds = kBayerMatrix[row % kBayerMatrix.size()];
+        for (size_t x = 0; x < thresholds.size(); ++x)
+        {
+            for (size_t c = 0; c < kBytesPerPixel; ++c)
+            {
+                if (!is_dithered(depth[c]))
+                    continue;
+
+                // The threshold is in sixteenths of a quantization step.
+                const int step = 256 >> depth[c];
+                pattern[x * kBytesPerPixel + c] =
+                    static_cast<uint8_t>(thresholds[x] * step / 16);
+            }
+        }
+        return pattern;
+    }
+
+    /// <summary>Floyd-Steinberg error diffusion of a single row.</summary>
+    void diffuse_error(const uint8_t* src,
+                       uint8_t* dst,
+                       size_t width,
+                       const std::array<int, 4>& depth,
+                       int* current,
+                       int* next)
+    {
+        for (size_t i = 0; i < width * kBytesPerPixel; ++i)
+        {
+            const auto d = depth[i % kBytesPerPixel];
+            if (!is_dithered(d))
+            {
+                dst[i] = src[i];
+                continue;
+            }
+
+            const int value = std::clamp(src[i] + current[i] / 16, 0, 0xff);
+            const int q = quantize(value, d);
+            dst[i] = static_cast<uint8_t>(q);
+
+            const int error = value - q;
+            current[i + kBytesPerPixel] += error * 7;
+            next[i - kBytesPerPixel] += error * 3;
+            next[i] += error * 5;
+            next[i + kBytesPerPixel] += error;
+        }
+    }
+}  // namespace
+
+auto rainbow::graphics::convert(Image&& image,
+                                PixelFormat format,
+                                Dithering dithering) -> Image
+{
+    if (format == PixelFormat::Default || format == PixelFormat::RGBA8888 ||
+        image.data == nullptr)
+    {
+        return std::move(image);
+    }
+
+    switch (image.format)
+    {
+        case Image::Format::PNG:
+        case Image::Format::RGBA:
+        case Image::Format::SVG:
+            if (image.channels == 4 && image.depth == 32)
+                break;
+            [[fallthrough]];
+        default:
+            return std::move(image);
+    }
+
+    const size_t width = image.width;
+    const size_t height = image.height;
+    const size_t stride = width * kBytesPerPixel;
+    const auto depth = channel_depth(format);
+
+    std::vector<uint8_t> row;
+    if (dithering != Dithering::None)
+        row.resize(stride);
+
+    // Error rows are padded by one pixel on either side.
+    std::vector<int> current_error;
+    std::vector<int> next_error;
+    if (dithering == Dithering::ErrorDiffusion)
+    {
+        current_error.resize(stride + kBytesPerPixel * 2);
+        next_error.resize(current_error.size());
+    }
+
+    const size_t size = width * height * sizeof(uint16_t);
+    auto buffer = std::make_unique<uint8_t[]>(size);  // NOLINT
+    auto out = reinterpret_cast<uint16_t*>(buffer.get());
+    for (size_t y = 0; y < height; ++y)
+    {
+        const uint8_t* src = image.data + y * stride;
+        switch (dithering)
+        {
+            case Dithering::None:
+                break;
+            case Dithering::Ordered:
+                add_saturated(
+                    src, row.data(), stride, ordered_pattern(y, depth));
+                src = row.data();
+                break;
+            case Dithering::ErrorDiffusion:
+                std::fill(next_error.begin(), next_error.end(), 0);
+                diffuse_error(src,
+                              row.data(),
+                              width,
+                              depth,
+                              current_error.data() + kBytesPerPixel,
+                              next_error.data() + kBytesPerPixel);
+                std::swap(current_error, next_error);
+                src = row.data();
+                break;
+        }
+        pack_row(src, out + y * width, width, format);
+    }
+
+    return Image{
+        image_format(format),
+        image.width,
+        image.height,
+        16,
+        format == PixelFormat::RGB565 ? 3U : 4U,
+        size,
+        buffer.release(),
+    };
+}
+
+void rainbow::graphics::pack_row(const uint8_t* src,
+                                 uint16_t* dst,
+                                 size_t width,
+                                 PixelFormat format)
+{
+    size_t x = 0;
+#if defined(USE_SSE2)
+    for (; x + 8 <= width; x += 8)
+    {
+        const auto p = src + x * kBytesPerPixel;
+        const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto hi =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + x),
+            narrow(pack_pixels(lo, format), pack_pixels(hi, format)));
+    }
+#elif defined(USE_NEON)
+    for (; x + 16 <= width; x += 16)
+    {
+        const auto p = vld4q_u8(src + x * kBytesPerPixel);
+        vst2q_u8(reinterpret_cast<uint8_t*>(dst + x), pack_pixels(p, format));
+    }
+#endif
+    for (; x < width; ++x)
+        dst[x] = pack_pixel(src + x * kBytesPerPixel, format);
+}
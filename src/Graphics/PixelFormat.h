@@ -0,0 +1,58 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_PIXELFORMAT_H_
+#define GRAPHICS_PIXELFORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rainbow
+{
+    struct Image;
+}  // namespace rainbow
+
+namespace rainbow::graphics
+{
+    /// <summary>Pixel format of textures in video memory.</summary>
+    enum class PixelFormat
+    {
+        Default,   ///< Use the texture provider's default.
+        RGBA8888,  ///< Keep the decoded format.
+        RGBA4444,
+        RGBA5551,
+        RGB565,
+    };
+
+    /// <summary>
+    ///   Dithering applied when reducing colour depth to a 16-bit format.
+    /// </summary>
+    enum class Dithering
+    {
+        None,
+        Ordered,         ///< 4x4 Bayer matrix.
+        ErrorDiffusion,  ///< Floyd-Steinberg.
+    };
+
+    /// <summary>
+    ///   Converts an 8-bit per channel RGBA image to a 16-bit pixel format.
+    /// </summary>
+    /// <remarks>
+    ///   Images that are compressed, already 16-bit, or not RGBA, are returned
+    ///   untouched. The source image is never modified, so it is safe to pass
+    ///   images that don't own their pixel data.
+    /// </remarks>
+    auto convert(Image&& image, PixelFormat format, Dithering dithering)
+        -> Image;
+
+    /// <summary>
+    ///   Packs a row of 8-bit RGBA pixels into a 16-bit pixel format.
+    /// </summary>
+    void pack_row(const uint8_t* src,
+                  uint16_t* dst,
+                  size_t width,
+                  PixelFormat format);
+}  // namespace rainbow::graphics
+
+#endif
@@ -0,0 +1,317 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/RasterCache.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Platform/Macros.h"
+#if HAS_FILESYSTEM
+#    include <filesystem>
+#else
+#    include <dirent.h>
+#    include <sys/stat.h>
+#    include <utime.h>
+#endif
+
+#include "Common/Logging.h"
+
+using rainbow::Image;
+using rainbow::MappedFile;
+using rainbow::filesystem::Path;
+using rainbow::graphics::RasterCache;
+
+namespace
+{
+    constexpr uint32_t kMagic = rainbow::make_fourcc('R', 'S', 'T', 'R');
+    constexpr uint32_t kVersion = 1;
+    constexpr char kExtension[] = ".raster";
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    constexpr auto image_size(uint32_t width, uint32_t height)
+    {
+        return static_cast<size_t>(width) * height * 4;
+    }
+
+    auto write(const Path& path, const Header& header, const Image& image)
+    {
+        auto file = std::fopen(path.string().c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        const bool success =
+            std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+            std::fwrite(image.data, image.size, 1, file) == 1;
+        return std::fclose(file) == 0 && success;
+    }
+
+    struct DiskEntry
+    {
+        std::string path;
+        uint64_t size;
+        int64_t last_used;
+    };
+
+    auto list_entries(const Path& directory)
+    {
+        std::vector<DiskEntry> entries;
+#if HAS_FILESYSTEM
+        std::error_code ec;
+        for (auto&& file :
+             std::filesystem::directory_iterator(directory.string(), ec))
+        {
+            if (file.path().extension() != kExtension ||
+                !file.is_regular_file(ec))
+            {
+                continue;
+            }
+
+            const auto size = file.file_size(ec);
+            const auto last_used = file.last_write_time(ec);
+            if (ec)
+                continue;
+
+            entries.push_back(DiskEntry{
+                file.path().string(),
+                size,
+                static_cast<int64_t>(last_used.time_since_epoch().count()),
+            });
+        }
+#else
+        auto dir = opendir(directory.c_str());
+        if (dir == nullptr)
+            return entries;
+
+        while (auto entry = readdir(dir))
+        {
+            if (!rainbow::ends_with(entry->d_name, kExtension))
+                continue;
+
+            auto path = (directory / entry->d_name).string();
+            struct stat sb;  // NOLINT(cppcoreguidelines-pro-type-member-init)
+            if (stat(path.c_str(), &sb) != 0 || !S_ISREG(sb.st_mode))
+                continue;
+
+            entries.push_back(DiskEntry{
+                std::move(path),
+                static_cast<uint64_t>(sb.st_size),
+                static_cast<int64_t>(sb.st_mtime),
+            });
+        }
+        closedir(dir);
+#endif
+        return entries;
+    }
+
+    /// <summary>Marks the file at specified path as recently used.</summary>
+    void touch(const Path& path)
+    {
+#if HAS_FILESYSTEM
+        std::error_code ec;
+        std::filesystem::last_write_time(
+            path.string(), std::filesystem::file_time_type::clock::now(), ec);
+#else
+        utime(path.c_str(), nullptr);
+#endif
+    }
+}  // namespace
+
+RasterCache::RasterCache(Path directory,
+                         size_t max_disk_size,
+                         size_t max_memory_size)
+    : directory_(std::move(directory)), max_disk_size_(max_disk_size),
+      max_memory_size_(max_memory_size)
+{
+    make_global();
+}
+
+auto RasterCache::find(const Key& key) -> Image
+{
+    auto iter = entries_.find(key);
+    if (iter == entries_.end())
+    {
+        if (directory_.empty())
+            return {};
+
+        const auto entry_path = path(key);
+        auto file = MappedFile::open(entry_path.string().c_str());
+        if (!file || file.size() < sizeof(Header))
+            return {};
+
+        Header header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != kMagic || header.version != kVersion ||
+            file.size() !=
+                sizeof(header) + image_size(header.width, header.height))
+        {
+            LOGW("RasterCache: Ignoring corrupt entry %016" PRIx64,
+                 key.hash);
+            return {};
+        }
+
+        touch(entry_path);
+        iter = entries_
+                   .emplace(key,
+                            Entry{std::move(file),
+                                  nullptr,
+                                  header.width,
+                                  header.height,
+                                  0})
+                   .first;
+        size_ += image_size(header.width, header.height);
+        trim(key);
+    }
+
+    auto& entry = iter->second;
+    entry.last_used = ++clock_;
+    return Image{
+        Image::Format::RGBA,
+        entry.width,
+        entry.height,
+        32,
+        4,
+        image_size(entry.width, entry.height),
+        entry.pixels ? entry.pixels.get() : entry.file.data() + sizeof(Header),
+    };
+}
+
+auto RasterCache::path(const Key& key) const -> Path
+{
+    uint32_t scale;
+    std::memcpy(&scale, &key.scale, sizeof(scale));
+
+    char filename[64];
+    std::snprintf(filename,
+                  sizeof(filename),
+                  "%016" PRIx64 "-%08" PRIx32 ".raster",
+                  key.hash,
+                  scale);
+    return directory_ / filename;
+}
+
+void RasterCache::prune()
+{
+    auto entries = list_entries(directory_);
+    uint64_t total = 0;
+    for (auto&& entry : entries)
+        total += entry.size;
+
+    if (total <= max_disk_size_)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](auto&& lhs, auto&& rhs) {
+        return lhs.last_used < rhs.last_used;
+    });
+
+    // Mapped files cannot be removed on all platforms. They are mapped again
+    // on the next lookup if they survive.
+    for (auto i = entries_.begin(); i != entries_.end();)
+    {
+        const auto& entry = i->second;
+        if (entry.file)
+        {
+            size_ -= image_size(entry.width, entry.height);
+            entries_.erase(i++);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    for (auto&& entry : entries)
+    {
+        if (total <= max_disk_size_)
+            break;
+
+        if (std::remove(entry.path.c_str()) != 0)
+            continue;
+
+        total -= entry.size;
+    }
+}
+
+auto RasterCache::store(const Key& key, Image&& image) -> Image
+{
+    if (image.data == nullptr || image.channels != 4 || image.depth != 32 ||
+        image.size != image_size(image.width, image.height))
+    {
+        return std::move(image);
+    }
+
+    if (!directory_.empty())
+    {
+        // Write to a temporary file first so that a crash, or another
+        // instance reading the cache, never sees a partial entry.
+        const auto destination = path(key);
+        auto temporary = destination;
+        temporary += ".tmp";
+
+        const Header header{kMagic, kVersion, image.width, image.height};
+        if (write(temporary, header, image) &&
+            std::rename(temporary.string().c_str(),
+                        destination.string().c_str()) == 0)
+        {
+            prune();
+            auto cached = find(key);
+            if (cached.data != nullptr)
+                return cached;
+        }
+        else
+        {
+            LOGW("RasterCache: Failed to write %s",
+                 destination.string().c_str());
+            std::remove(temporary.string().c_str());
+        }
+    }
+
+    // Keep the image in memory so that it is not rasterized again this run.
+    auto pixels = std::make_unique<uint8_t[]>(image.size);  // NOLINT
+    std::copy_n(image.data, image.size, pixels.get());
+    entries_.emplace(
+        key,
+        Entry{MappedFile{}, std::move(pixels), image.width, image.height, 0});
+    size_ += image.size;
+    trim(key);
+    return find(key);
+}
+
+void RasterCache::trim(const Key& key)
+{
+    if (size_ <= max_memory_size_)
+        return;
+
+    std::vector<std::pair<uint64_t, Key>> entries;
+    for (auto&& [k, entry] : entries_)
+    {
+        if (!(k == key))
+            entries.emplace_back(entry.last_used, k);
+    }
+
+    std::sort(entries.begin(), entries.end(), [](auto&& lhs, auto&& rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    for (auto&& [last_used, k] : entries)
+    {
+        if (size_ <= max_memory_size_)
+            break;
+
+        auto i = entries_.find(k);
+        size_ -= image_size(i->second.width, i->second.height);
+        entries_.erase(i);
+    }
+}
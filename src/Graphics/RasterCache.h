@@ -0,0 +1,147 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_RASTERCACHE_H_
+#define GRAPHICS_RASTERCACHE_H_
+
+#include <memory>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "Common/Algorithm.h"
+#include "Common/Data.h"
+#include "Common/Global.h"
+#include "FileSystem/MappedFile.h"
+#include "FileSystem/Path.h"
+#include "Graphics/Image.h"
+
+namespace rainbow::graphics
+{
+    /// <summary>
+    ///   Caches rasterized vector images in memory, and on disk across runs.
+    /// </summary>
+    /// <remarks>
+    ///   Entries are keyed on a hash of the source data and the scale it was
+    ///   rasterized at. Cached images are memory-mapped from disk, or kept in
+    ///   memory if they could not be written. Both are released, least
+    ///   recently used first, to stay within their size limits. An image
+    ///   returned by <see cref="get"/> is therefore only valid until the next
+    ///   call, and should be uploaded before then.
+    /// </remarks>
+    class RasterCache : public Global<RasterCache>
+    {
+    public:
+        /// <summary>Default size limit of images on disk.</summary>
+        static constexpr size_t kMaxDiskSize = 64 * 1024 * 1024;
+
+        /// <summary>
+        ///   Default size limit of images mapped or kept in memory.
+        /// </summary>
+        static constexpr size_t kMaxMemorySize = 16 * 1024 * 1024;
+
+        /// <param name="directory">
+        ///   Directory to store rasterized images in. Images are only cached
+        ///   in memory if empty.
+        /// </param>
+        /// <param name="max_disk_size">
+        ///   Maximum number of bytes to keep in <paramref name="directory"/>.
+        /// </param>
+        /// <param name="max_memory_size">
+        ///   Maximum number of bytes of images to keep mapped or in memory.
+        /// </param>
+        explicit RasterCache(filesystem::Path directory,
+                             size_t max_disk_size = kMaxDiskSize,
+                             size_t max_memory_size = kMaxMemorySize);
+
+        /// <summary>
+        ///   Returns the image of <paramref name="source"/> rasterized at
+        ///   <paramref name="scale"/>. <paramref name="rasterize"/> is only
+        ///   called if there is no such image in the cache.
+        /// </summary>
+        template <typename F>
+        auto get(const Data& source, float scale, F&& rasterize) -> Image
+        {
+            const Key key{fnv1a(source.bytes(), source.size()), scale};
+            auto image = find(key);
+            return image.data != nullptr ? std::move(image)
+                                         : store(key, rasterize());
+        }
+
+        /// <summary>
+        ///   Unmaps and frees all cached images. Images returned previously
+        ///   are no longer valid.
+        /// </summary>
+        void clear()
+        {
+            entries_.clear();
+            size_ = 0;
+        }
+
+#ifdef RAINBOW_TEST
+        /// <summary>
+        ///   Returns the number of bytes of images mapped or kept in memory.
+        /// </summary>
+        [[nodiscard]] auto size() const { return size_; }
+#endif
+
+    private:
+        struct Key
+        {
+            uint64_t hash;
+            float scale;
+
+            template <typename H>
+            friend auto AbslHashValue(H hash_state, const Key& k) -> H
+            {
+                return H::combine(std::move(hash_state), k.hash, k.scale);
+            }
+
+            friend auto operator==(const Key& lhs, const Key& rhs) -> bool
+            {
+                return lhs.hash == rhs.hash && lhs.scale == rhs.scale;
+            }
+        };
+
+        struct Entry
+        {
+            /// <summary>Mapped file, prefixed with a header.</summary>
+            MappedFile file;
+
+            /// <summary>Pixels, if the image is only kept in memory.</summary>
+            std::unique_ptr<uint8_t[]> pixels;
+
+            uint32_t width;
+            uint32_t height;
+            uint64_t last_used;
+        };
+
+        filesystem::Path directory_;
+        size_t max_disk_size_;
+        size_t max_memory_size_;
+        size_t size_ = 0;
+        uint64_t clock_ = 0;
+        absl::flat_hash_map<Key, Entry> entries_;
+
+        auto find(const Key&) -> Image;
+        auto path(const Key&) const -> filesystem::Path;
+
+        /// <summary>
+        ///   Removes least recently used images from disk until the cache is
+        ///   within its size limit. Mapped images are unmapped first so that
+        ///   they can be removed.
+        /// </summary>
+        void prune();
+
+        auto store(const Key&, Image&&) -> Image;
+
+        /// <summary>
+        ///   Releases least recently used images, except the one at
+        ///   <paramref name="key"/>, until the cache is within its memory
+        ///   limit.
+        /// </summary>
+        void trim(const Key& key);
+    };
+}  // namespace rainbow::graphics
+
+#endif
@@ -8,11 +8,13 @@
 #include "Graphics/Drawable.h"
 #include "Graphics/Label.h"
 #include "Graphics/SpriteBatch.h"
+#include "Script/GameBase.h"
 
 using rainbow::Animation;
 using rainbow::GameBase;
 using rainbow::IDrawable;
 using rainbow::Label;
+using rainbow::LayoutRequest;
 using rainbow::SpriteBatch;
 using rainbow::graphics::Context;
 using rainbow::graphics::RenderQueue;
@@ -60,5 +62,22 @@ void rainbow::graphics::draw(Context& ctx, RenderQueue& queue)
 
 void rainbow::graphics::update(GameBase& ctx, RenderQueue& queue, uint64_t dt)
 {
+    // Shape the text of all stale labels up front, so that it can be done in
+    // parallel. Labels pick up the results when they are laid out below.
+    std::vector<LayoutRequest> layouts;
+    for (auto&& unit : queue)
+    {
+        auto label = rainbow::get<Label*>(unit.object());
+        if (!unit.is_enabled() || !label || !(*label)->needs_layout())
+            continue;
+
+        layouts.push_back({(*label)->text(),
+                           (*label)->text_attributes(),
+                           (*label)->previous_text()});
+    }
+
+    if (!layouts.empty())
+        ctx.typesetter().prepare(layouts);
+
     visit_all(UpdateCommand{ctx, dt}, queue);
 }
@@ -0,0 +1,337 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/Resample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define USE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define USE_NEON 1
+#endif
+
+#include "Common/Constants.h"
+#include "Common/Logging.h"
+#include "Graphics/Image.h"
+#include "Graphics/Texture.h"
+
+using rainbow::Image;
+using rainbow::graphics::Filter;
+
+namespace
+{
+    /// <summary>Number of fractional bits in filter weights.</summary>
+    constexpr int kPrecision = 14;
+    constexpr int kRounding = 1 << (kPrecision - 1);
+
+    constexpr float kLanczosSupport = 3.0F;
+
+    /// <summary>
+    ///   Source range and fixed-point weights for each destination pixel.
+    /// </summary>
+    struct Coefficients
+    {
+        std::vector<uint32_t> start;
+        std::vector<uint32_t> count;
+        std::vector<int16_t> weights;
+        size_t taps = 0;
+
+        [[nodiscard]] auto kernel(size_t i) const
+        {
+            return weights.data() + i * taps;
+        }
+    };
+
+    auto sinc(float x) -> float
+    {
+        if (x == 0.0F)
+            return 1.0F;
+
+        x *= rainbow::kPi<float>;
+        return std::sin(x) / x;
+    }
+
+    auto weight(Filter filter, float x) -> float
+    {
+        switch (filter)
+        {
+            case Filter::Cubic:
+                return x > -kLanczosSupport && x < kLanczosSupport
+                           ? sinc(x) * sinc(x / kLanczosSupport)
+                           : 0.0F;
+            default:
+                return x >= -0.5F && x < 0.5F ? 1.0F : 0.0F;
+        }
+    }
+
+    auto coefficients(uint32_t in_size, uint32_t out_size, Filter filter)
+        -> Coefficients
+    {
+        const float scale = static_cast<float>(in_size) / out_size;
+        const float filter_scale = std::max(scale, 1.0F);
+        const float support =
+            (filter == Filter::Cubic ? kLanczosSupport : 0.5F) * filter_scale;
+
+        Coefficients c;
+        c.taps = filter == Filter::Nearest
+                     ? 1
+                     : static_cast<size_t>(std::ceil(support)) * 2 + 1;
+        c.start.resize(out_size);
+        c.count.resize(out_size);
+        c.weights.resize(out_size * c.taps);
+
+        std::vector<float> w(c.taps);
+        for (uint32_t x = 0; x < out_size; ++x)
+        {
+            const float center = (x + 0.5F) * scale;
+            if (filter == Filter::Nearest)
+            {
+                c.start[x] =
+                    std::min(static_cast<uint32_t>(center), in_size - 1);
+                c.count[x] = 1;
+                c.weights[x] = 1 << kPrecision;
+                continue;
+            }
+
+            const auto first =
+                std::max(static_cast<int>(center - support + 0.5F), 0);
+            const auto last = std::min(
+                static_cast<int>(center + support + 0.5F),
+                static_cast<int>(in_size));
+            const auto count =
+                std::min(static_cast<size_t>(last - first), c.taps);
+
+            float total = 0.0F;
+            for (size_t i = 0; i < count; ++i)
+            {
+                w[i] = weight(filter,  //
+                              (first + i - center + 0.5F) / filter_scale);
+                total += w[i];
+            }
+
+            // Weights must sum up to exactly one, or flat areas will shift
+            // after rounding. Any remainder goes to the largest weight.
+            auto kernel = c.weights.data() + x * c.taps;
+            int sum = 0;
+            size_t largest = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                kernel[i] = static_cast<int16_t>(
+                    std::lround(w[i] / total * (1 << kPrecision)));
+                sum += kernel[i];
+                if (kernel[i] > kernel[largest])
+                    largest = i;
+            }
+            kernel[largest] =
+                static_cast<int16_t>(kernel[largest] + (1 << kPrecision) - sum);
+
+            c.start[x] = static_cast<uint32_t>(first);
+            c.count[x] = static_cast<uint32_t>(count);
+        }
+
+        return c;
+    }
+
+    auto clamp_pixel(int value) -> uint8_t
+    {
+        return static_cast<uint8_t>(std::clamp(value >> kPrecision, 0, 255));
+    }
+
+    void resample_horizontal(const uint8_t* src,
+                             uint32_t src_width,
+                             uint8_t* dst,
+                             uint32_t dst_width,
+                             uint32_t height,
+                             uint32_t channels,
+                             const Coefficients& c)
+    {
+        const size_t src_stride = static_cast<size_t>(src_width) * channels;
+        const size_t dst_stride = static_cast<size_t>(dst_width) * channels;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const uint8_t* in = src + y * src_stride;
+            uint8_t* out = dst + y * dst_stride;
+            for (uint32_t x = 0; x < dst_width; ++x)
+            {
+                const uint8_t* p = in + c.start[x] * channels;
+                const int16_t* kernel = c.kernel(x);
+                const uint32_t count = c.count[x];
+                for (uint32_t ch = 0; ch < channels; ++ch)
+                {
+                    int sum = kRounding;
+                    for (uint32_t i = 0; i < count; ++i)
+                        sum += p[i * channels + ch] * kernel[i];
+                    out[x * channels + ch] = clamp_pixel(sum);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    ///   Computes a single destination row as the weighted sum of source rows.
+    ///   The operation is independent of the number of channels.
+    /// </summary>
+    void resample_row(const uint8_t* src,
+                      size_t stride,
+                      const int16_t* kernel,
+                      uint32_t count,
+                      uint8_t* dst)
+    {
+        size_t x = 0;
+#if defined(USE_SSE2)
+        const auto zero = _mm_setzero_si128();
+        for (; x + 8 <= stride; x += 8)
+        {
+            auto lo = _mm_set1_epi32(kRounding);
+            auto hi = lo;
+            uint32_t i = 0;
+
+            // Interleave two rows at a time so that one multiply-add covers
+            // both taps.
+            for (; i + 2 <= count; i += 2)
+            {
+                const auto a = _mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(src + i * stride + x));
+                const auto b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+                    src + (i + 1) * stride + x));
+                const auto ab = _mm_unpacklo_epi8(a, b);
+                const auto w = _mm_set1_epi32(static_cast<int>(
+                    static_cast<uint16_t>(kernel[i + 1]) << 16 |
+                    static_cast<uint16_t>(kernel[i])));
+                lo = _mm_add_epi32(
+                    lo, _mm_madd_epi16(_mm_unpacklo_epi8(ab, zero), w));
+                hi = _mm_add_epi32(
+                    hi, _mm_madd_epi16(_mm_unpackhi_epi8(ab, zero), w));
+            }
+
+            if (i < count)
+            {
+                const auto a = _mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(src + i * stride + x));
+                const auto a0 = _mm_unpacklo_epi8(a, zero);
+                const auto w =
+                    _mm_set1_epi32(static_cast<uint16_t>(kernel[i]));
+                lo = _mm_add_epi32(
+                    lo, _mm_madd_epi16(_mm_unpacklo_epi8(a0, zero), w));
+                hi = _mm_add_epi32(
+                    hi, _mm_madd_epi16(_mm_unpackhi_epi8(a0, zero), w));
+            }
+
+            lo = _mm_srai_epi32(lo, kPrecision);
+            hi = _mm_srai_epi32(hi, kPrecision);
+            const auto packed = _mm_packs_epi32(lo, hi);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x),
+                             _mm_packus_epi16(packed, packed));
+        }
+#elif defined(USE_NEON)
+        for (; x + 8 <= stride; x += 8)
+        {
+            auto lo = vdupq_n_s32(kRounding);
+            auto hi = lo;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const auto p = vreinterpretq_s16_u16(
+                    vmovl_u8(vld1_u8(src + i * stride + x)));
+                lo = vmlal_n_s16(lo, vget_low_s16(p), kernel[i]);
+                hi = vmlal_n_s16(hi, vget_high_s16(p), kernel[i]);
+            }
+
+            const auto packed = vcombine_u16(vqshrun_n_s32(lo, kPrecision),
+                                             vqshrun_n_s32(hi, kPrecision));
+            vst1_u8(dst + x, vqmovn_u16(packed));
+        }
+#endif
+        for (; x < stride; ++x)
+        {
+            int sum = kRounding;
+            for (uint32_t i = 0; i < count; ++i)
+                sum += src[i * stride + x] * kernel[i];
+            dst[x] = clamp_pixel(sum);
+        }
+    }
+
+    void resample_vertical(const uint8_t* src,
+                           uint8_t* dst,
+                           size_t stride,
+                           uint32_t dst_height,
+                           const Coefficients& c)
+    {
+        for (uint32_t y = 0; y < dst_height; ++y)
+        {
+            resample_row(src + c.start[y] * stride,
+                         stride,
+                         c.kernel(y),
+                         c.count[y],
+                         dst + y * stride);
+        }
+    }
+}  // namespace
+
+auto rainbow::graphics::resample(const Image& image,
+                                 uint32_t width,
+                                 uint32_t height,
+                                 Filter filter) -> Image
+{
+    R_ASSERT(image.format == Image::Format::PNG ||
+                 image.format == Image::Format::RGBA ||
+                 image.format == Image::Format::SVG,
+             "Only uncompressed images can be resampled");
+    R_ASSERT(image.depth == image.channels * 8,
+             "Only 8-bit per channel images can be resampled");
+    R_ASSERT(width > 0 && height > 0, "Invalid image dimensions");
+
+    const uint32_t channels = image.channels;
+    const size_t stride = static_cast<size_t>(width) * channels;
+
+    // Resample horizontally first so that the vertical pass, which is the
+    // vectorized one, operates on as few pixels as possible.
+    std::unique_ptr<uint8_t[]> scratch;  // NOLINT
+    const uint8_t* rows = image.data;
+    if (width != image.width)
+    {
+        scratch = std::make_unique<uint8_t[]>(stride * image.height);  // NOLINT
+        resample_horizontal(image.data,
+                            image.width,
+                            scratch.get(),
+                            width,
+                            image.height,
+                            channels,
+                            coefficients(image.width, width, filter));
+        rows = scratch.get();
+    }
+
+    const size_t size = stride * height;
+    auto buffer = std::make_unique<uint8_t[]>(size);  // NOLINT
+    if (height != image.height)
+    {
+        resample_vertical(rows,
+                          buffer.get(),
+                          stride,
+                          height,
+                          coefficients(image.height, height, filter));
+    }
+    else
+    {
+        std::copy_n(rows, size, buffer.get());
+    }
+
+    // The resampled image owns its pixels, unlike RGBA images.
+    return Image{
+        image.format == Image::Format::RGBA ? Image::Format::PNG
+                                            : image.format,
+        width,
+        height,
+        image.depth,
+        channels,
+        size,
+        buffer.release(),
+    };
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_RESAMPLE_H_
+#define GRAPHICS_RESAMPLE_H_
+
+#include <cstdint>
+
+namespace rainbow
+{
+    struct Image;
+}  // namespace rainbow
+
+namespace rainbow::graphics
+{
+    enum class Filter;
+
+    /// <summary>
+    ///   Resamples an uncompressed, 8-bit per channel image to the specified
+    ///   dimensions.
+    /// </summary>
+    /// <remarks>
+    ///   <list type="bullet">
+    ///     <item><c>Filter::Nearest</c> picks the nearest pixel.</item>
+    ///     <item>
+    ///       <c>Filter::Linear</c> and <c>Filter::Trilinear</c> average the
+    ///       covered pixels (box filter).
+    ///     </item>
+    ///     <item><c>Filter::Cubic</c> uses a 3-lobed Lanczos filter.</item>
+    ///   </list>
+    ///   <c>Format::RGBA</c> images are returned as <c>Format::PNG</c> since
+    ///   the resampled image owns its pixels.
+    /// </remarks>
+    auto resample(const Image& image,
+                  uint32_t width,
+                  uint32_t height,
+                  Filter filter) -> Image;
+}  // namespace rainbow::graphics
+
+#endif
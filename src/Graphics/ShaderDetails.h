@@ -39,7 +39,7 @@ namespace Shader
         bool texture0;
         bool texture1;
         const unsigned int program;
-        const int mvp_matrix;
+        int mvp_matrix;  // May change when the program is relinked
 
         Details(unsigned int program, int mvp_matrix)
             : texture0(true), texture1(false), program(program),
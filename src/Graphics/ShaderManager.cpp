@@ -4,6 +4,7 @@
 
 #include "Graphics/ShaderManager.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "Common/Data.h"
@@ -143,6 +144,25 @@ bool ShaderManager::init()
 
     R_ASSERT(pid != kInvalidProgram, "Failed to compile default shader");
 
+    Shader::Params text[]{
+        {Shader::kTypeVertex, 0, nullptr, nullptr},  // kFixed2Dv
+        gl::Text_frag()};
+    [[maybe_unused]] const auto text_pid = compile(text, nullptr);
+
+    R_ASSERT(text_pid == kTextProgram, "Failed to compile text shader");
+
+    Shader::Params distance_field[]{
+        {Shader::kTypeVertex, 0, nullptr, nullptr},  // kFixed2Dv
+        gl::DistanceField_frag()};
+    [[maybe_unused]] const auto distance_field_pid =
+        compile(distance_field, nullptr);
+
+    R_ASSERT(distance_field_pid == kDistanceFieldProgram,
+             "Failed to compile distance field shader");
+
+    distance_field_smoothing_ = glGetUniformLocation(
+        get_program(kDistanceFieldProgram).program, "smoothing");
+
     make_global();
     return true;
 }
@@ -168,6 +188,7 @@ auto ShaderManager::compile(ArraySpan<Shader::Params> shaders,
 
         shaders_.push_back(id);
         shader.id = id;
+        IF_DEVMODE(sources_.push_back({id, shader.source}));
     }
     if (attributes == nullptr)
     {
@@ -184,6 +205,85 @@ auto ShaderManager::compile(ArraySpan<Shader::Params> shaders,
     return static_cast<unsigned int>(programs_.size());
 }
 
+#ifdef USE_HEIMDALL
+auto ShaderManager::reload(std::string_view path) -> bool
+{
+    auto source = std::find_if(
+        std::begin(sources_), std::end(sources_), [path](auto&& source) {
+            return source.path == path;
+        });
+    if (source == std::end(sources_))
+        return false;
+
+    const auto glsl = File::read(source->path.c_str(), FileType::Asset);
+    if (!glsl)
+    {
+        LOGE("Failed to load shader: %s", source->path.c_str());
+        return true;
+    }
+
+    const auto id = source->id;
+    shader_source(id, glsl.as<char*>());
+    glCompileShader(id);
+
+    auto error =
+        verify(id, GL_COMPILE_STATUS, glGetShaderiv, glGetShaderInfoLog);
+    if (!error.empty())
+    {
+        LOGE("GLSL: Failed to compile %s: %s",
+             source->path.c_str(),
+             error.c_str());
+        return true;
+    }
+
+    const auto current = current_;
+    for (size_t i = 0; i < programs_.size(); ++i)
+    {
+        auto& details = programs_[i];
+
+        GLuint attached[4]{};  // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        GLsizei count = 0;
+        glGetAttachedShaders(
+            details.program, std::size(attached), &count, attached);
+        if (std::find(attached, attached + count, id) == attached + count)
+            continue;
+
+        // Attribute bindings are kept, but uniforms are reset on relinking.
+        glLinkProgram(details.program);
+        error = verify(details.program,
+                       GL_LINK_STATUS,
+                       glGetProgramiv,
+                       glGetProgramInfoLog);
+        if (!error.empty())
+        {
+            LOGE("GLSL: Failed to link program: %s", error.c_str());
+            continue;
+        }
+
+        details.mvp_matrix =
+            glGetUniformLocation(details.program, "mvp_matrix");
+        if (i + 1 == kDistanceFieldProgram)
+        {
+            distance_field_smoothing_ =
+                glGetUniformLocation(details.program, "smoothing");
+        }
+
+        current_ = static_cast<unsigned int>(i + 1);
+        glUseProgram(details.program);
+        glUniform1i(glGetUniformLocation(details.program, "texture"), 0);
+        if (details.mvp_matrix >= 0)
+            update_projection();
+    }
+
+    current_ = current;
+    if (current_ != kInvalidProgram)
+        glUseProgram(get_program().program);
+
+    LOGI("Reloaded shader: %s", source->path.c_str());
+    return true;
+}
+#endif  // USE_HEIMDALL
+
 void ShaderManager::update_projection()
 {
     R_ASSERT(
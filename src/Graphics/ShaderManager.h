@@ -5,6 +5,8 @@
 #ifndef GRAPHICS_SHADERMANAGER_H_
 #define GRAPHICS_SHADERMANAGER_H_
 
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "Common/Global.h"
@@ -30,7 +32,9 @@ namespace rainbow::graphics
         enum
         {
             kInvalidProgram,
-            kDefaultProgram
+            kDefaultProgram,
+            kTextProgram,
+            kDistanceFieldProgram
         };
 
         /// <summary>
@@ -76,6 +80,15 @@ namespace rainbow::graphics
         auto compile(ArraySpan<Shader::Params> shaders,
                      const Shader::AttributeParams* attributes) -> unsigned int;
 
+        /// <summary>
+        ///   Returns the location of the <c>smoothing</c> uniform in
+        ///   <c>kDistanceFieldProgram</c>.
+        /// </summary>
+        auto distance_field_smoothing() const
+        {
+            return distance_field_smoothing_;
+        }
+
         /// <summary>Returns current program details.</summary>
         auto get_program() const -> const Shader::Details&
         {
@@ -105,6 +118,17 @@ namespace rainbow::graphics
             return Context(*this, program);
         }
 
+#ifdef USE_HEIMDALL
+        /// <summary>
+        ///   Recompiles the shader at specified path, and relinks all programs
+        ///   using it. Programs are left untouched if compilation fails.
+        /// </summary>
+        /// <returns>
+        ///   Whether a shader compiled from specified path was found.
+        /// </returns>
+        auto reload(std::string_view path) -> bool;
+#endif  // USE_HEIMDALL
+
         ShaderManager(const ISolemnlySwearThatIAmOnlyTesting&)
         {
             make_global();
@@ -113,8 +137,19 @@ namespace rainbow::graphics
     private:
         unsigned int current_ = kInvalidProgram;  ///< Currently used program.
         graphics::Context* context_ = nullptr;
+        int distance_field_smoothing_ = -1;  ///< May change on relinking.
         std::vector<Shader::Details> programs_;  ///< Linked shader programs.
         std::vector<unsigned int> shaders_;      ///< Compiled shaders.
+
+#ifdef USE_HEIMDALL
+        struct ShaderSource
+        {
+            unsigned int id;
+            std::string path;
+        };
+
+        std::vector<ShaderSource> sources_;  ///< Shaders compiled from file.
+#endif  // USE_HEIMDALL
     };
 }  // namespace rainbow::graphics
 
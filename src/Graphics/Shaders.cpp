@@ -58,6 +58,18 @@ namespace
                          "* attenuation;\n"
         "}\n";
 
+    constexpr char kDistanceField_frag[] =
+        "uniform sampler2D texture;\n"
+        "uniform float smoothing;\n"
+        "varying lowp vec4 v_color;\n"
+        "varying vec2 v_texcoord;\n"
+        "void main()\n"
+        "{\n"
+            "float distance = texture2D(texture, v_texcoord).r;\n"
+            "float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);\n"
+            "gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);\n"
+        "}\n";
+
     constexpr char kFixed2D_frag[] =
         "uniform sampler2D texture;\n"
         "varying lowp vec4 v_color;\n"
@@ -127,6 +139,16 @@ namespace
             "v_color = color;\n"
             "gl_Position = mvp_matrix * vec4(vertex, 0.0, 1.0);\n"
         "}\n";
+
+    constexpr char kText_frag[] =
+        "uniform sampler2D texture;\n"
+        "varying lowp vec4 v_color;\n"
+        "varying vec2 v_texcoord;\n"
+        "void main()\n"
+        "{\n"
+            "lowp float coverage = texture2D(texture, v_texcoord).r;\n"
+            "gl_FragColor = vec4(v_color.rgb, v_color.a * coverage);\n"
+        "}\n";
 }  // namespace
 
 auto gl::DiffuseLight2D_frag() -> Shader::Params
@@ -139,6 +161,11 @@ auto gl::DiffuseLightNormal_frag() -> Shader::Params
     return {Shader::kTypeFragment, 0, "Shaders/DiffuseLightNormal.frag", kDiffuseLightNormal_frag};
 }
 
+auto gl::DistanceField_frag() -> Shader::Params
+{
+    return {Shader::kTypeFragment, 0, "Shaders/DistanceField.frag", kDistanceField_frag};
+}
+
 auto gl::Fixed2D_frag() -> Shader::Params
 {
     return {Shader::kTypeFragment, 0, "Shaders/Fixed2D.frag", kFixed2D_frag};
@@ -174,4 +201,9 @@ auto gl::Simple2D_vert() -> Shader::Params
     return {Shader::kTypeVertex, 0, "Shaders/Simple2D.vert", kSimple2D_vert};
 }
 
+auto gl::Text_frag() -> Shader::Params
+{
+    return {Shader::kTypeFragment, 0, "Shaders/Text.frag", kText_frag};
+}
+
 // clang-format on
@@ -5,20 +5,60 @@
 #include "Graphics/Texture.h"
 
 #include "Common/Logging.h"
+#include "FileSystem/AssetCache.h"
 #include "FileSystem/File.h"
 #include "Graphics/Image.h"
 
+using rainbow::AssetCache;
 using rainbow::Data;
 using rainbow::File;
 using rainbow::FileType;
 using rainbow::Image;
 using rainbow::Passkey;
+using rainbow::graphics::Dithering;
 using rainbow::graphics::Filter;
 using rainbow::graphics::ITextureAllocator;
+using rainbow::graphics::PixelFormat;
 using rainbow::graphics::Texture;
 using rainbow::graphics::TextureData;
 using rainbow::graphics::TextureProvider;
 
+namespace
+{
+    /// <summary>
+    ///   Decoded image, and the file it was decoded from if the image still
+    ///   points into it.
+    /// </summary>
+    struct DecodedImage
+    {
+        AssetCache::Handle<Data> source;
+        Image image;
+    };
+
+    auto decode(std::string_view path,
+                float scale,
+                Filter min_filter,
+                PixelFormat format,
+                Dithering dithering) -> DecodedImage
+    {
+        // Textures are shared by path in the provider. Only the file goes
+        // through the cache; decoded pixels are dropped once uploaded.
+        auto cache = AssetCache::Get();
+        auto file = cache == nullptr
+                        ? std::make_shared<const Data>(
+                              File::map(path.data(), FileType::Asset))
+                        : cache->load(path.data(), FileType::Asset);
+        if (file == nullptr)
+            file = std::make_shared<const Data>();
+
+        auto image = convert(
+            Image::decode(*file, scale, min_filter), format, dithering);
+        const bool is_borrowed = image.data >= file->bytes() &&
+                                 image.data < file->bytes() + file->size();
+        return {is_borrowed ? std::move(file) : nullptr, std::move(image)};
+    }
+}  // namespace
+
 TextureProvider::TextureProvider(ITextureAllocator& allocator)
     : allocator_(allocator)
 {
@@ -43,19 +83,37 @@ auto TextureProvider::get(std::string_view path,
                           [[maybe_unused]] T data,
                           [[maybe_unused]] float scale,
                           Filter mag_filter,
-                          Filter min_filter) -> Texture
+                          Filter min_filter,
+                          [[maybe_unused]] PixelFormat pixel_format) -> Texture
 {
     auto [iter, inserted] = texture_map_.emplace(path, TextureData{});
     if (inserted)
     {
+        [[maybe_unused]] auto format =
+            pixel_format == PixelFormat::Default ? pixel_format_
+                                                 : pixel_format;
         if constexpr (std::is_same_v<T, std::nullptr_t>)
         {
-            auto file = File::read(path.data(), FileType::Asset);
-            load(iter, Image::decode(file, scale), mag_filter, min_filter);
+            const auto decoded =
+                decode(path, scale, min_filter, format, dithering_);
+            load(iter, decoded.image, mag_filter, min_filter);
+
+#ifdef USE_HEIMDALL
+            auto& texture = iter->second;
+            texture.scale = scale;
+            texture.mag_filter = mag_filter;
+            texture.min_filter = min_filter;
+            texture.pixel_format = format;
+#endif
         }
         else if constexpr (std::is_same_v<T, const Data&>)
         {
-            load(iter, Image::decode(data, scale), mag_filter, min_filter);
+            load(iter,
+                 convert(Image::decode(data, scale, min_filter),
+                         format,
+                         dithering_),
+                 mag_filter,
+                 min_filter);
         }
         else if constexpr (std::is_same_v<T, const Image&>)
         {
@@ -69,18 +127,21 @@ auto TextureProvider::get(std::string_view path,
 auto TextureProvider::get(std::string_view path,
                           float scale,
                           Filter mag_filter,
-                          Filter min_filter) -> Texture
+                          Filter min_filter,
+                          PixelFormat pixel_format) -> Texture
 {
-    return get(path, nullptr, scale, mag_filter, min_filter);
+    return get(path, nullptr, scale, mag_filter, min_filter, pixel_format);
 }
 
 auto TextureProvider::get(std::string_view path,
                           const Data& data,
                           float scale,
                           Filter mag_filter,
-                          Filter min_filter) -> Texture
+                          Filter min_filter,
+                          PixelFormat pixel_format) -> Texture
 {
-    return get<const Data&>(path, data, scale, mag_filter, min_filter);
+    return get<const Data&>(
+        path, data, scale, mag_filter, min_filter, pixel_format);
 }
 
 auto TextureProvider::get(std::string_view path,
@@ -88,7 +149,8 @@ auto TextureProvider::get(std::string_view path,
                           Filter mag_filter,
                           Filter min_filter) -> Texture
 {
-    return get<const Image&>(path, image, 1.0F, mag_filter, min_filter);
+    return get<const Image&>(
+        path, image, 1.0F, mag_filter, min_filter, PixelFormat::RGBA8888);
 }
 
 auto TextureProvider::raw_get(const Texture& texture) const -> TextureData
@@ -123,6 +185,38 @@ auto TextureProvider::try_get(const Texture& texture)
     return std::make_optional(iter->second);
 }
 
+#ifdef USE_HEIMDALL
+auto TextureProvider::reload(std::string_view path) -> bool
+{
+    auto iter = texture_map_.find(path);
+    if (iter == texture_map_.end() || iter->second.scale <= 0.0F)
+        return false;
+
+    auto& texture = iter->second;
+    const auto decoded = decode(iter->first,
+                                texture.scale,
+                                texture.min_filter,
+                                texture.pixel_format,
+                                dithering_);
+    const auto& image = decoded.image;
+    if (image.data == nullptr)
+    {
+        LOGE("Failed to reload texture: %s", iter->first.c_str());
+        return true;
+    }
+
+    allocator_.update(
+        texture.data, image, texture.mag_filter, texture.min_filter);
+    texture.width = image.width;
+    texture.height = image.height;
+
+    mem_used_ -= texture.size;
+    texture.size = image.size;
+    record_usage(image.size);
+    return true;
+}
+#endif  // USE_HEIMDALL
+
 void TextureProvider::update(const Texture& texture,
                              const Image& image,
                              Filter mag_filter,
@@ -131,6 +225,14 @@ void TextureProvider::update(const Texture& texture,
     allocator_.update(raw_get(texture).data, image, mag_filter, min_filter);
 }
 
+void TextureProvider::update_region(const Texture& texture,
+                                    const Image& image,
+                                    uint32_t x,
+                                    uint32_t y)
+{
+    allocator_.update_region(raw_get(texture).data, image, x, y);
+}
+
 void TextureProvider::load(TextureMap::iterator i,
                            const Image& image,
                            Filter mag_filter,
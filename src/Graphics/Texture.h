@@ -9,8 +9,10 @@
 #include <optional>
 #include <string>
 
+#include "Common/Logging.h"
 #include "Common/NonCopyable.h"
 #include "Common/Passkey.h"
+#include "Graphics/PixelFormat.h"
 #include "Memory/ArrayMap.h"
 
 namespace rainbow
@@ -33,6 +35,8 @@ namespace rainbow::graphics
         Nearest,
         Linear,
         Cubic,
+        Trilinear,  ///< Linear with mipmaps; falls back to linear if the
+                    ///< texture cannot be mipmapped.
     };
 
     struct TextureData
@@ -43,9 +47,23 @@ namespace rainbow::graphics
         uint32_t use_count = 0;
 #ifdef USE_HEIMDALL
         uint32_t size = 0;
+
+        // Parameters the texture was decoded with. Only textures loaded from
+        // file, i.e. with a non-zero scale, can be reloaded.
+        float scale = 0.0F;
+        Filter mag_filter = Filter::Cubic;
+        Filter min_filter = Filter::Linear;
+        PixelFormat pixel_format = PixelFormat::Default;
 #endif
     };
 
+    /// <summary>Loads and keeps track of textures.</summary>
+    /// <remarks>
+    ///   When loading from file or data, <c>scale</c> is the scale the image
+    ///   is decoded at. SVGs are rasterized at this scale while PNGs are
+    ///   downscaled (if <c>scale</c> &lt; 1) using a filter matching
+    ///   <c>min_filter</c>.
+    /// </remarks>
     class TextureProvider : private NonCopyable<TextureProvider>
     {
     public:
@@ -56,14 +74,16 @@ namespace rainbow::graphics
         auto get(std::string_view path,
                  float scale = 1.0F,
                  Filter mag_filter = Filter::Cubic,
-                 Filter min_filter = Filter::Linear) -> Texture;
+                 Filter min_filter = Filter::Linear,
+                 PixelFormat pixel_format = PixelFormat::Default) -> Texture;
 
         [[nodiscard]]
         auto get(std::string_view path,
                  const Data&,
                  float scale = 1.0F,
                  Filter mag_filter = Filter::Cubic,
-                 Filter min_filter = Filter::Linear) -> Texture;
+                 Filter min_filter = Filter::Linear,
+                 PixelFormat pixel_format = PixelFormat::Default) -> Texture;
 
         [[nodiscard]]
         auto get(std::string_view path,
@@ -76,6 +96,19 @@ namespace rainbow::graphics
 
         void release(const Texture&);
 
+        /// <summary>
+        ///   Sets the pixel format that decoded textures are converted to when
+        ///   none is specified on load.
+        /// </summary>
+        void set_pixel_format(PixelFormat format, Dithering dithering)
+        {
+            R_ASSERT(format != PixelFormat::Default,
+                     "Default pixel format must be a concrete format");
+
+            pixel_format_ = format;
+            dithering_ = dithering;
+        }
+
         [[nodiscard]]
         auto try_get(const Texture&) -> std::optional<TextureData>;
 
@@ -84,18 +117,31 @@ namespace rainbow::graphics
                     Filter mag_filter = Filter::Cubic,
                     Filter min_filter = Filter::Linear);
 
+        /// <summary>
+        ///   Replaces the region of <paramref name="texture"/> at
+        ///   (<paramref name="x"/>, <paramref name="y"/>) with
+        ///   <paramref name="image"/>.
+        /// </summary>
+        void update_region(const Texture& texture,
+                           const Image& image,
+                           uint32_t x,
+                           uint32_t y);
+
     private:
         using TextureMap = ArrayMap<std::string, TextureData>;
 
         TextureMap texture_map_;
         ITextureAllocator& allocator_;
+        PixelFormat pixel_format_ = PixelFormat::RGBA8888;
+        Dithering dithering_ = Dithering::Ordered;
 
         template <typename T>
         auto get(std::string_view path,
                  T,
                  float scale,
                  Filter mag_filter,
-                 Filter min_filter) -> Texture;
+                 Filter min_filter,
+                 PixelFormat pixel_format) -> Texture;
 
         void load(TextureMap::iterator i,
                   const Image&,
@@ -110,6 +156,15 @@ namespace rainbow::graphics
             return std::make_tuple(mem_used_, mem_peak_);
         }
 
+        /// <summary>
+        ///   Decodes the texture loaded from specified path again, and
+        ///   re-uploads it in place.
+        /// </summary>
+        /// <returns>
+        ///   Whether a texture loaded from specified path was found.
+        /// </returns>
+        auto reload(std::string_view path) -> bool;
+
     private:
         size_t mem_used_ = 0;
         size_t mem_peak_ = 0;
@@ -170,6 +225,16 @@ namespace rainbow::graphics
                             const Image&,
                             Filter mag_filter,
                             Filter min_filter) = 0;
+
+        /// <summary>
+        ///   Replaces the region of the texture at (<paramref name="x"/>,
+        ///   <paramref name="y"/>) with <paramref name="image"/>. Mipmaps are
+        ///   not regenerated, and compressed formats are not supported.
+        /// </summary>
+        virtual void update_region(const TextureHandle&,
+                                   const Image& image,
+                                   uint32_t x,
+                                   uint32_t y) = 0;
     };
 
     void bind(const Context&, const Texture&, uint32_t unit = 0);
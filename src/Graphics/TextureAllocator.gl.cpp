@@ -6,6 +6,7 @@
 
 #include <tuple>
 
+#include "Common/Algorithm.h"
 #include "Common/Logging.h"
 #include "Common/TypeCast.h"
 #include "Graphics/Image.h"
@@ -51,12 +52,49 @@ namespace
             case Filter::Linear:
                 [[fallthrough]];
             case Filter::Cubic:
+                [[fallthrough]];
+            case Filter::Trilinear:
                 return GL_LINEAR;
         }
 
         std::abort();
     }
 
+    auto can_generate_mipmaps(const Image& image)
+    {
+        switch (image.format)
+        {
+            case Image::Format::Luminance:
+            case Image::Format::PNG:
+            case Image::Format::RGB565:
+            case Image::Format::RGBA:
+            case Image::Format::RGBA4444:
+            case Image::Format::RGBA5551:
+            case Image::Format::SVG:
+#ifdef GL_ES_VERSION_2_0
+                // OpenGL ES 2.0 does not support mipmaps for NPOT textures.
+                return rainbow::is_pow2(image.width) &&
+                       rainbow::is_pow2(image.height);
+#else
+                return true;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    constexpr auto internal_format_16bpp([[maybe_unused]] GLenum sized,
+                                         [[maybe_unused]] GLenum unsized)
+        -> GLenum
+    {
+#ifdef GL_ES_VERSION_2_0
+        // OpenGL ES 2.0 requires internal format to match format.
+        return unsized;
+#else
+        return sized;
+#endif
+    }
+
     auto texture_format(const Image& image) -> std::tuple<GLenum, GLenum>
     {
         switch (image.format)
@@ -103,9 +141,25 @@ namespace
                               : GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG,
                     GL_NONE);
 
+            case Image::Format::Luminance:
+                R_ASSERT(image.depth == 8, kInvalidColorDepth);
+                return std::make_tuple(GL_LUMINANCE, GL_LUMINANCE);
+
+            case Image::Format::RGB565:
+                return std::make_tuple(internal_format_16bpp(GL_RGB5, GL_RGB),
+                                       GL_RGB);
+
             case Image::Format::RGBA:
                 return std::make_tuple(GL_RGBA, GL_RGBA);
 
+            case Image::Format::RGBA4444:
+                return std::make_tuple(
+                    internal_format_16bpp(GL_RGBA4, GL_RGBA), GL_RGBA);
+
+            case Image::Format::RGBA5551:
+                return std::make_tuple(
+                    internal_format_16bpp(GL_RGB5_A1, GL_RGBA), GL_RGBA);
+
             case Image::Format::PNG:
                 [[fallthrough]];
             case Image::Format::SVG:
@@ -141,6 +195,21 @@ namespace
         std::abort();
     }
 
+    constexpr auto texture_type(const Image& image) -> GLenum
+    {
+        switch (image.format)
+        {
+            case Image::Format::RGB565:
+                return GL_UNSIGNED_SHORT_5_6_5;
+            case Image::Format::RGBA4444:
+                return GL_UNSIGNED_SHORT_4_4_4_4;
+            case Image::Format::RGBA5551:
+                return GL_UNSIGNED_SHORT_5_5_5_1;
+            default:
+                return GL_UNSIGNED_BYTE;
+        }
+    }
+
     constexpr auto texture_id(const TextureHandle& handle)
     {
         return rainbow::narrow_cast<GLuint>(handle[0]);
@@ -195,8 +264,13 @@ void TextureAllocator::update(const TextureHandle& handle,
                               Filter min_filter)
 {
     ::bind(handle, 0);
-    glTexParameteri(
-        GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture_filter(min_filter));
+
+    const bool generate_mipmaps =
+        min_filter == Filter::Trilinear && can_generate_mipmaps(image);
+    glTexParameteri(GL_TEXTURE_2D,
+                    GL_TEXTURE_MIN_FILTER,
+                    generate_mipmaps ? GL_LINEAR_MIPMAP_LINEAR
+                                     : texture_filter(min_filter));
     glTexParameteri(
         GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture_filter(mag_filter));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -230,6 +304,42 @@ void TextureAllocator::update(const TextureHandle& handle,
                 image.data);
             break;
 
+        case Image::Format::Luminance:
+            // Rows of 8-bit pixels are not guaranteed to be aligned at all.
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(  //
+                GL_TEXTURE_2D,
+                0,
+                internal_format,
+                narrow_cast<GLsizei>(image.width),
+                narrow_cast<GLsizei>(image.height),
+                0,
+                format,
+                GL_UNSIGNED_BYTE,
+                image.data);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            break;
+
+        case Image::Format::RGB565:
+            [[fallthrough]];
+        case Image::Format::RGBA4444:
+            [[fallthrough]];
+        case Image::Format::RGBA5551:
+            // Rows of 16-bit pixels are only guaranteed to be 2-byte aligned.
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+            glTexImage2D(  //
+                GL_TEXTURE_2D,
+                0,
+                internal_format,
+                narrow_cast<GLsizei>(image.width),
+                narrow_cast<GLsizei>(image.height),
+                0,
+                format,
+                texture_type(image),
+                image.data);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            break;
+
         case Image::Format::PNG:
             [[fallthrough]];
         case Image::Format::RGBA:
@@ -248,9 +358,47 @@ void TextureAllocator::update(const TextureHandle& handle,
             break;
     }
 
+    if (generate_mipmaps)
+        glGenerateMipmap(GL_TEXTURE_2D);
+
     R_ASSERT(glGetError() == GL_NO_ERROR, "Failed to upload texture");
 }
 
+void TextureAllocator::update_region(const TextureHandle& handle,
+                                     const Image& image,
+                                     uint32_t x,
+                                     uint32_t y)
+{
+    ::bind(handle, 0);
+
+    const auto format = std::get<1>(texture_format(image));
+    R_ASSERT(format != GL_NONE, "Compressed textures cannot be updated");
+
+    // Rows of 16-bit pixels are only guaranteed to be 2-byte aligned, and
+    // rows of 8-bit pixels are not guaranteed to be aligned at all.
+    const auto type = texture_type(image);
+    const GLint alignment = image.format == Image::Format::Luminance ? 1
+                            : type != GL_UNSIGNED_BYTE               ? 2
+                                                                     : 4;
+    if (alignment != 4)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    glTexSubImage2D(GL_TEXTURE_2D,
+                    0,
+                    narrow_cast<GLint>(x),
+                    narrow_cast<GLint>(y),
+                    narrow_cast<GLsizei>(image.width),
+                    narrow_cast<GLsizei>(image.height),
+                    format,
+                    type,
+                    image.data);
+
+    if (alignment != 4)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    R_ASSERT(glGetError() == GL_NO_ERROR, "Failed to update texture");
+}
+
 void rainbow::graphics::bind(const Context& ctx,
                              const Texture& texture,
                              uint32_t unit)
@@ -25,6 +25,11 @@ namespace rainbow::graphics::gl
                     const Image&,
                     Filter mag_filter,
                     Filter min_filter) override;
+
+        void update_region(const TextureHandle&,
+                           const Image&,
+                           uint32_t x,
+                           uint32_t y) override;
     };
 }  // namespace rainbow::graphics::gl
 
@@ -75,3 +75,17 @@ void rainbow::graphics::draw(const VertexArray& array,
 
     IF_DEBUG(increment_draw_count());
 }
+
+void rainbow::graphics::draw_elements(const VertexArray& array,
+                                      uint32_t first,
+                                      uint32_t count)
+{
+    array.bind();
+    glDrawElements(GL_TRIANGLES,
+                   narrow_cast<GLsizei>(count),
+                   GL_UNSIGNED_SHORT,
+                   // NOLINTNEXTLINE(performance-no-int-to-ptr)
+                   reinterpret_cast<const void*>(first * sizeof(GLushort)));
+
+    IF_DEBUG(increment_draw_count());
+}
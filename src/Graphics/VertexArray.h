@@ -67,6 +67,14 @@ namespace rainbow::graphics
 
     void draw(const VertexArray& array, uint32_t count);
     void draw(const VertexArray& array, uint32_t first, uint32_t count);
+
+    /// <summary>
+    ///   Draws <paramref name="count"/> indices from the shared element array,
+    ///   starting at index <paramref name="first"/>.
+    /// </summary>
+    void draw_elements(const VertexArray& array,
+                       uint32_t first,
+                       uint32_t count);
 }  // namespace rainbow::graphics
 
 #endif
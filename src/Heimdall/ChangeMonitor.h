@@ -10,7 +10,10 @@
 #include "Platform/Macros.h"
 #if defined(RAINBOW_OS_MACOS)
 #    include <CoreServices/CoreServices.h>
+#elif defined(RAINBOW_OS_LINUX)
+#    include <thread>
 #elif defined(RAINBOW_OS_WINDOWS)
+#    include <atomic>
 #    include <future>
 
 #    include <Windows.h>
@@ -21,17 +24,21 @@
 
 namespace heimdall
 {
+    /// <summary>
+    ///   Reports files modified in a directory, or any of its subdirectories.
+    /// </summary>
+    /// <remarks>
+    ///   Depending on the platform, <paramref name="callback"/> may be invoked
+    ///   from another thread. It may be invoked as soon as the constructor
+    ///   returns, and is no longer invoked once the destructor returns.
+    /// </remarks>
     class ChangeMonitor : private rainbow::NonCopyable<ChangeMonitor>
     {
     public:
-        explicit ChangeMonitor(rainbow::czstring directory);
-        ~ChangeMonitor();
+        using Callback = std::function<void(rainbow::czstring)>;
 
-        template <typename F>
-        void set_callback(F&& callback)
-        {
-            callback_ = std::move(callback);
-        }
+        ChangeMonitor(rainbow::czstring directory, Callback callback);
+        ~ChangeMonitor();
 
         void on_modified(rainbow::czstring path) { callback_(path); }
 
@@ -39,12 +46,16 @@ namespace heimdall
 #if defined(RAINBOW_OS_MACOS)
         FSEventStreamRef stream_;
         FSEventStreamContext context_;
+#elif defined(RAINBOW_OS_LINUX)
+        int inotify_fd_;
+        int wake_fd_;
+        std::thread worker_;
 #elif defined(RAINBOW_OS_WINDOWS)
-        bool monitoring_;
+        std::atomic<bool> monitoring_;
         HANDLE hDirectory_;
         std::future<void> worker_;
 #endif
-        std::function<void(rainbow::czstring)> callback_;
+        Callback callback_;
     };
 }  // namespace heimdall
 
@@ -0,0 +1,75 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef HEIMDALL_CHANGEQUEUE_H_
+#define HEIMDALL_CHANGEQUEUE_H_
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace heimdall
+{
+    /// <summary>
+    ///   Collects modified files until they are taken. A file modified
+    ///   several times in between is only reported once.
+    /// </summary>
+    class ChangeQueue
+    {
+    public:
+        explicit ChangeQueue(std::string_view root) : root_(root) {}
+
+        /// <summary>
+        ///   Queues a modified file. May be called from any thread.
+        /// </summary>
+        /// <remarks>
+        ///   Some platforms report absolute paths, others paths relative to
+        ///   the monitored directory. Both are queued as the latter, with
+        ///   forward slashes.
+        /// </remarks>
+        void push(std::string_view path)
+        {
+            if (!root_.empty() && path.substr(0, root_.size()) == root_)
+            {
+                path.remove_prefix(root_.size());
+                while (!path.empty() &&
+                       (path.front() == '/' || path.front() == '\\'))
+                {
+                    path.remove_prefix(1);
+                }
+            }
+
+            std::string change{path};
+            std::replace(std::begin(change), std::end(change), '\\', '/');
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (std::find(std::begin(changes_), std::end(changes_), change) ==
+                std::end(changes_))
+            {
+                changes_.push_back(std::move(change));
+            }
+        }
+
+        /// <summary>
+        ///   Returns queued files in the order they were first modified, and
+        ///   empties the queue.
+        /// </summary>
+        auto take() -> std::vector<std::string>
+        {
+            std::vector<std::string> changes;
+            std::lock_guard<std::mutex> lock(mutex_);
+            changes.swap(changes_);
+            return changes;
+        }
+
+    private:
+        const std::string root_;
+        std::mutex mutex_;
+        std::vector<std::string> changes_;
+    };
+}  // namespace heimdall
+
+#endif
@@ -6,7 +6,12 @@
 
 #ifdef USE_HEIMDALL
 
+#include "Common/Logging.h"
+#include "Common/String.h"
+#include "Graphics/Label.h"
+
 using heimdall::Gatekeeper;
+using rainbow::Label;
 using rainbow::Vec2i;
 
 void Gatekeeper::init(const Vec2i& screen)
@@ -19,6 +24,9 @@ void Gatekeeper::init(const Vec2i& screen)
 
 void Gatekeeper::update(uint64_t dt)
 {
+    for (auto&& path : changes_.take())
+        reload(path);
+
     director_.update(dt);
 
     if (!overlay_.is_enabled())
@@ -27,4 +35,41 @@ void Gatekeeper::update(uint64_t dt)
     overlay_.update(*director_.script(), dt);
 }
 
+void Gatekeeper::reload(const std::string& path)
+{
+    director_.asset_cache().invalidate(path);
+
+    if (rainbow::ends_with(path, ".js"))
+    {
+        LOGI("Restarting: %s was modified", path.c_str());
+        director_.restart();
+        return;
+    }
+
+    auto& context = director_.graphics_context();
+    if (context.texture_provider.reload(path))
+    {
+        LOGI("Reloaded texture: %s", path.c_str());
+        return;
+    }
+
+    if (context.shader_manager.reload(path))
+        return;
+
+    if (director_.typesetter().reload(path))
+    {
+        // Setting the font again forces labels to be laid out again.
+        for (auto&& unit : director_.render_queue())
+        {
+            auto label = rainbow::get<Label*>(unit.object());
+            if (!label || (*label)->font() != path)
+                continue;
+
+            (*label)->font(path.c_str());
+        }
+
+        LOGI("Reloaded font: %s", path.c_str());
+    }
+}
+
 #endif  // USE_HEIMDALL
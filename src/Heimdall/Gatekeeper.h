@@ -5,19 +5,31 @@
 #ifndef HEIMDALL_GATEKEEPER_H_
 #define HEIMDALL_GATEKEEPER_H_
 
+#include <string>
+
 #include "Director.h"
+#include "FileSystem/Bundle.h"
+#include "FileSystem/FileSystem.h"
+#include "Heimdall/ChangeMonitor.h"
+#include "Heimdall/ChangeQueue.h"
 #include "Heimdall/Overlay.h"
 #include "Heimdall/OverlayActivator.h"
 
 namespace heimdall
 {
-    /// <summary>Overlay for debugging options.</summary>
+    /// <summary>
+    ///   Overlay for debugging options. Also reloads assets as they are
+    ///   modified on disk.
+    /// </summary>
     class Gatekeeper final
     {
     public:
         Gatekeeper()
             : overlay_(director_),
-              overlay_activator_(director_.input(), overlay_)
+              overlay_activator_(director_.input(), overlay_),
+              changes_(rainbow::filesystem::bundle().assets_path()),
+              monitor_(rainbow::filesystem::bundle().assets_path(),
+                       [this](rainbow::czstring path) { changes_.push(path); })
         {
         }
 
@@ -54,6 +66,16 @@ namespace heimdall
         rainbow::Director director_;
         Overlay overlay_;
         OverlayActivator overlay_activator_;
+        ChangeQueue changes_;
+
+        // Must be destroyed first as its worker pushes to `changes_`.
+        ChangeMonitor monitor_;
+
+        /// <summary>
+        ///   Reloads the asset at specified path, relative to the assets
+        ///   directory. Scripts cannot be reloaded and restart the game.
+        /// </summary>
+        void reload(const std::string& path);
     };
 }  // namespace heimdall
 
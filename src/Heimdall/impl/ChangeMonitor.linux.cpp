@@ -0,0 +1,160 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Heimdall/ChangeMonitor.h"
+
+#ifdef USE_HEIMDALL
+
+#include <cerrno>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <dirent.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Common/Logging.h"
+
+using heimdall::ChangeMonitor;
+using rainbow::czstring;
+
+namespace
+{
+    constexpr uint32_t kWatchMask =
+        IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_ONLYDIR;
+
+    /// <summary>
+    ///   Maps watch descriptors to directories, relative to the monitored
+    ///   directory and with a trailing slash.
+    /// </summary>
+    using WatchMap = std::unordered_map<int, std::string>;
+
+    auto is_directory(const std::string& parent, const dirent& entry)
+    {
+        if (entry.d_type != DT_UNKNOWN)
+            return entry.d_type == DT_DIR;
+
+        struct stat info{};
+        const auto path = parent + entry.d_name;
+        return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    }
+
+    void watch(int fd,
+               const std::string& root,
+               const std::string& directory,
+               WatchMap& watches)
+    {
+        const auto path = root + directory;
+        const int wd = inotify_add_watch(fd, path.c_str(), kWatchMask);
+        if (wd < 0)
+        {
+            LOGW("Failed to monitor '%s'", path.c_str());
+            return;
+        }
+
+        watches[wd] = directory;
+
+        // inotify does not watch subdirectories; they must be added manually.
+        auto dir = opendir(path.c_str());
+        if (dir == nullptr)
+            return;
+
+        while (auto entry = readdir(dir))
+        {
+            // Skip '.', '..', and hidden directories such as '.git'.
+            if (entry->d_name[0] == '.' || !is_directory(path, *entry))
+                continue;
+
+            watch(fd, root, directory + entry->d_name + '/', watches);
+        }
+
+        closedir(dir);
+    }
+}  // namespace
+
+ChangeMonitor::ChangeMonitor(czstring directory, Callback callback)
+    : inotify_fd_(inotify_init1(IN_CLOEXEC)),
+      wake_fd_(eventfd(0, EFD_CLOEXEC)), callback_(std::move(callback))
+{
+    if (inotify_fd_ < 0 || wake_fd_ < 0)
+    {
+        LOGE("Failed to initialise inotify (errno %d)", errno);
+        return;
+    }
+
+    // Watch the existing directories before returning so that no changes
+    // made after construction are missed.
+    std::string root{directory};
+    root += '/';
+    WatchMap watches;
+    watch(inotify_fd_, root, {}, watches);
+
+    LOGI("Monitoring '%s'", directory);
+    worker_ = std::thread([this,
+                           root = std::move(root),
+                           watches = std::move(watches)]() mutable {
+        alignas(inotify_event) char buffer[4096];  // NOLINT
+        pollfd fds[]{{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        while (true)
+        {
+            if (poll(fds, std::size(fds), -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                LOGE("Stopped monitoring '%s' (errno %d)", root.c_str(), errno);
+                return;
+            }
+
+            if (fds[1].revents != 0)
+                return;
+
+            const auto length = read(inotify_fd_, buffer, sizeof(buffer));
+            for (auto ptr = buffer; ptr < buffer + length;)
+            {
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                auto event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                if ((event->mask & IN_IGNORED) != 0)
+                {
+                    watches.erase(event->wd);
+                    continue;
+                }
+
+                auto parent = watches.find(event->wd);
+                if (parent == watches.end() || event->len == 0)
+                    continue;
+
+                auto path = parent->second + event->name;
+                if ((event->mask & IN_ISDIR) != 0)
+                    watch(inotify_fd_, root, path + '/', watches);
+                else if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) != 0)
+                    on_modified(path.c_str());
+            }
+        }
+    });
+}
+
+ChangeMonitor::~ChangeMonitor()
+{
+    if (worker_.joinable())
+    {
+        const uint64_t wake = 1;
+        [[maybe_unused]] auto written = write(wake_fd_, &wake, sizeof(wake));
+        worker_.join();
+    }
+
+    if (wake_fd_ >= 0)
+        close(wake_fd_);
+    if (inotify_fd_ >= 0)
+        close(inotify_fd_);
+}
+
+#endif  // USE_HEIMDALL
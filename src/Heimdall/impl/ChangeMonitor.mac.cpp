@@ -40,8 +40,8 @@ namespace
     }
 }  // namespace
 
-ChangeMonitor::ChangeMonitor(czstring directory)
-    : stream_(nullptr), callback_([](czstring) {})
+ChangeMonitor::ChangeMonitor(czstring directory, Callback callback)
+    : stream_(nullptr), callback_(std::move(callback))
 {
     memset(&context_, 0, sizeof(context_));
     context_.info = this;
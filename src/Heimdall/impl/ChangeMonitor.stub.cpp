@@ -4,7 +4,12 @@
 
 #include "Heimdall/ChangeMonitor.h"
 
+#include <utility>
+
 using heimdall::ChangeMonitor;
 
-ChangeMonitor::ChangeMonitor(rainbow::czstring) {}
+ChangeMonitor::ChangeMonitor(rainbow::czstring, Callback callback)
+    : callback_(std::move(callback))
+{
+}
 ChangeMonitor::~ChangeMonitor() {}
@@ -11,8 +11,8 @@
 using heimdall::ChangeMonitor;
 using rainbow::czstring;
 
-ChangeMonitor::ChangeMonitor(czstring directory)
-    : monitoring_(false), callback_([](czstring) {})
+ChangeMonitor::ChangeMonitor(czstring directory, Callback callback)
+    : monitoring_(false), callback_(std::move(callback))
 {
     hDirectory_ =
         CreateFileA(directory,
@@ -57,6 +57,10 @@ ChangeMonitor::ChangeMonitor(czstring directory)
 
                 lpInfo =
                     reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(lpBuffer);
+
+                // Advance before anything below skips to the next entry.
+                lpBuffer += lpInfo->NextEntryOffset;
+
                 if (lpInfo->Action != FILE_ACTION_MODIFIED)
                     continue;
 
@@ -73,8 +77,6 @@ ChangeMonitor::ChangeMonitor(czstring directory)
                     nullptr, nullptr);
                 lpPath[length] = '\0';
                 on_modified(lpPath);
-
-                lpBuffer += lpInfo->NextEntryOffset;
             } while (lpInfo->NextEntryOffset > 0);
         } while (monitoring_);
     });
@@ -22,6 +22,7 @@
 
 #include "Common/Functional.h"
 #include "Config.h"
+#include "Cooker/Cooker.h"
 #include "FileSystem/Bundle.h"
 #include "FileSystem/FileSystem.h"
 #include "Platform/SDL/Context.h"
@@ -75,6 +76,9 @@ auto main(int argc, char* argv[]) -> int
     rainbow::windows::Console console;
 #endif
 
+    if (rainbow::cooker::should_cook(std::ref(argc), std::ref(argv)))
+        return rainbow::cooker::run(argc, argv);
+
     const rainbow::Config config;
     SDLContext context(config);
     if (!context)
@@ -0,0 +1,78 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef SCRIPT_JAVASCRIPT_FONTCACHE_H_
+#define SCRIPT_JAVASCRIPT_FONTCACHE_H_
+
+#include <vector>
+
+#include "Script/JavaScript/Helper.h"
+#include "Text/FontCache.h"
+
+namespace rainbow::duk::fontcache
+{
+    /// <summary>
+    ///   Returns the code points of the string at <paramref name="idx"/>.
+    /// </summary>
+    auto get_code_points(duk_context* ctx, duk_idx_t idx)
+    {
+        constexpr uint32_t kHighSurrogate = 0xd800;
+        constexpr uint32_t kLowSurrogate = 0xdc00;
+        constexpr uint32_t kLowSurrogateEnd = 0xe000;
+        constexpr uint32_t kSupplementaryPlanes = 0x10000;
+
+        duk_require_string(ctx, idx);
+
+        // Characters outside the Basic Multilingual Plane are stored as
+        // surrogate pairs.
+        const auto length = duk_get_length(ctx, idx);
+        std::vector<uint32_t> code_points;
+        code_points.reserve(length);
+        for (duk_size_t i = 0; i < length; ++i)
+        {
+            auto c = static_cast<uint32_t>(duk_char_code_at(ctx, idx, i));
+            if (c >= kHighSurrogate && c < kLowSurrogate && i + 1 < length)
+            {
+                const auto low =
+                    static_cast<uint32_t>(duk_char_code_at(ctx, idx, i + 1));
+                if (low >= kLowSurrogate && low < kLowSurrogateEnd)
+                {
+                    c = kSupplementaryPlanes + ((c - kHighSurrogate) << 10) +
+                        (low - kLowSurrogate);
+                    ++i;
+                }
+            }
+            code_points.push_back(c);
+        }
+        return code_points;
+    }
+}  // namespace rainbow::duk::fontcache
+
+namespace rainbow::duk
+{
+    void initialize_fontcache(duk_context* ctx)
+    {
+        duk_push_c_function(  //
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                auto font_cache = FontCache::Get();
+                if (font_cache == nullptr)
+                    return 0;
+
+                const auto font = duk_require_string(ctx, 0);
+                const auto font_size = duk_require_int(ctx, 1);
+                const auto code_points = fontcache::get_code_points(ctx, 2);
+                if (code_points.empty())
+                    return 0;
+
+                font_cache->prewarm(
+                    font, font_size, {code_points.data(), code_points.size()});
+                return 0;
+            },
+            3);
+        duk::put_prop_literal(ctx, -2, "prewarm");
+    }
+}  // namespace rainbow::duk
+
+#endif
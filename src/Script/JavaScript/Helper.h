@@ -26,9 +26,14 @@
 
 #define DUKR_HIDDEN_SYMBOL_ADDRESS DUK_HIDDEN_SYMBOL("address")
 #define DUKR_HIDDEN_SYMBOL_CALLBACK DUK_HIDDEN_SYMBOL("callback")
+#define DUKR_HIDDEN_SYMBOL_ID DUK_HIDDEN_SYMBOL("id")
+#define DUKR_HIDDEN_SYMBOL_RESULT DUK_HIDDEN_SYMBOL("result")
+#define DUKR_HIDDEN_SYMBOL_STATE DUK_HIDDEN_SYMBOL("state")
 #define DUKR_HIDDEN_SYMBOL_TYPE DUK_HIDDEN_SYMBOL("type")
 #define DUKR_IDX_INPUT 0
 #define DUKR_IDX_SPRITE_PROTOTYPE 1
+#define DUKR_IDX_IO_REQUEST_PROTOTYPE 2
+#define DUKR_IDX_IO_PENDING_REQUESTS 3
 #define DUKR_WELLKNOWN_SYMBOL_TOSTRINGTAG                                      \
     DUK_WELLKNOWN_SYMBOL("Symbol.toStringTag")
 
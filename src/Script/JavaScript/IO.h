@@ -0,0 +1,293 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef SCRIPT_JAVASCRIPT_IO_H_
+#define SCRIPT_JAVASCRIPT_IO_H_
+
+#include <algorithm>
+#include <string>
+
+#include "Common/TypeCast.h"
+#include "FileSystem/AsyncIO.h"
+#include "Script/JavaScript/Helper.h"
+
+// Duktape does not implement promises. I/O requests are instead returned as
+// thenables; `then(onFulfilled, onRejected)` registers callbacks that are
+// invoked once the request settles. Wrap them with `Promise.resolve()` if a
+// promise polyfill is available.
+
+namespace rainbow::duk::io
+{
+    enum class State
+    {
+        Pending,
+        Fulfilled,
+        Rejected,
+    };
+
+    /// <summary>
+    ///   Pushes a pending request object. It is kept alive in the stash until
+    ///   it has settled.
+    /// </summary>
+    void push_request(duk_context* ctx)
+    {
+        duk_push_object(ctx);
+        // => [ request ]
+        duk_push_global_stash(ctx);
+        duk_get_prop_index(ctx, -1, DUKR_IDX_IO_REQUEST_PROTOTYPE);
+        duk_set_prototype(ctx, -3);
+        duk_pop(ctx);
+
+        duk::push(ctx, to_underlying_type(State::Pending));
+        duk::put_prop_literal(ctx, -2, DUKR_HIDDEN_SYMBOL_STATE);
+        duk_push_array(ctx);
+        duk::put_prop_literal(ctx, -2, DUKR_HIDDEN_SYMBOL_CALLBACK);
+    }
+
+    void register_request(duk_context* ctx, AsyncIO::RequestId id)
+    {
+        // => [ request ]
+        duk::push(ctx, id);
+        duk::put_prop_literal(ctx, -2, DUKR_HIDDEN_SYMBOL_ID);
+
+        duk_push_global_stash(ctx);
+        duk_get_prop_index(ctx, -1, DUKR_IDX_IO_PENDING_REQUESTS);
+        // => [ request stash pending ]
+        duk_dup(ctx, -3);
+        duk_put_prop_index(ctx, -2, id);
+        duk_pop_2(ctx);
+    }
+
+    /// <summary>
+    ///   Settles the request at <paramref name="ptr"/> with the value at the
+    ///   top of the stack, and invokes its callbacks.
+    /// </summary>
+    void settle(duk_context* ctx, void* ptr, State state)
+    {
+        // => [ value ]
+        duk_push_heapptr(ctx, ptr);
+        // => [ value request ]
+        duk_push_global_stash(ctx);
+        duk_get_prop_index(ctx, -1, DUKR_IDX_IO_PENDING_REQUESTS);
+        duk::get_prop_literal(ctx, -3, DUKR_HIDDEN_SYMBOL_ID);
+        duk_del_prop(ctx, -2);
+        duk_pop_2(ctx);
+
+        duk::push(ctx, to_underlying_type(state));
+        duk::put_prop_literal(ctx, -2, DUKR_HIDDEN_SYMBOL_STATE);
+        duk_dup(ctx, -2);
+        duk::put_prop_literal(ctx, -2, DUKR_HIDDEN_SYMBOL_RESULT);
+
+        duk::get_prop_literal(ctx, -1, DUKR_HIDDEN_SYMBOL_CALLBACK);
+        // => [ value request callbacks ]
+        duk_push_undefined(ctx);
+        duk::put_prop_literal(ctx, -3, DUKR_HIDDEN_SYMBOL_CALLBACK);
+
+        // Callbacks are stored in pairs of `onFulfilled` and `onRejected`.
+        const auto length = duk_get_length(ctx, -1);
+        for (duk_uarridx_t i = state == State::Fulfilled ? 0 : 1; i < length;
+             i += 2)
+        {
+            duk_get_prop_index(ctx, -1, i);
+            if (duk_is_callable(ctx, -1))
+            {
+                duk_dup(ctx, -4);
+                // => [ value request callbacks callback value ]
+                if (duk_pcall(ctx, 1) != DUK_EXEC_SUCCESS)
+                    dump_context(ctx);
+            }
+            duk_pop(ctx);
+        }
+
+        duk_pop_3(ctx);
+    }
+
+    /// <summary>Returns a completion handler for a request.</summary>
+    template <typename T, typename F>
+    auto on_complete(duk_context* ctx, void* ptr, F&& push_result)
+    {
+        return [ctx, ptr, push_result = std::forward<F>(push_result)](
+                   T result) mutable {
+            const bool success = static_cast<bool>(result);
+            push_result(ctx, std::move(result));
+            settle(ctx, ptr, success ? State::Fulfilled : State::Rejected);
+        };
+    }
+
+    auto get_priority(duk_context* ctx, duk_idx_t idx)
+    {
+        if (!duk_is_number(ctx, idx))
+            return IOPriority::Normal;
+
+        const auto priority = std::clamp(
+            duk_get_int(ctx, idx), 0, to_underlying_type(IOPriority::High));
+        return static_cast<IOPriority>(priority);
+    }
+
+    template <FileType Type>
+    auto read_file(duk_context* ctx) -> duk_ret_t
+    {
+        auto io = AsyncIO::Get();
+        if (io == nullptr)
+            return 0;
+
+        const auto path = duk_require_string(ctx, 0);
+        const auto priority = get_priority(ctx, 1);
+
+        push_request(ctx);
+        const auto id = io->read(
+            path,
+            Type,
+            priority,
+            on_complete<Data>(
+                ctx,
+                duk_get_heapptr(ctx, -1),
+                [path = std::string{path}](duk_context* ctx, Data data) {
+                    if (!data)
+                    {
+                        duk_push_sprintf(
+                            ctx, "Failed to read '%s'", path.c_str());
+                        return;
+                    }
+
+                    auto buffer = duk_push_fixed_buffer(ctx, data.size());
+                    std::copy_n(data.bytes(),
+                                data.size(),
+                                static_cast<uint8_t*>(buffer));
+                    duk_push_buffer_object(ctx,
+                                           -1,
+                                           0,
+                                           data.size(),
+                                           DUK_BUFOBJ_ARRAYBUFFER);
+                    duk_remove(ctx, -2);
+                }));
+        register_request(ctx, id);
+        return 1;
+    }
+
+    auto write_file(duk_context* ctx) -> duk_ret_t
+    {
+        auto io = AsyncIO::Get();
+        if (io == nullptr)
+            return 0;
+
+        const auto path = duk_require_string(ctx, 0);
+
+        duk_size_t size = 0;
+        const void* source = duk_is_string(ctx, 1)
+                                 ? duk_get_lstring(ctx, 1, &size)
+                                 : duk_require_buffer_data(ctx, 1, &size);
+
+        const auto priority = get_priority(ctx, 2);
+
+        push_request(ctx);
+        const auto id = io->write(
+            path,
+            source,
+            size,
+            priority,
+            on_complete<bool>(
+                ctx,
+                duk_get_heapptr(ctx, -1),
+                [path = std::string{path}](duk_context* ctx, bool success) {
+                    if (success)
+                        duk_push_undefined(ctx);
+                    else
+                        duk_push_sprintf(
+                            ctx, "Failed to write '%s'", path.c_str());
+                }));
+        register_request(ctx, id);
+        return 1;
+    }
+}  // namespace rainbow::duk::io
+
+namespace rainbow::duk
+{
+    void initialize_io(duk_context* ctx)
+    {
+        duk_push_c_function(ctx, &io::read_file<FileType::Asset>, 2);
+        duk::put_prop_literal(ctx, -2, "readFile");
+
+        duk_push_c_function(ctx, &io::read_file<FileType::UserFile>, 2);
+        duk::put_prop_literal(ctx, -2, "readUserFile");
+
+        duk_push_c_function(ctx, &io::write_file, 3);
+        duk::put_prop_literal(ctx, -2, "writeFile");
+
+        duk_push_global_stash(ctx);
+
+        // Prototype of all request objects
+        duk_push_bare_object(ctx);
+
+        duk_push_c_function(  //
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                duk_push_this(ctx);
+                // => [ onFulfilled onRejected request ]
+                duk::get_prop_literal(ctx, -1, DUKR_HIDDEN_SYMBOL_STATE);
+                const auto state =
+                    static_cast<io::State>(duk_get_int(ctx, -1));
+                duk_pop(ctx);
+
+                if (state == io::State::Pending)
+                {
+                    duk::get_prop_literal(
+                        ctx, -1, DUKR_HIDDEN_SYMBOL_CALLBACK);
+                    const auto length = duk_get_length(ctx, -1);
+                    duk_dup(ctx, 0);
+                    duk_put_prop_index(ctx, -2, length);
+                    duk_dup(ctx, 1);
+                    duk_put_prop_index(ctx, -2, length + 1);
+                    return 0;
+                }
+
+                // Already settled; call back immediately.
+                const auto idx = state == io::State::Fulfilled ? 0 : 1;
+                if (duk_is_callable(ctx, idx))
+                {
+                    duk_dup(ctx, idx);
+                    duk::get_prop_literal(ctx, -2, DUKR_HIDDEN_SYMBOL_RESULT);
+                    duk_call(ctx, 1);
+                }
+                return 0;
+            },
+            2);
+        duk::put_prop_literal(ctx, -2, "then");
+
+        duk_push_c_function(  //
+            ctx,
+            [](duk_context* ctx) -> duk_ret_t {
+                duk_push_this(ctx);
+                duk::get_prop_literal(ctx, -1, DUKR_HIDDEN_SYMBOL_ID);
+                auto io = AsyncIO::Get();
+                const bool cancelled =
+                    duk_is_number(ctx, -1) && io != nullptr &&
+                    io->cancel(duk::get<uint32_t>(ctx, -1));
+                if (cancelled)
+                {
+                    duk::push_literal(ctx, "Request was cancelled");
+                    io::settle(
+                        ctx, duk_get_heapptr(ctx, -3), io::State::Rejected);
+                }
+
+                duk::push(ctx, cancelled);
+                return 1;
+            },
+            0);
+        duk::put_prop_literal(ctx, -2, "cancel");
+
+        duk::push_literal(ctx, "Rainbow.IORequest");
+        duk::put_prop_literal(ctx, -2, DUKR_WELLKNOWN_SYMBOL_TOSTRINGTAG);
+        duk_freeze(ctx, -1);
+        duk_put_prop_index(ctx, -2, DUKR_IDX_IO_REQUEST_PROTOTYPE);
+
+        // Requests in flight
+        duk_push_bare_object(ctx);
+        duk_put_prop_index(ctx, -2, DUKR_IDX_IO_PENDING_REQUESTS);
+
+        duk_pop(ctx);
+    }
+}  // namespace rainbow::duk
+
+#endif
@@ -9,7 +9,9 @@
 #include "FileSystem/FileSystem.h"
 #include "Script/JavaScript/Audio.h"
 #include "Script/JavaScript/Console.h"
+#include "Script/JavaScript/FontCache.h"
 #include "Script/JavaScript/Helper.h"
+#include "Script/JavaScript/IO.h"
 #include "Script/JavaScript/Input.h"
 #include "Script/JavaScript/Module.h"
 #include "Script/JavaScript/Modules.g.h"
@@ -64,6 +66,9 @@ JavaScript::JavaScript(Director& director) : GameBase(director), context_(this)
 
     const auto rainbow = duk_push_bare_object(context_);
     duk::register_module(context_, rainbow, "Audio", &duk::initialize_audio);
+    duk::register_module(
+        context_, rainbow, "FontCache", &duk::initialize_fontcache);
+    duk::register_module(context_, rainbow, "IO", &duk::initialize_io);
     duk::register_module(context_, rainbow, "Input", [this](duk_context* ctx) {
         duk::initialize_input(ctx, input());
     });
@@ -123,7 +128,7 @@ JavaScript::JavaScript(Director& director) : GameBase(director), context_(this)
 
     duk::push(context_, index_js);
 
-    const auto data = File::read(index_js, FileType::Asset);
+    const auto data = File::map(index_js, FileType::Asset);
     if (duk_pcompile_lstring_filename(context_,
                                       DUK_COMPILE_STRICT,
                                       data.as<const char*>(),
@@ -64,7 +64,7 @@ auto rainbow::duk::module::load(duk_context* ctx) -> duk_ret_t
     auto resolved_id = duk_get_lstring(ctx, 0, &id_length);
     throw_if(ctx, id_length == 0, DUK_ERR_TYPE_ERROR, "invalid module name");
 
-    const auto data = File::read(resolved_id, FileType::Asset);
+    const auto data = File::map(resolved_id, FileType::Asset);
     throw_if(
         ctx, !data, DUK_RET_ERROR, "error loading module: %s", resolved_id);
     duk_push_lstring(ctx, data.as<const char*>(), data.size());
@@ -12,6 +12,7 @@
 #include "Audio/Mixer.h"
 #include "Common/TypeCast.h"
 #include "Common/TypeInfo.h"
+#include "FileSystem/AsyncIO.h"
 #include "Graphics/Animation.h"
 #include "Graphics/Label.h"
 #include "Graphics/RenderQueue.h"
@@ -241,6 +242,20 @@ void rainbow::duk::register_module<rainbow::ControllerButton>(duk_context* ctx,
     duk::put_prop_literal(ctx, rainbow, "ControllerButton");
 }
 
+template <>
+void rainbow::duk::register_module<rainbow::IOPriority>(duk_context* ctx, duk_idx_t rainbow)
+{
+    const auto obj_idx = duk_push_bare_object(ctx);
+    duk_push_int(ctx, to_underlying_type(IOPriority::Low));
+    duk::put_prop_literal(ctx, obj_idx, "Low");
+    duk_push_int(ctx, to_underlying_type(IOPriority::Normal));
+    duk::put_prop_literal(ctx, obj_idx, "Normal");
+    duk_push_int(ctx, to_underlying_type(IOPriority::High));
+    duk::put_prop_literal(ctx, obj_idx, "High");
+    duk_freeze(ctx, -1);
+    duk::put_prop_literal(ctx, rainbow, "IOPriority");
+}
+
 template <>
 void rainbow::duk::register_module<rainbow::Label>(duk_context* ctx, duk_idx_t rainbow)
 {
@@ -1128,6 +1143,7 @@ namespace rainbow::duk
         duk::register_module<AnimationEvent>(ctx, obj_idx);
         duk::register_module<ControllerAxis>(ctx, obj_idx);
         duk::register_module<ControllerButton>(ctx, obj_idx);
+        duk::register_module<IOPriority>(ctx, obj_idx);
         duk::register_module<Label>(ctx, obj_idx);
         duk::register_module<SpriteRef>(ctx, obj_idx);
         duk::register_module<SpriteBatch>(ctx, obj_idx);
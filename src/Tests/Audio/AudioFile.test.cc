@@ -37,3 +37,33 @@ TEST(AudioFileTest, LoadsOggVorbis)
     ASSERT_EQ(file->size(), 17640u);
 }
 #endif  // !RAINBOW_OS_IOS
+
+TEST(AudioFileTest, LoadsCookedPCM)
+{
+    ScopedAssetsDirectory scoped_assets{"AudioTest"};
+
+    auto file = IAudioFile::open("test.pcm");
+
+    ASSERT_TRUE(*file);
+    ASSERT_EQ(file->channels(), 1);
+    ASSERT_EQ(file->rate(), 8000);
+    ASSERT_EQ(file->size(), 8u);
+
+    int16_t samples[6]{-1, -1, -1, -1, -1, -1};
+    ASSERT_EQ(file->read(samples, sizeof(samples)), 8u);
+    ASSERT_EQ(samples[0], 0);
+    ASSERT_EQ(samples[1], 1000);
+    ASSERT_EQ(samples[2], -1000);
+    ASSERT_EQ(samples[3], 32767);
+    ASSERT_EQ(samples[4], 0);
+    ASSERT_EQ(samples[5], 0);
+
+    ASSERT_TRUE(file->seek(6));
+    ASSERT_EQ(file->read(samples, sizeof(int16_t)), 2u);
+    ASSERT_EQ(samples[0], 32767);
+    ASSERT_FALSE(file->seek(10));
+
+    file->rewind();
+    ASSERT_EQ(file->read(samples, sizeof(int16_t)), 2u);
+    ASSERT_EQ(samples[0], 0);
+}
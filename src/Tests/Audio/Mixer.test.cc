@@ -4,7 +4,11 @@
 
 #include "Audio/Mixer.h"
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -310,3 +314,412 @@ TEST(AudioTest, ClearsAllChannels)
         ASSERT_PRED1(not_playing, channels[i]);
     }
 }
+
+#if !defined(RAINBOW_AUDIO_AL) && !defined(RAINBOW_AUDIO_FMOD)
+namespace
+{
+    using rainbow::audio::ChannelQueue;
+    using rainbow::audio::ChannelState;
+    using CommandType = ChannelQueue::CommandType;
+
+    /// <summary>
+    ///   Changes channel state on the game thread the way the mixer does
+    ///   before sending a command.
+    /// </summary>
+    void send(ChannelQueue& queue,
+              CommandType type,
+              Channel& channel,
+              float volume = 0.0F)
+    {
+        switch (type)
+        {
+            case CommandType::Play:
+            case CommandType::Resume:
+                channel.state = ChannelState::Playing;
+                break;
+            case CommandType::Pause:
+                channel.state = ChannelState::Paused;
+                break;
+            case CommandType::Stop:
+                channel.state = ChannelState::Stopped;
+                break;
+            case CommandType::SetVolume:
+                break;
+        }
+        queue.send(type, channel, volume);
+    }
+
+    auto handle_events(ChannelQueue& queue)
+    {
+        std::vector<Channel*> retired;
+        queue.handle_events([&retired](Channel& ch) {
+            retired.push_back(&ch);
+        });
+        return retired;
+    }
+}  // namespace
+
+TEST(ChannelQueueTest, AppliesCommandsAtBufferBoundaries)
+{
+    Channel channels[2];
+    auto& first = channels[0];
+    auto& second = channels[1];
+    ChannelQueue queue{2};
+
+    send(queue, CommandType::Play, first);
+    send(queue, CommandType::Play, second);
+
+    ASSERT_EQ(first.mix_state, ChannelState::Stopped);
+    ASSERT_EQ(second.mix_state, ChannelState::Stopped);
+
+    queue.apply_commands();
+
+    ASSERT_EQ(first.mix_state, ChannelState::Playing);
+    ASSERT_EQ(second.mix_state, ChannelState::Playing);
+
+    send(queue, CommandType::Pause, first);
+    send(queue, CommandType::SetVolume, second, 0.5F);
+
+    ASSERT_EQ(first.mix_state, ChannelState::Playing);
+    ASSERT_EQ(second.volume, 1.0F);
+
+    queue.apply_commands();
+
+    ASSERT_EQ(first.mix_state, ChannelState::Paused);
+    ASSERT_EQ(second.volume, 0.5F);
+
+    send(queue, CommandType::Resume, first);
+    queue.apply_commands();
+
+    ASSERT_EQ(first.mix_state, ChannelState::Playing);
+
+    // A stopped channel is handed back only after the audio thread has let go
+    // of it.
+    send(queue, CommandType::Stop, first);
+
+    ASSERT_TRUE(handle_events(queue).empty());
+
+    queue.apply_commands();
+
+    ASSERT_EQ(first.mix_state, ChannelState::Stopped);
+    ASSERT_EQ(handle_events(queue), std::vector<Channel*>{&first});
+
+    // A finished channel is stopped on both sides.
+    queue.finish(second);
+
+    ASSERT_EQ(second.mix_state, ChannelState::Stopped);
+    ASSERT_EQ(second.state, ChannelState::Playing);
+    ASSERT_EQ(handle_events(queue), std::vector<Channel*>{&second});
+    ASSERT_EQ(second.state, ChannelState::Stopped);
+    ASSERT_TRUE(handle_events(queue).empty());
+}
+
+TEST(ChannelQueueTest, IgnoresCommandsForFinishedChannels)
+{
+    Channel channels[2];
+    auto& paused = channels[0];
+    auto& stopped = channels[1];
+    ChannelQueue queue{2};
+
+    send(queue, CommandType::Play, paused);
+    send(queue, CommandType::Play, stopped);
+    queue.apply_commands();
+
+    // Both channels run out of data before the game thread finds out.
+    queue.finish(paused);
+    queue.finish(stopped);
+
+    send(queue, CommandType::Pause, paused);
+    send(queue, CommandType::Resume, paused);
+    send(queue, CommandType::Stop, stopped);
+    queue.apply_commands();
+
+    ASSERT_EQ(paused.mix_state, ChannelState::Stopped);
+    ASSERT_EQ(stopped.mix_state, ChannelState::Stopped);
+
+    // Each channel is handed back exactly once.
+    const auto retired = handle_events(queue);
+
+    ASSERT_EQ(retired.size(), 2U);
+    ASSERT_EQ(std::count(retired.begin(), retired.end(), &paused), 1);
+    ASSERT_EQ(std::count(retired.begin(), retired.end(), &stopped), 1);
+    ASSERT_EQ(paused.state, ChannelState::Stopped);
+    ASSERT_EQ(stopped.state, ChannelState::Stopped);
+}
+
+TEST(ChannelQueueTest, SendsCommandsThatDidNotFitInOrder)
+{
+    constexpr int kCommands = 100;
+
+    Channel channel;
+    ChannelQueue queue{1};
+
+    send(queue, CommandType::Play, channel);
+    for (int i = 1; i < kCommands; ++i)
+        send(queue, CommandType::SetVolume, channel, static_cast<float>(i));
+
+    const auto waiting = queue.pending();
+
+    ASSERT_GT(waiting, 0U);
+    ASSERT_LT(waiting, static_cast<size_t>(kCommands));
+
+    // Only the commands that fit in the ring are applied.
+    queue.apply_commands();
+
+    const auto sent = kCommands - waiting;
+
+    ASSERT_EQ(channel.mix_state, ChannelState::Playing);
+    ASSERT_EQ(channel.volume, static_cast<float>(sent - 1));
+
+    // New commands must wait behind the ones already waiting.
+    send(queue, CommandType::Pause, channel);
+
+    ASSERT_EQ(queue.pending(), waiting + 1);
+
+    float volume = channel.volume;
+    while (queue.pending() > 0)
+    {
+        queue.flush();
+        queue.apply_commands();
+
+        ASSERT_GE(channel.volume, volume);
+        volume = channel.volume;
+    }
+
+    ASSERT_EQ(channel.volume, static_cast<float>(kCommands - 1));
+    ASSERT_EQ(channel.mix_state, ChannelState::Paused);
+}
+
+TEST(ChannelQueueTest, DeliversAllEventsWhenEveryChannelStops)
+{
+    Channel channels[kMaxAudioChannels];
+    ChannelQueue queue{kMaxAudioChannels};
+
+    for (auto&& channel : channels)
+        send(queue, CommandType::Play, channel);
+    queue.apply_commands();
+
+    // The worst case: every channel both finishes and is stopped before the
+    // game thread handles any events.
+    for (auto&& channel : channels)
+        queue.finish(channel);
+    for (auto&& channel : channels)
+        send(queue, CommandType::Stop, channel);
+    queue.apply_commands();
+
+    const auto retired = handle_events(queue);
+
+    ASSERT_EQ(retired.size(), static_cast<size_t>(kMaxAudioChannels));
+    for (auto&& channel : channels)
+    {
+        ASSERT_EQ(std::count(retired.begin(), retired.end(), &channel), 1);
+        ASSERT_EQ(channel.state, ChannelState::Stopped);
+    }
+}
+
+namespace
+{
+    constexpr char kCookedTestFile[] = "test.pcm";
+
+    /// <summary>Exposes how much memory decoded sounds take.</summary>
+    class TestMixer : public rainbow::audio::CubebMixer
+    {
+    public:
+        /// <summary>
+        ///   Processes until decoded sounds take <paramref name="size"/>
+        ///   bytes, or gives up after a while.
+        /// </summary>
+        void wait_for_decoded_size(size_t size)
+        {
+            wait_until([this, size] { return decoded_size() == size; });
+        }
+
+        /// <summary>
+        ///   Processes until <paramref name="sound"/> is decoded, or gives up
+        ///   after a while.
+        /// </summary>
+        void wait_for_decoded(const Sound* sound)
+        {
+            wait_until([this, sound] { return is_decoded(sound); });
+        }
+
+        /// <summary>
+        ///   Processes until <paramref name="done"/> returns <c>true</c>, or
+        ///   gives up after a while.
+        /// </summary>
+        template <typename F>
+        void wait_until(F&& done)
+        {
+            for (int i = 0; !done() && i < 1000; ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                process();
+            }
+        }
+    };
+}  // namespace
+
+TEST(CubebMixerTest, KeepsDecodedSoundsWithinLimit)
+{
+    ScopedAssetsDirectory scoped_assets{"AudioTest"};
+
+    TestMixer mixer;
+    ASSERT_TRUE(mixer.initialize(kMaxAudioChannels));
+
+    auto first = rainbow::audio::load_sound(kAudioTestFile);
+    const auto size = mixer.decoded_size();
+
+    ASSERT_GT(size, 0U);
+
+    // Make room for two decoded sounds.
+    mixer.set_max_decoded_size(size * 5 / 2);
+    auto second = rainbow::audio::load_sound(kAudioTestFile);
+
+    ASSERT_EQ(mixer.decoded_size(), size * 2);
+
+    // A sound that is released while playing stays in memory until the
+    // channel lets go of it.
+    auto channel = rainbow::audio::play(second);
+
+    ASSERT_PRED1(rainbow::audio::is_playing, channel);
+
+    rainbow::audio::release(second);
+
+    ASSERT_EQ(mixer.decoded_size(), size * 2);
+
+    // The sound that is not playing is dropped to make room.
+    auto third = rainbow::audio::load_sound(kAudioTestFile);
+
+    ASSERT_EQ(mixer.decoded_size(), size * 2);
+
+    mixer.wait_for_decoded_size(size);
+
+    ASSERT_EQ(mixer.decoded_size(), size);
+
+    // Sounds are streamed when they can't be decoded without dropping
+    // sounds that are playing.
+    auto playing = rainbow::audio::play(third);
+    auto fourth = rainbow::audio::load_sound(kAudioTestFile);
+
+    ASSERT_EQ(mixer.decoded_size(), size * 2);
+
+    rainbow::audio::play(fourth);
+    auto fifth = rainbow::audio::load_sound(kAudioTestFile);
+
+    ASSERT_EQ(mixer.decoded_size(), size * 2);
+
+    rainbow::audio::stop(playing);
+    rainbow::audio::release(first);
+    rainbow::audio::release(third);
+    rainbow::audio::release(fourth);
+    rainbow::audio::release(fifth);
+    mixer.wait_for_decoded_size(0);
+
+    ASSERT_EQ(mixer.decoded_size(), 0U);
+}
+
+TEST(CubebMixerTest, DecodesDroppedSoundsInBackground)
+{
+    ScopedAssetsDirectory scoped_assets{"AudioTest"};
+
+    TestMixer mixer;
+    ASSERT_TRUE(mixer.initialize(kMaxAudioChannels));
+
+    auto first = rainbow::audio::load_sound(kAudioTestFile);
+    const auto size = mixer.decoded_size();
+
+    // Make room for one decoded sound.
+    mixer.set_max_decoded_size(size * 3 / 2);
+    auto second = rainbow::audio::load_sound(kAudioTestFile);
+
+    ASSERT_FALSE(mixer.is_decoded(first));
+    ASSERT_TRUE(mixer.is_decoded(second));
+
+    // The dropped sound is streamed while it is decoded again. Its room is
+    // reserved right away.
+    auto streaming = rainbow::audio::play(first);
+
+    ASSERT_PRED1(rainbow::audio::is_playing, streaming);
+    ASSERT_FALSE(mixer.is_decoded(first));
+    ASSERT_FALSE(mixer.is_decoded(second));
+    ASSERT_EQ(mixer.decoded_size(), size);
+
+    mixer.wait_for_decoded(first);
+
+    ASSERT_TRUE(mixer.is_decoded(first));
+    ASSERT_EQ(mixer.decoded_size(), size);
+
+    // There is no room while the decoded sound is playing.
+    auto playing = rainbow::audio::play(first);
+    rainbow::audio::play(second);
+    mixer.process();
+
+    ASSERT_FALSE(mixer.is_decoded(second));
+    ASSERT_EQ(mixer.decoded_size(), size);
+
+    // Once it stops, there is room again.
+    rainbow::audio::stop(playing);
+    mixer.wait_until([playing] { return playing->source == nullptr; });
+    rainbow::audio::play(second);
+    mixer.wait_for_decoded(second);
+
+    ASSERT_TRUE(mixer.is_decoded(second));
+    ASSERT_FALSE(mixer.is_decoded(first));
+    ASSERT_EQ(mixer.decoded_size(), size);
+
+    rainbow::audio::release(first);
+    rainbow::audio::release(second);
+    mixer.wait_for_decoded_size(0);
+
+    ASSERT_EQ(mixer.decoded_size(), 0U);
+}
+
+TEST(CubebMixerTest, MapsCookedSounds)
+{
+    ScopedAssetsDirectory scoped_assets{"AudioTest"};
+
+    TestMixer mixer;
+    ASSERT_TRUE(mixer.initialize(kMaxAudioChannels));
+
+    auto sound = rainbow::audio::load_sound(kCookedTestFile);
+
+    ASSERT_EQ(mixer.decoded_size(), 0U);
+
+    auto channel = rainbow::audio::play(sound);
+
+    ASSERT_PRED1(rainbow::audio::is_playing, channel);
+    ASSERT_EQ(mixer.decoded_size(), 0U);
+
+    rainbow::audio::release(sound);
+}
+
+TEST(CubebMixerTest, LoopsStreamsDecodedToTheEnd)
+{
+    ScopedAssetsDirectory scoped_assets{"AudioTest"};
+
+    TestMixer mixer;
+    ASSERT_TRUE(mixer.initialize(kMaxAudioChannels));
+
+    // Keep the channel from finishing while we're looking at it.
+    auto stream = rainbow::audio::load_stream(kAudioTestFile);
+    auto channel = rainbow::audio::play(stream);
+    rainbow::audio::pause(channel);
+
+    // The sound is short enough to be decoded to the end right away.
+    mixer.wait_until([channel] { return channel->end_of_stream.load(); });
+
+    ASSERT_TRUE(channel->end_of_stream);
+
+    rainbow::audio::set_loop_count(channel, 1);
+
+    ASSERT_FALSE(channel->end_of_stream);
+
+    mixer.wait_until([channel] { return channel->loop_count == 0; });
+
+    ASSERT_EQ(channel->loop_count, 0);
+    ASSERT_PRED1(rainbow::audio::is_paused, channel);
+
+    rainbow::audio::stop(channel);
+    rainbow::audio::release(stream);
+}
+#endif  // !RAINBOW_AUDIO_AL && !RAINBOW_AUDIO_FMOD
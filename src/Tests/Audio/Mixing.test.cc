@@ -0,0 +1,128 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Audio/Mixing.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using rainbow::audio::kOutputChannels;
+using rainbow::audio::Resampler;
+
+TEST(MixingTest, ClampsSamples)
+{
+    std::vector<float> samples{
+        -2.0F, -1.0F, -0.5F, 0.0F, 0.5F, 1.0F, 1.5F, 3.0F, -1.25F};
+    rainbow::audio::clamp(samples.data(), samples.size());
+
+    const std::vector<float> expected{
+        -1.0F, -1.0F, -0.5F, 0.0F, 0.5F, 1.0F, 1.0F, 1.0F, -1.0F};
+    ASSERT_EQ(samples, expected);
+}
+
+TEST(MixingTest, AddsScaledSamples)
+{
+    constexpr size_t kCount = 19;  // Exercise both vector and scalar paths
+
+    std::vector<int16_t> samples(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+        samples[i] = static_cast<int16_t>((i % 2 == 0 ? -1 : 1) * i * 1700);
+    samples[0] = -32768;
+    samples[1] = 32767;
+
+    std::vector<float> out(kCount, 0.25F);
+    rainbow::audio::mix(out.data(), samples.data(), kCount, 0.5F);
+
+    for (size_t i = 0; i < kCount; ++i)
+        ASSERT_FLOAT_EQ(out[i], 0.25F + samples[i] * 0.5F / 32768.0F);
+}
+
+TEST(MixingTest, PassesThroughStereoAtSameRate)
+{
+    const std::vector<int16_t> in{1, -1, 2, -2, 3, -3, 4, -4, 5, -5};
+
+    Resampler resampler;
+    resampler.reset(2, 44100, 44100);
+
+    std::vector<int16_t> out(in.size());
+    size_t consumed = 0;
+    const auto written =
+        resampler.process(in.data(), 5, consumed, out.data(), 5);
+
+    ASSERT_EQ(consumed, 5U);
+
+    // The last frame is held back until the next one is known.
+    ASSERT_EQ(written, 4U);
+    for (size_t i = 0; i < written * kOutputChannels; ++i)
+        ASSERT_EQ(out[i], in[i]);
+}
+
+TEST(MixingTest, DuplicatesMonoChannel)
+{
+    const std::vector<int16_t> in{100, 200, 300, 400};
+
+    Resampler resampler;
+    resampler.reset(1, 22050, 22050);
+
+    std::vector<int16_t> out(in.size() * kOutputChannels);
+    size_t consumed = 0;
+    const auto written =
+        resampler.process(in.data(), in.size(), consumed, out.data(), 4);
+
+    ASSERT_EQ(written, 3U);
+    for (size_t i = 0; i < written; ++i)
+    {
+        ASSERT_EQ(out[i * 2], in[i]);
+        ASSERT_EQ(out[i * 2 + 1], in[i]);
+    }
+}
+
+TEST(MixingTest, InterpolatesWhenUpsampling)
+{
+    const std::vector<int16_t> in{0, 100, 200, 300};
+
+    Resampler resampler;
+    resampler.reset(1, 22050, 44100);
+
+    std::vector<int16_t> out(16);
+    size_t consumed = 0;
+    const auto written =
+        resampler.process(in.data(), in.size(), consumed, out.data(), 8);
+
+    ASSERT_EQ(consumed, in.size());
+    ASSERT_EQ(written, 6U);
+
+    const int16_t expected[]{0, 50, 100, 150, 200, 250};
+    for (size_t i = 0; i < written; ++i)
+        ASSERT_EQ(out[i * 2], expected[i]);
+}
+
+TEST(MixingTest, ContinuesAcrossBuffers)
+{
+    const std::vector<int16_t> in{0, 100, 200, 300, 400, 500, 600};
+
+    Resampler resampler;
+    resampler.reset(1, 44100, 44100);
+
+    std::vector<int16_t> out(in.size() * kOutputChannels);
+    size_t written = 0;
+    size_t offset = 0;
+    while (offset < in.size())
+    {
+        const auto count = std::min<size_t>(2, in.size() - offset);
+        size_t consumed = 0;
+        written += resampler.process(in.data() + offset,
+                                     count,
+                                     consumed,
+                                     out.data() + written * kOutputChannels,
+                                     in.size() - written);
+        offset += consumed;
+    }
+
+    ASSERT_EQ(written, in.size() - 1);
+    for (size_t i = 0; i < written; ++i)
+        ASSERT_EQ(out[i * 2], in[i]);
+}
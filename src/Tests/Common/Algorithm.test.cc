@@ -90,6 +90,17 @@ TEST(AlgorithmTest, RoundsDownToNearestPowerOfTwo)
     }
 }
 
+TEST(AlgorithmTest, HashesBytesWithFNV1a)
+{
+    constexpr uint8_t kEmpty[]{0};
+    constexpr uint8_t kA[]{'a'};
+    constexpr uint8_t kFoobar[]{'f', 'o', 'o', 'b', 'a', 'r'};
+
+    ASSERT_EQ(rainbow::fnv1a(kEmpty, 0), 0xcbf29ce484222325U);
+    ASSERT_EQ(rainbow::fnv1a(kA, sizeof(kA)), 0xaf63dc4c8601ec8cU);
+    ASSERT_EQ(rainbow::fnv1a(kFoobar, sizeof(kFoobar)), 0x85944171f73967e8U);
+}
+
 TEST(AlgorithmTest, ApproximatesZeroFloat)
 {
     auto definitely_not_zero = std::not_fn(rainbow::is_almost_zero);
@@ -0,0 +1,219 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Cooker/Cooker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+#include "Audio/Codecs/PcmAudioFile.h"
+#include "Common/Data.h"
+#include "Cooker/Formats.h"
+#include "Graphics/Image.h"
+#include "Graphics/PixelFormat.h"
+#include "Text/SystemFonts.h"
+#include "Tests/__fixtures/ImageTest/Images.h"
+
+using rainbow::Data;
+using rainbow::Image;
+using rainbow::audio::IAudioFile;
+using rainbow::audio::PcmAudioFile;
+using rainbow::cooker::GlyphAtlasHeader;
+using rainbow::cooker::GlyphRecord;
+using rainbow::cooker::TextureHeader;
+using rainbow::graphics::Dithering;
+using rainbow::graphics::PixelFormat;
+
+namespace
+{
+    constexpr int kChannels = 2;
+    constexpr int kFrames = 100;
+    constexpr int kRate = 22050;
+
+    template <typename T>
+    auto as_data(const T& container)
+    {
+        return Data{
+            container.data(), container.size(), Data::Ownership::Reference};
+    }
+
+    auto sample(size_t i) { return static_cast<int16_t>(i * 3); }
+
+    /// <summary>Generates a ramp, one sample at a time.</summary>
+    class RampAudioFile final : public IAudioFile
+    {
+    public:
+        auto channels() const -> int override { return kChannels; }
+        auto rate() const -> int override { return kRate; }
+
+        auto size() const -> size_t override
+        {
+            return kFrames * kChannels * sizeof(int16_t);
+        }
+
+        auto read(void* dst, size_t size) -> size_t override
+        {
+            auto out = static_cast<int16_t*>(dst);
+            const auto count = std::min(size / sizeof(int16_t),
+                                        kFrames * kChannels - position_);
+            for (size_t i = 0; i < count; ++i)
+                out[i] = sample(position_++);
+            return count * sizeof(int16_t);
+        }
+
+        bool seek(int64_t offset) override
+        {
+            position_ = offset / sizeof(int16_t);
+            return true;
+        }
+
+        explicit operator bool() const override { return true; }
+
+    private:
+        size_t position_ = 0;
+    };
+}  // namespace
+
+TEST(CookerTest, CooksTextures)
+{
+    const auto png = as_data(rainbow::test::fixtures::basn6a08_png);
+    const auto expected = Image::decode(png, 1.0F);
+    const auto blob = rainbow::cooker::cook_texture(
+        png, PixelFormat::RGBA8888, Dithering::None);
+
+    ASSERT_EQ(blob.size(), sizeof(TextureHeader) + expected.size);
+
+    const auto cooked = as_data(blob);
+    const auto image = Image::decode(cooked, 1.0F);
+
+    ASSERT_EQ(image.format, Image::Format::RGBA);
+    ASSERT_EQ(image.width, 32U);
+    ASSERT_EQ(image.height, 32U);
+    ASSERT_EQ(image.depth, 32U);
+    ASSERT_EQ(image.channels, 4U);
+    ASSERT_EQ(image.size, expected.size);
+
+    // 8-bit RGBA is used in place.
+    ASSERT_EQ(image.data, blob.data() + sizeof(TextureHeader));
+    ASSERT_EQ(memcmp(image.data, expected.data, image.size), 0);
+
+    const auto downscaled = Image::decode(cooked, 0.5F);
+
+    ASSERT_EQ(downscaled.format, Image::Format::PNG);
+    ASSERT_EQ(downscaled.width, 16U);
+    ASSERT_EQ(downscaled.height, 16U);
+    ASSERT_NE(downscaled.data, image.data);
+}
+
+TEST(CookerTest, CooksTextures_16Bit)
+{
+    const auto png = as_data(rainbow::test::fixtures::basn6a08_png);
+    const auto expected = rainbow::graphics::convert(
+        Image::decode(png, 1.0F), PixelFormat::RGBA5551, Dithering::None);
+    const auto blob = rainbow::cooker::cook_texture(
+        png, PixelFormat::RGBA5551, Dithering::None);
+    const auto image = Image::decode(as_data(blob), 1.0F);
+
+    ASSERT_EQ(image.format, Image::Format::RGBA5551);
+    ASSERT_EQ(image.width, 32U);
+    ASSERT_EQ(image.height, 32U);
+    ASSERT_EQ(image.depth, 16U);
+    ASSERT_EQ(image.size, 32U * 32U * 2U);
+    ASSERT_EQ(memcmp(image.data, expected.data, image.size), 0);
+}
+
+TEST(CookerTest, CooksTextures_Grayscale)
+{
+    const auto png = as_data(rainbow::test::fixtures::basn4a08_png);
+    const auto expected = Image::decode(png, 1.0F);
+    const auto blob = rainbow::cooker::cook_texture(
+        png, PixelFormat::RGBA4444, Dithering::None);
+    const auto image = Image::decode(as_data(blob), 1.0F);
+
+    ASSERT_EQ(image.format, Image::Format::PNG);
+    ASSERT_EQ(image.width, 32U);
+    ASSERT_EQ(image.height, 32U);
+    ASSERT_EQ(image.depth, 16U);
+    ASSERT_EQ(image.channels, 2U);
+    ASSERT_EQ(memcmp(image.data, expected.data, image.size), 0);
+}
+
+TEST(CookerTest, RejectsTruncatedTextures)
+{
+    const auto png = as_data(rainbow::test::fixtures::basn6a08_png);
+    auto blob = rainbow::cooker::cook_texture(
+        png, PixelFormat::RGBA8888, Dithering::None);
+    blob.pop_back();
+
+    const auto image = Image::decode(as_data(blob), 1.0F);
+
+    ASSERT_EQ(image.data, nullptr);
+}
+
+TEST(CookerTest, CooksPCM)
+{
+    RampAudioFile sound;
+    const auto blob = rainbow::cooker::cook_pcm(sound);
+    PcmAudioFile pcm{as_data(blob)};
+
+    ASSERT_TRUE(pcm);
+    ASSERT_EQ(pcm.channels(), kChannels);
+    ASSERT_EQ(pcm.rate(), kRate);
+    ASSERT_EQ(pcm.size(), sound.size());
+
+    int16_t samples[kFrames * kChannels];
+    ASSERT_EQ(pcm.read(samples, sizeof(samples)), sizeof(samples));
+    for (size_t i = 0; i < std::size(samples); ++i)
+        ASSERT_EQ(samples[i], sample(i));
+}
+
+TEST(CookerTest, BakesGlyphAtlases)
+{
+    const auto font = rainbow::text::monospace_font();
+    if (!font)
+        return;  // There is no system font to bake from.
+
+    const int kFontSizes[]{12, 24};
+    const uint32_t kCodePoints[]{'A', 'B', 'C'};
+    const auto blob =
+        rainbow::cooker::bake_glyph_atlas(font, kFontSizes, kCodePoints);
+    const auto header =
+        rainbow::cooker::header_of<GlyphAtlasHeader>(blob.data(), blob.size());
+
+    ASSERT_NE(header, nullptr);
+    ASSERT_EQ(header->glyph_count, 6U);
+    ASSERT_LE(header->width, 1024);
+    ASSERT_LE(header->height, 1024);
+    ASSERT_EQ(blob.size(),
+              sizeof(GlyphAtlasHeader) + sizeof(GlyphRecord) * 6 +
+                  header->width * header->height);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto records = reinterpret_cast<const GlyphRecord*>(header + 1);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto pixels = reinterpret_cast<const uint8_t*>(records + 6);
+    for (int i = 0; i < 6; ++i)
+    {
+        const auto& record = records[i];
+
+        ASSERT_TRUE(record.font_size == 12 || record.font_size == 24);
+        ASSERT_GT(record.width, 0);
+        ASSERT_GT(record.height, 0);
+        ASSERT_LE(record.x + record.width, header->width);
+        ASSERT_LE(record.y + record.height, header->height);
+
+        int coverage = 0;
+        for (int y = 0; y < record.height; ++y)
+        {
+            auto row = pixels + (record.y + y) * header->width + record.x;
+            coverage += std::count_if(
+                row, row + record.width, [](uint8_t a) { return a > 0; });
+        }
+
+        ASSERT_GT(coverage, 0);
+    }
+}
@@ -0,0 +1,188 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "FileSystem/AssetCache.h"
+
+#include <cstring>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "FileSystem/FileSystem.h"
+#include "Tests/TestHelpers.h"
+
+using rainbow::AssetCache;
+using rainbow::Data;
+using rainbow::FileType;
+using rainbow::test::ScopedAssetsDirectory;
+
+namespace
+{
+    constexpr char kContent[] = "0123456789";
+    constexpr char kOtherContent[] = "9876543210";
+
+    auto make_data(size_t size)
+    {
+        auto buffer = std::make_unique<uint8_t[]>(size);  // NOLINT
+        return Data{buffer.release(), size, Data::Ownership::Owner};
+    }
+}  // namespace
+
+TEST(AssetCacheTest, ProducesAssetsOnce)
+{
+    AssetCache cache{1024};
+
+    const auto key = AssetCache::key_of(Data::from_literal(kContent));
+    int produced = 0;
+    auto produce = [&produced] {
+        ++produced;
+        return make_data(16);
+    };
+
+    const auto first = cache.get<Data>(key, produce);
+    const auto second = cache.get<Data>(key, produce);
+
+    ASSERT_EQ(produced, 1);
+    ASSERT_EQ(first, second);
+    ASSERT_EQ(cache.count(), 1U);
+    ASSERT_EQ(cache.size(), 16U);
+}
+
+TEST(AssetCacheTest, KeysOnContentAndParameters)
+{
+    const auto key = AssetCache::key_of(Data::from_literal(kContent));
+
+    ASSERT_EQ(key, AssetCache::key_of(Data::from_literal(kContent)));
+    ASSERT_FALSE(key == AssetCache::key_of(Data::from_literal(kContent), 1));
+    ASSERT_FALSE(key == AssetCache::key_of(Data::from_literal(kOtherContent)));
+}
+
+TEST(AssetCacheTest, EvictsLeastRecentlyUsedAssetsOverBudget)
+{
+    AssetCache cache{32};
+
+    const auto first = AssetCache::key_of(Data::from_literal(kContent), 1);
+    const auto second = AssetCache::key_of(Data::from_literal(kContent), 2);
+    const auto third = AssetCache::key_of(Data::from_literal(kContent), 3);
+
+    int produced = 0;
+    auto produce = [&produced] {
+        ++produced;
+        return make_data(16);
+    };
+
+    [[maybe_unused]] auto asset = cache.get<Data>(first, produce);
+    asset = cache.get<Data>(second, produce);
+    asset = cache.get<Data>(first, produce);  // `second` is now least recent
+    asset.reset();
+
+    [[maybe_unused]] auto held = cache.get<Data>(third, produce);
+
+    ASSERT_EQ(produced, 3);
+    ASSERT_EQ(cache.count(), 2U);
+    ASSERT_EQ(cache.size(), 32U);
+
+    asset = cache.get<Data>(first, produce);
+
+    ASSERT_EQ(produced, 3);
+
+    asset = cache.get<Data>(second, produce);
+
+    ASSERT_EQ(produced, 4);
+}
+
+TEST(AssetCacheTest, NeverEvictsAssetsInUse)
+{
+    AssetCache cache{16};
+
+    const auto first = AssetCache::key_of(Data::from_literal(kContent));
+    const auto second = AssetCache::key_of(Data::from_literal(kOtherContent));
+
+    const auto a = cache.get<Data>(first, [] { return make_data(16); });
+    const auto b = cache.get<Data>(second, [] { return make_data(16); });
+
+    ASSERT_EQ(cache.count(), 2U);
+    ASSERT_EQ(cache.size(), 32U);
+
+    cache.purge();
+
+    ASSERT_EQ(cache.count(), 2U);
+}
+
+TEST(AssetCacheTest, PurgesUnusedAssets)
+{
+    AssetCache cache{1024};
+
+    const auto first = AssetCache::key_of(Data::from_literal(kContent));
+    const auto second = AssetCache::key_of(Data::from_literal(kOtherContent));
+
+    const auto held = cache.get<Data>(first, [] { return make_data(16); });
+    std::weak_ptr<const Data> released =
+        cache.get<Data>(second, [] { return make_data(16); });
+
+    ASSERT_FALSE(released.expired());
+
+    cache.purge();
+
+    ASSERT_TRUE(released.expired());
+    ASSERT_EQ(cache.count(), 1U);
+    ASSERT_EQ(cache.size(), 16U);
+}
+
+TEST(AssetCacheTest, SharesFilesWithIdenticalContents)
+{
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    AssetCache cache{1024};
+
+    const auto file = cache.load("file", FileType::Asset);
+
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(file->size(), 10U);
+    ASSERT_EQ(file, cache.load("file", FileType::Asset));
+    ASSERT_EQ(cache.load("does not exist", FileType::Asset), nullptr);
+    ASSERT_EQ(cache.count(), 1U);
+}
+
+TEST(AssetCacheTest, RemembersFilesUntilInvalidated)
+{
+    constexpr char kTestFile[] = "AssetCacheTest.dat";
+
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    AssetCache cache{1024};
+
+    ASSERT_TRUE(rainbow::filesystem::write_atomically(
+        kTestFile, Data::from_literal(kContent)));
+
+    auto file = cache.load(kTestFile, FileType::UserFile);
+
+    ASSERT_NE(file, nullptr);
+
+    // The file is not read again while its contents are cached...
+    ASSERT_TRUE(rainbow::filesystem::write_atomically(
+        kTestFile, Data::from_literal(kOtherContent)));
+    ASSERT_EQ(cache.load(kTestFile, FileType::UserFile), file);
+
+    // ... unless it was modified...
+    cache.invalidate(kTestFile);
+    file = cache.load(kTestFile, FileType::UserFile);
+
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(memcmp(file->bytes(), kOtherContent, file->size()), 0);
+
+    // ... or its contents were evicted.
+    file.reset();
+    cache.purge();
+
+    ASSERT_EQ(cache.count(), 0U);
+    ASSERT_TRUE(rainbow::filesystem::write_atomically(
+        kTestFile, Data::from_literal(kContent)));
+
+    file = cache.load(kTestFile, FileType::UserFile);
+
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(memcmp(file->bytes(), kContent, file->size()), 0);
+    ASSERT_TRUE(rainbow::filesystem::remove(kTestFile));
+}
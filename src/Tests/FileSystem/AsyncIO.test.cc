@@ -0,0 +1,281 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "FileSystem/AsyncIO.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "FileSystem/FileSystem.h"
+#include "Tests/TestHelpers.h"
+
+using rainbow::AsyncIO;
+using rainbow::Data;
+using rainbow::File;
+using rainbow::FileType;
+using rainbow::IOPriority;
+using rainbow::test::ScopedAssetsDirectory;
+
+namespace
+{
+    constexpr char kTestFile[] = "file";
+    constexpr char kTestFileContents[] = "0123456789";
+
+    void wait_for(AsyncIO& io)
+    {
+        for (int i = 0; io.pending() > 0 && i < 1000; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            io.update();
+        }
+    }
+}  // namespace
+
+TEST(AsyncIOTest, ReadsFilesOnMainThread)
+{
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    AsyncIO io{2};
+    const auto main_thread = std::this_thread::get_id();
+
+    bool called = false;
+    const auto id = io.read(
+        kTestFile, FileType::Asset, IOPriority::Normal, [&](Data data) {
+            called = true;
+
+            ASSERT_EQ(std::this_thread::get_id(), main_thread);
+            ASSERT_EQ(data.size(), 10U);
+            ASSERT_EQ(memcmp(data.bytes(), kTestFileContents, data.size()), 0);
+        });
+
+    ASSERT_NE(id, 0U);
+
+    // Completions are only ever delivered by `update()`.
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    ASSERT_FALSE(called);
+
+    wait_for(io);
+
+    ASSERT_TRUE(called);
+    ASSERT_EQ(io.pending(), 0U);
+}
+
+TEST(AsyncIOTest, DeliversEmptyBufferOnFailure)
+{
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    AsyncIO io{1};
+
+    bool called = false;
+    io.read("does not exist",
+            FileType::Asset,
+            IOPriority::Normal,
+            [&called](Data data) {
+                called = true;
+                ASSERT_FALSE(data);
+            });
+    wait_for(io);
+
+    ASSERT_TRUE(called);
+}
+
+TEST(AsyncIOTest, ServesRequestsInOrderOfPriority)
+{
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    // Without threads, requests are only served during `update()`.
+    AsyncIO io{0};
+
+    std::vector<int> order;
+    auto push = [&order](int i) {
+        return [&order, i](Data) { order.push_back(i); };
+    };
+    io.read(kTestFile, FileType::Asset, IOPriority::Low, push(0));
+    io.read(kTestFile, FileType::Asset, IOPriority::Normal, push(1));
+    io.read(kTestFile, FileType::Asset, IOPriority::High, push(2));
+    io.read(kTestFile, FileType::Asset, IOPriority::Normal, push(3));
+
+    ASSERT_EQ(io.pending(), 4U);
+    ASSERT_TRUE(order.empty());
+
+    io.update();
+
+    ASSERT_EQ(order, (std::vector<int>{2, 1, 3, 0}));
+    ASSERT_EQ(io.pending(), 0U);
+}
+
+TEST(AsyncIOTest, CancelsPendingRequests)
+{
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    AsyncIO io{0};
+
+    int count = 0;
+    auto callback = [&count](Data) { ++count; };
+    const auto first =
+        io.read(kTestFile, FileType::Asset, IOPriority::Normal, callback);
+    io.read(kTestFile, FileType::Asset, IOPriority::Normal, callback);
+    io.read(kTestFile, FileType::Asset, IOPriority::Normal, callback);
+
+    ASSERT_TRUE(io.cancel(first));
+    ASSERT_FALSE(io.cancel(first));
+
+    io.update();
+
+    ASSERT_EQ(count, 2);
+
+    io.read(kTestFile, FileType::Asset, IOPriority::Normal, callback);
+    io.clear();
+    io.update();
+
+    ASSERT_EQ(count, 2);
+    ASSERT_EQ(io.pending(), 0U);
+}
+
+TEST(AsyncIOTest, WritesFiles)
+{
+    constexpr char kOutputFile[] = "AsyncIOTest.dat";
+
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    AsyncIO io{1};
+
+    bool written = false;
+    io.write(kOutputFile,
+             Data::from_literal(kTestFileContents),
+             IOPriority::High,
+             [&written](bool success) { written = success; });
+    wait_for(io);
+
+    ASSERT_TRUE(written);
+
+    const auto data = File::read(kOutputFile, FileType::UserFile);
+
+    ASSERT_EQ(data.size(), 10U);
+    ASSERT_EQ(memcmp(data.bytes(), kTestFileContents, data.size()), 0);
+    ASSERT_TRUE(rainbow::filesystem::remove(kOutputFile));
+}
+
+TEST(AsyncIOTest, WritesSnapshotOfBuffer)
+{
+    constexpr char kOutputFile[] = "AsyncIOTest.dat";
+
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    AsyncIO io{1};
+
+    char buffer[] = "0123456789";
+    bool written = false;
+    io.write(kOutputFile,
+             buffer,
+             10,
+             IOPriority::High,
+             [&written](bool success) { written = success; });
+
+    // The buffer may be reused as soon as the request has been made.
+    memset(buffer, 'x', sizeof(buffer));
+    wait_for(io);
+
+    ASSERT_TRUE(written);
+
+    const auto data = File::read(kOutputFile, FileType::UserFile);
+
+    ASSERT_EQ(data.size(), 10U);
+    ASSERT_EQ(memcmp(data.bytes(), kTestFileContents, data.size()), 0);
+    ASSERT_TRUE(rainbow::filesystem::remove(kOutputFile));
+}
+
+TEST(AsyncIOTest, KeepsPendingWritesOnClear)
+{
+    constexpr char kOutputFile[] = "AsyncIOTest.dat";
+
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    AsyncIO io{0};
+
+    bool called = false;
+    io.write(kOutputFile,
+             Data::from_literal(kTestFileContents),
+             IOPriority::Normal,
+             [&called](bool) { called = true; });
+    io.clear();
+    io.update();
+
+    // The write goes through, but the callback is dropped.
+    ASSERT_FALSE(called);
+    ASSERT_EQ(io.pending(), 0U);
+
+    const auto data = File::read(kOutputFile, FileType::UserFile);
+
+    ASSERT_EQ(data.size(), 10U);
+    ASSERT_EQ(memcmp(data.bytes(), kTestFileContents, data.size()), 0);
+    ASSERT_TRUE(rainbow::filesystem::remove(kOutputFile));
+}
+
+TEST(AsyncIOTest, CompletesPendingWritesOnDestruction)
+{
+    constexpr char kOutputFile[] = "AsyncIOTest.dat";
+
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    {
+        AsyncIO io{0};
+        io.write(kOutputFile,
+                 Data::from_literal(kTestFileContents),
+                 IOPriority::Normal,
+                 nullptr);
+    }
+
+    const auto data = File::read(kOutputFile, FileType::UserFile);
+
+    ASSERT_EQ(data.size(), 10U);
+    ASSERT_EQ(memcmp(data.bytes(), kTestFileContents, data.size()), 0);
+    ASSERT_TRUE(rainbow::filesystem::remove(kOutputFile));
+}
+
+TEST(AsyncIOTest, WritesToSamePathInOrder)
+{
+    constexpr char kOutputFile[] = "AsyncIOTest.dat";
+
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    AsyncIO io{4};
+
+    // Later writes must win even when made with lower priority...
+    std::vector<int> order;
+    for (int i = 0; i < 16; ++i)
+    {
+        const char value = static_cast<char>('a' + i);
+        io.write(kOutputFile,
+                 &value,
+                 1,
+                 i % 2 == 0 ? IOPriority::Low : IOPriority::High,
+                 [&order, i](bool) { order.push_back(i); });
+    }
+
+    // ... and writes to other paths must not be held back by them.
+    bool other = false;
+    io.write("AsyncIOTest.other",
+             Data::from_literal(kTestFileContents),
+             IOPriority::Low,
+             [&other](bool success) { other = success; });
+    wait_for(io);
+
+    ASSERT_TRUE(other);
+    ASSERT_EQ(order.size(), 16U);
+    for (int i = 0; i < 16; ++i)
+        ASSERT_EQ(order[i], i);
+
+    const auto data = File::read(kOutputFile, FileType::UserFile);
+
+    ASSERT_EQ(data.size(), 1U);
+    ASSERT_EQ(data.bytes()[0], 'p');
+    ASSERT_TRUE(rainbow::filesystem::remove(kOutputFile));
+    ASSERT_TRUE(rainbow::filesystem::remove("AsyncIOTest.other"));
+}
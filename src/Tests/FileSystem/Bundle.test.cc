@@ -111,6 +111,21 @@ TEST(BundleTest, WithZipFile)
     ASSERT_EQ(bundle.main_script(), nullptr);
 }
 
+TEST(BundleTest, WithPackFile)
+{
+    std::string executable = "rainbow";
+    auto directory = fixture_path("PackTest");
+    std::string assets_path = (directory / "assets.rpk").c_str();
+
+    zstring args[2]{executable.data(), assets_path.data()};
+    const Bundle bundle(args);
+    auto cwd = sys::current_path();
+
+    ASSERT_STREQ(bundle.assets_path(), assets_path.c_str());
+    ASSERT_EQ(bundle.exec_path(), cwd + fs::path_separator() + executable);
+    ASSERT_EQ(bundle.main_script(), nullptr);
+}
+
 TEST(BundleTest, IsMovable)
 {
     std::string executable = "rainbow";
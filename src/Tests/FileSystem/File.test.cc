@@ -4,6 +4,8 @@
 
 #include "FileSystem/File.h"
 
+#include <cstring>
+
 #include <gtest/gtest.h>
 
 #include "Common/TypeCast.h"
@@ -99,6 +101,25 @@ TEST(FileTest, HandlesNonExistingFiles)
     ScopedAssetsDirectory scoped_assets{"FileTest_HandlesEmptyFiles"};
     ASSERT_FALSE(File::open("this file does not exist", FileType::Asset));
     ASSERT_FALSE(File::read("this file does not exist", FileType::Asset));
+    ASSERT_FALSE(File::map("this file does not exist", FileType::Asset));
+    ASSERT_FALSE(File::map("empty.dat", FileType::Asset));
+}
+
+TEST(FileTest, MapsFilesOnDisk)
+{
+    ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    const auto data = File::map("file", FileType::Asset);
+
+    ASSERT_TRUE(data);
+    ASSERT_TRUE(data.is_mapped());
+    ASSERT_EQ(data.size(), 10U);
+    ASSERT_EQ(memcmp(data.bytes(), "0123456789", data.size()), 0);
+
+    const auto copy = File::read("file", FileType::Asset);
+
+    ASSERT_FALSE(copy.is_mapped());
+    ASSERT_EQ(copy.size(), data.size());
 }
 
 TEST(FileTest, SupportsPlatformImplementation)
@@ -7,7 +7,10 @@
 #include <cstring>
 
 #include <gtest/gtest.h>
+#include <physfs.h>
 
+#include "Common/Data.h"
+#include "FileSystem/File.h"
 #include "Tests/TestHelpers.h"
 
 #ifdef RAINBOW_OS_WINDOWS
@@ -22,6 +25,9 @@
 namespace fs = rainbow::filesystem;
 namespace sys = rainbow::system;
 
+using rainbow::Data;
+using rainbow::File;
+using rainbow::FileType;
 using rainbow::test::ScopedAssetsDirectory;
 
 TEST(FileSystemTest, CreatesDirectories)
@@ -82,6 +88,37 @@ TEST(FileSystemTest, ReturnsRealPath)
     ASSERT_EQ(full_path, scoped_assets.path() / "empty.dat");
 }
 
+TEST(FileSystemTest, WritesFilesAtomically)
+{
+    constexpr char kTestFile[] = "FileSystemTest_WritesFilesAtomically.dat";
+
+    ScopedAssetsDirectory scoped_assets{"FileSystemTest"};
+
+    ASSERT_TRUE(fs::write_atomically(kTestFile, Data::from_literal("0123")));
+
+    const auto data = File::read(kTestFile, FileType::UserFile);
+
+    ASSERT_EQ(data.size(), 4U);
+    ASSERT_EQ(memcmp(data.bytes(), "0123", data.size()), 0);
+
+    ASSERT_TRUE(
+        fs::write_atomically(kTestFile, Data::from_literal("abcdefgh")));
+
+    const auto replaced = File::read(kTestFile, FileType::UserFile);
+
+    ASSERT_EQ(replaced.size(), 8U);
+    ASSERT_EQ(memcmp(replaced.bytes(), "abcdefgh", replaced.size()), 0);
+
+    // No temporary files should be left behind.
+    auto files = PHYSFS_enumerateFiles("");
+    for (auto i = files; *i != nullptr; ++i)
+        ASSERT_FALSE(rainbow::ends_with(*i, ".tmp")) << *i;
+    PHYSFS_freeList(files);
+
+    ASSERT_TRUE(fs::remove(kTestFile));
+    ASSERT_FALSE(fs::write_atomically("", Data::from_literal("0123")));
+}
+
 TEST(FileSystemTest, SystemReturnsCurrentPath)
 {
     char cwd[256];
@@ -0,0 +1,198 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "FileSystem/Pack.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "FileSystem/File.h"
+#include "FileSystem/MappedFile.h"
+#include "Tests/TestHelpers.h"
+
+using rainbow::Data;
+using rainbow::File;
+using rainbow::FileType;
+using rainbow::MappedFile;
+using rainbow::pack::Compression;
+using rainbow::pack::Reader;
+using rainbow::test::fixture_path;
+using rainbow::test::ScopedAssetsDirectory;
+
+namespace
+{
+    constexpr char kHello[] = "Hello, Rainbow!\n";
+    constexpr char kReadme[] = "Level data\n";
+
+    auto open_fixture()
+    {
+        const auto path = fixture_path("PackTest/assets.rpk");
+        return Reader{MappedFile::open(path.string().c_str()).release()};
+    }
+
+    auto map_txt()
+    {
+        std::string map;
+        for (int i = 0; i < 64; ++i)
+            map += "rainbow ";
+        return map;
+    }
+}  // namespace
+
+TEST(PackTest, DecompressesLZ4Blocks)
+{
+    // "abc", then a 9-byte match overlapping itself, then "xyzzy".
+    constexpr uint8_t kBlock[]{
+        0x35, 'a', 'b', 'c', 0x03, 0x00, 0x50, 'x', 'y', 'z', 'z', 'y'};
+    constexpr char kExpected[] = "abcabcabcabcxyzzy";
+
+    uint8_t buffer[sizeof(kExpected) - 1];
+    ASSERT_TRUE(rainbow::pack::lz4_decompress(
+        kBlock, sizeof(kBlock), buffer, sizeof(buffer)));
+    ASSERT_EQ(memcmp(buffer, kExpected, sizeof(buffer)), 0);
+
+    // Output must be filled exactly.
+    ASSERT_FALSE(rainbow::pack::lz4_decompress(
+        kBlock, sizeof(kBlock), buffer, sizeof(buffer) - 1));
+
+    // Truncated blocks are rejected.
+    ASSERT_FALSE(
+        rainbow::pack::lz4_decompress(kBlock, 5, buffer, sizeof(buffer)));
+
+    // Matches must not reach before the start of the output.
+    constexpr uint8_t kBadOffset[]{0x10, 'a', 0x02, 0x00, 0x50, 1, 2, 3, 4, 5};
+    ASSERT_FALSE(rainbow::pack::lz4_decompress(
+        kBadOffset, sizeof(kBadOffset), buffer, sizeof(buffer)));
+}
+
+TEST(PackTest, FindsEntries)
+{
+    const auto pack = open_fixture();
+    ASSERT_TRUE(pack);
+
+    auto hello = pack.find("hello.txt");
+    ASSERT_NE(hello, nullptr);
+    ASSERT_EQ(pack.name(*hello), "hello.txt");
+    ASSERT_EQ(hello->compression, Compression::None);
+    ASSERT_EQ(hello->size, sizeof(kHello) - 1);
+    ASSERT_EQ(memcmp(pack.view(*hello), kHello, hello->size), 0);
+
+    auto readme = pack.find("levels/readme.txt");
+    ASSERT_NE(readme, nullptr);
+    ASSERT_EQ(readme->size, sizeof(kReadme) - 1);
+
+    ASSERT_EQ(pack.find("levels"), nullptr);
+    ASSERT_EQ(pack.find("levels/1/map"), nullptr);
+    ASSERT_EQ(pack.find("/hello.txt"), nullptr);
+    ASSERT_EQ(pack.find("this file does not exist"), nullptr);
+}
+
+TEST(PackTest, ReadsCompressedEntries)
+{
+    const auto pack = open_fixture();
+    const auto expected = map_txt();
+
+    auto map = pack.find("levels/1/map.txt");
+    ASSERT_NE(map, nullptr);
+    ASSERT_EQ(map->compression, Compression::LZ4);
+    ASSERT_LT(map->stored_size, map->size);
+    ASSERT_EQ(map->size, expected.size());
+    ASSERT_EQ(pack.view(*map), nullptr);
+
+    std::vector<uint8_t> buffer(map->size);
+    ASSERT_TRUE(pack.read(*map, buffer.data()));
+    ASSERT_EQ(memcmp(buffer.data(), expected.data(), buffer.size()), 0);
+}
+
+TEST(PackTest, EnumeratesDirectories)
+{
+    const auto pack = open_fixture();
+
+    ASSERT_TRUE(pack.is_directory(""));
+    ASSERT_TRUE(pack.is_directory("levels"));
+    ASSERT_TRUE(pack.is_directory("levels/1"));
+    ASSERT_FALSE(pack.is_directory("levels/readme.txt"));
+    ASSERT_FALSE(pack.is_directory("lev"));
+
+    std::vector<std::string> names;
+    auto collect = [&names](std::string_view name) {
+        names.emplace_back(name);
+        return true;
+    };
+
+    ASSERT_TRUE(pack.enumerate("", collect));
+    ASSERT_EQ(names, (std::vector<std::string>{"hello.txt", "levels"}));
+
+    names.clear();
+    ASSERT_TRUE(pack.enumerate("levels", collect));
+    ASSERT_EQ(names, (std::vector<std::string>{"readme.txt", "1"}));
+
+    ASSERT_FALSE(pack.enumerate("", [](std::string_view) { return false; }));
+}
+
+TEST(PackTest, RejectsInvalidPacks)
+{
+    constexpr char kNotAPack[] = "PK\3\4 This is not a Rainbow pack, is it?";
+    const Reader not_a_pack{Data::from_literal(kNotAPack)};
+
+    ASSERT_FALSE(not_a_pack);
+    ASSERT_EQ(not_a_pack.find("hello.txt"), nullptr);
+    ASSERT_FALSE(not_a_pack.is_directory(""));
+
+    // Cut the fixture off in the middle of its table of contents.
+    const auto path = fixture_path("PackTest/assets.rpk");
+    const auto file = MappedFile::open(path.string().c_str());
+    const Reader truncated{
+        Data{file.data(), 0x90, Data::Ownership::Reference}};
+
+    ASSERT_FALSE(truncated);
+}
+
+TEST(PackTest, MountsInFileSystem)
+{
+    ScopedAssetsDirectory scoped_assets{"PackTest/assets.rpk"};
+
+    ASSERT_TRUE(rainbow::filesystem::exists("hello.txt"));
+    ASSERT_TRUE(rainbow::filesystem::is_directory("levels/1"));
+    ASSERT_TRUE(rainbow::filesystem::is_regular_file("levels/1/map.txt"));
+
+    const auto hello = File::read("hello.txt", FileType::Asset);
+    ASSERT_EQ(hello.size(), sizeof(kHello) - 1);
+    ASSERT_STREQ(hello.as<const char*>(), kHello);
+
+    const auto expected = map_txt();
+    const auto map = File::read("levels/1/map.txt", FileType::Asset);
+    ASSERT_EQ(map.size(), expected.size());
+    ASSERT_EQ(map.as<const char*>(), expected);
+
+    auto file = File::open("levels/readme.txt", FileType::Asset);
+    ASSERT_TRUE(file);
+    ASSERT_TRUE(file.seek(6));
+
+    char data[5]{};
+    ASSERT_EQ(file.read(data, 4), 4U);
+    ASSERT_STREQ(data, "data");
+}
+
+TEST(PackTest, MapsUncompressedEntriesWithoutCopying)
+{
+    ScopedAssetsDirectory scoped_assets{"PackTest/assets.rpk"};
+
+    const auto hello = File::map("hello.txt", FileType::Asset);
+    ASSERT_EQ(hello.size(), sizeof(kHello) - 1);
+    ASSERT_EQ(memcmp(hello.bytes(), kHello, hello.size()), 0);
+
+    // Both point straight into the mounted pack.
+    const auto again = File::map("hello.txt", FileType::Asset);
+    ASSERT_EQ(again.bytes(), hello.bytes());
+
+    // Compressed entries are decompressed into memory.
+    const auto expected = map_txt();
+    const auto map = File::map("levels/1/map.txt", FileType::Asset);
+    ASSERT_EQ(map.size(), expected.size());
+    ASSERT_EQ(memcmp(map.bytes(), expected.data(), expected.size()), 0);
+}
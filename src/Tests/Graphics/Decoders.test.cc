@@ -2,10 +2,13 @@
 // Distributed under the MIT License.
 // (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "Common/Data.h"
 #include "Graphics/OpenGL.h"
+#include "ThirdParty/NanoSVG/NanoSVG.h"
 
 #ifdef GL_IMG_texture_compression_pvrtc
 #    define USE_PVRTC 1
@@ -65,6 +68,13 @@ TEST(DecodersTest, DetectsPVRTC)
 namespace svg
 {
     extern bool check(const Data& data);
+    extern void rasterize(NSVGimage* img,
+                          float scale,
+                          uint8_t* dst,
+                          int width,
+                          int height,
+                          int stride,
+                          int num_tiles);
 }
 
 TEST(DecodersTest, DetectsSVG)
@@ -75,3 +85,31 @@ TEST(DecodersTest, DetectsSVG)
     ASSERT_TRUE(svg::check(Data::from_bytes(kSVGSignature)));
     ASSERT_FALSE(svg::check(Data::from_bytes(kNotSVGSignature)));
 }
+
+TEST(DecodersTest, RasterizesSVGTilesSeamlessly)
+{
+    constexpr int kWidth = 32;
+    constexpr int kHeight = 256;
+    constexpr int kStride = kWidth * 4;
+
+    // Anti-aliased edges along the seams between four tiles.
+    char source[] =
+        R"(<svg width="32" height="256">)"
+        R"(<rect x="4.5" y="20.5" width="20" height="43.25" fill="#f80"/>)"
+        R"(<circle cx="16" cy="128" r="10.3" fill="#08f"/>)"
+        R"(<rect x="8" y="192.5" width="9.5" height="40" fill="#0f8"/>)"
+        R"(</svg>)";
+    auto image = nsvgParse(source, "px", 96.0F);
+
+    ASSERT_NE(image, nullptr);
+
+    std::vector<uint8_t> whole(kStride * kHeight);
+    svg::rasterize(image, 1.0F, whole.data(), kWidth, kHeight, kStride, 1);
+
+    std::vector<uint8_t> tiled(kStride * kHeight);
+    svg::rasterize(image, 1.0F, tiled.data(), kWidth, kHeight, kStride, 4);
+
+    nsvgDelete(image);
+
+    ASSERT_EQ(tiled, whole);
+}
@@ -0,0 +1,183 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/LabelBatch.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using rainbow::GlyphRange;
+using rainbow::SpriteVertex;
+using rainbow::detail::GlyphBatch;
+
+namespace
+{
+    /// <summary>
+    ///   Glyphs of a fake label. Each vertex is tagged with its label and
+    ///   glyph number so that it can be found in the batch.
+    /// </summary>
+    struct FakeLabel
+    {
+        std::vector<SpriteVertex> vertices;
+        std::vector<GlyphRange> ranges;
+        int font_size = 0;
+
+        FakeLabel(int id, std::vector<GlyphRange> glyph_ranges)
+            : ranges(std::move(glyph_ranges))
+        {
+            uint32_t count = 0;
+            for (auto&& range : ranges)
+                count = std::max(count, range.first + range.count);
+
+            vertices.resize(count * 4);
+            for (uint32_t i = 0; i < vertices.size(); ++i)
+            {
+                vertices[i].position.x = static_cast<float>(id);
+                vertices[i].position.y = static_cast<float>(i / 4);
+            }
+        }
+
+        [[nodiscard]] auto source() const -> GlyphBatch::Source
+        {
+            return {vertices, ranges, font_size};
+        }
+    };
+
+    auto sources_of(const std::vector<FakeLabel>& labels)
+    {
+        std::vector<GlyphBatch::Source> sources;
+        for (auto&& label : labels)
+            sources.push_back(label.source());
+        return sources;
+    }
+
+    /// <summary>
+    ///   Asserts that the glyphs <paramref name="range"/> of
+    ///   <paramref name="label"/> are at <paramref name="offset"/> (in
+    ///   glyphs) in the batch.
+    /// </summary>
+    void assert_glyphs_at(const GlyphBatch& batch,
+                          uint32_t offset,
+                          const FakeLabel& label,
+                          const GlyphRange& range)
+    {
+        const auto& vertices = batch.vertices();
+        ASSERT_LE((offset + range.count) * 4, vertices.size());
+        for (uint32_t i = 0; i < range.count * 4; ++i)
+        {
+            const auto& expected = label.vertices[range.first * 4 + i];
+            ASSERT_EQ(vertices[offset * 4 + i].position, expected.position);
+        }
+    }
+}  // namespace
+
+TEST(LabelBatchTest, GroupsGlyphsByFontSizeAndPage)
+{
+    std::vector<FakeLabel> labels;
+    labels.emplace_back(1, std::vector<GlyphRange>{{1, 0, 0, 2}, {0, 0, 2, 1}});
+    labels.emplace_back(2, std::vector<GlyphRange>{{0, 0, 0, 3}});
+    labels.emplace_back(3, std::vector<GlyphRange>{{0, 0, 0, 1}});
+    labels.emplace_back(4, std::vector<GlyphRange>{{1, 0, 0, 2}});
+    labels[2].font_size = 24;
+
+    GlyphBatch batch;
+    batch.rebuild(sources_of(labels));
+
+    // Coverage glyphs come before distance field glyphs, then by page. Within
+    // a draw call, glyphs are in the order their labels were added.
+    const auto& calls = batch.draw_calls();
+
+    ASSERT_EQ(calls.size(), 3U);
+
+    ASSERT_EQ(calls[0].page, 0U);
+    ASSERT_EQ(calls[0].font_size, 0);
+    ASSERT_EQ(calls[0].first, 0U);
+    ASSERT_EQ(calls[0].count, 4U);
+
+    ASSERT_EQ(calls[1].page, 1U);
+    ASSERT_EQ(calls[1].font_size, 0);
+    ASSERT_EQ(calls[1].first, 4U);
+    ASSERT_EQ(calls[1].count, 4U);
+
+    ASSERT_EQ(calls[2].page, 0U);
+    ASSERT_EQ(calls[2].font_size, 24);
+    ASSERT_EQ(calls[2].first, 8U);
+    ASSERT_EQ(calls[2].count, 1U);
+
+    ASSERT_EQ(batch.vertices().size(), 9U * 4);
+
+    assert_glyphs_at(batch, 0, labels[0], labels[0].ranges[1]);
+    assert_glyphs_at(batch, 1, labels[1], labels[1].ranges[0]);
+    assert_glyphs_at(batch, 4, labels[0], labels[0].ranges[0]);
+    assert_glyphs_at(batch, 6, labels[3], labels[3].ranges[0]);
+    assert_glyphs_at(batch, 8, labels[2], labels[2].ranges[0]);
+}
+
+TEST(LabelBatchTest, UpdatesOnlyChangedVertices)
+{
+    std::vector<FakeLabel> labels;
+    labels.emplace_back(1, std::vector<GlyphRange>{{1, 0, 0, 2}, {0, 0, 2, 2}});
+    labels.emplace_back(2, std::vector<GlyphRange>{{0, 0, 0, 3}});
+
+    GlyphBatch batch;
+    batch.rebuild(sources_of(labels));
+
+    ASSERT_TRUE(batch.take_dirty_ranges().empty());
+
+    // Nothing changed
+    ASSERT_TRUE(batch.update(0, labels[0].source()));
+    ASSERT_TRUE(batch.take_dirty_ranges().empty());
+
+    // Change the second glyph of each range of the first label. They are laid
+    // out at glyph 1 (page 0) and glyph 6 (page 1).
+    labels[0].vertices[1 * 4 + 2].color.r = 0;
+    labels[0].vertices[3 * 4].color.g = 0;
+
+    ASSERT_TRUE(batch.update(0, labels[0].source()));
+
+    auto dirty = batch.take_dirty_ranges();
+
+    ASSERT_EQ(dirty.size(), 2U);
+    ASSERT_EQ(dirty[0].first, 1U * 4);
+    ASSERT_EQ(dirty[0].last, 1U * 4 + 1);
+    ASSERT_EQ(dirty[1].first, 6U * 4 + 2);
+    ASSERT_EQ(dirty[1].last, 6U * 4 + 3);
+
+    assert_glyphs_at(batch, 0, labels[0], labels[0].ranges[1]);
+    assert_glyphs_at(batch, 5, labels[0], labels[0].ranges[0]);
+    ASSERT_EQ(batch.vertices()[1 * 4].color.g, 0);
+    ASSERT_EQ(batch.vertices()[6 * 4 + 2].color.r, 0);
+    ASSERT_TRUE(batch.take_dirty_ranges().empty());
+
+    // Neighbouring changes are merged.
+    labels[1].vertices[0].position.x = -1.0F;
+    labels[1].vertices[11].position.x = -1.0F;
+    labels[0].vertices[3 * 4 + 3].position.x = -1.0F;
+
+    ASSERT_TRUE(batch.update(1, labels[1].source()));
+    ASSERT_TRUE(batch.update(0, labels[0].source()));
+
+    dirty = batch.take_dirty_ranges();
+
+    ASSERT_EQ(dirty.size(), 1U);
+    ASSERT_EQ(dirty[0].first, 1U * 4 + 3);
+    ASSERT_EQ(dirty[0].last, 5U * 4);
+
+    // Glyphs that moved to another page, or changed in number, no longer fit.
+    labels[1].ranges[0].page = 1;
+
+    ASSERT_FALSE(batch.update(1, labels[1].source()));
+
+    labels[1].ranges[0].page = 0;
+    labels[1].ranges[0].count = 2;
+
+    ASSERT_FALSE(batch.update(1, labels[1].source()));
+
+    labels[1].ranges[0].count = 3;
+    labels[1].font_size = 16;
+
+    ASSERT_FALSE(batch.update(1, labels[1].source()));
+}
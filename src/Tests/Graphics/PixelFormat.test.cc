@@ -0,0 +1,206 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/PixelFormat.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Graphics/Image.h"
+
+using namespace rainbow::graphics;
+
+using rainbow::Image;
+
+namespace
+{
+    auto reference_pack(const uint8_t* p, PixelFormat format) -> uint16_t
+    {
+        const unsigned r = p[0];
+        const unsigned g = p[1];
+        const unsigned b = p[2];
+        const unsigned a = p[3];
+        switch (format)
+        {
+            case PixelFormat::RGBA4444:
+                return static_cast<uint16_t>(
+                    ((r >> 4) << 12) | ((g >> 4) << 8) | ((b >> 4) << 4) |
+                    (a >> 4));
+            case PixelFormat::RGBA5551:
+                return static_cast<uint16_t>(((r >> 3) << 11) |
+                                             ((g >> 3) << 6) |
+                                             ((b >> 3) << 1) | (a >> 7));
+            case PixelFormat::RGB565:
+                return static_cast<uint16_t>(((r >> 3) << 11) |
+                                             ((g >> 2) << 5) | (b >> 3));
+            default:
+                return 0;
+        }
+    }
+
+    auto make_pixels(size_t count)
+    {
+        std::vector<uint8_t> pixels(count * 4);
+        for (size_t i = 0; i < pixels.size(); ++i)
+            pixels[i] = static_cast<uint8_t>(i * 37 + 11);
+        return pixels;
+    }
+
+    auto make_image(uint32_t width, uint32_t height, uint8_t value)
+    {
+        const size_t size = width * height * 4;
+        auto data = std::make_unique<uint8_t[]>(size);  // NOLINT
+        std::fill_n(data.get(), size, value);
+        return Image{Image::Format::PNG,
+                     width,
+                     height,
+                     32,
+                     4,
+                     size,
+                     data.release()};
+    }
+}  // namespace
+
+TEST(PixelFormatTest, PacksKnownColors)
+{
+    constexpr uint8_t kWhite[]{0xff, 0xff, 0xff, 0xff};
+    constexpr uint8_t kRed[]{0xff, 0x00, 0x00, 0xff};
+    constexpr uint8_t kTransparent[]{0x00, 0x00, 0x00, 0x00};
+
+    uint16_t result = 0;
+
+    pack_row(kWhite, &result, 1, PixelFormat::RGBA4444);
+    ASSERT_EQ(result, 0xffff);
+    pack_row(kWhite, &result, 1, PixelFormat::RGBA5551);
+    ASSERT_EQ(result, 0xffff);
+    pack_row(kWhite, &result, 1, PixelFormat::RGB565);
+    ASSERT_EQ(result, 0xffff);
+
+    pack_row(kRed, &result, 1, PixelFormat::RGBA4444);
+    ASSERT_EQ(result, 0xf00f);
+    pack_row(kRed, &result, 1, PixelFormat::RGBA5551);
+    ASSERT_EQ(result, 0xf801);
+    pack_row(kRed, &result, 1, PixelFormat::RGB565);
+    ASSERT_EQ(result, 0xf800);
+
+    pack_row(kTransparent, &result, 1, PixelFormat::RGBA4444);
+    ASSERT_EQ(result, 0);
+    pack_row(kTransparent, &result, 1, PixelFormat::RGBA5551);
+    ASSERT_EQ(result, 0);
+}
+
+TEST(PixelFormatTest, VectorizedPackingMatchesScalar)
+{
+    constexpr size_t kMaxWidth = 67;
+    const auto pixels = make_pixels(kMaxWidth);
+
+    for (auto format : {PixelFormat::RGBA4444,
+                        PixelFormat::RGBA5551,
+                        PixelFormat::RGB565})
+    {
+        for (size_t width = 1; width <= kMaxWidth; ++width)
+        {
+            std::vector<uint16_t> packed(width);
+            pack_row(pixels.data(), packed.data(), width, format);
+            for (size_t x = 0; x < width; ++x)
+            {
+                ASSERT_EQ(packed[x],
+                          reference_pack(pixels.data() + x * 4, format))
+                    << "width = " << width << ", x = " << x;
+            }
+        }
+    }
+}
+
+TEST(PixelFormatTest, ConvertsToPackedFormats)
+{
+    for (auto dithering :
+         {Dithering::None, Dithering::Ordered, Dithering::ErrorDiffusion})
+    {
+        auto image = convert(
+            make_image(13, 7, 0xff), PixelFormat::RGB565, dithering);
+
+        ASSERT_EQ(image.format, Image::Format::RGB565);
+        ASSERT_EQ(image.width, 13U);
+        ASSERT_EQ(image.height, 7U);
+        ASSERT_EQ(image.depth, 16U);
+        ASSERT_EQ(image.channels, 3U);
+        ASSERT_EQ(image.size, 13U * 7U * sizeof(uint16_t));
+
+        // Saturated colours must survive dithering unchanged.
+        auto data = reinterpret_cast<const uint16_t*>(image.data);
+        for (size_t i = 0; i < image.width * image.height; ++i)
+            ASSERT_EQ(data[i], 0xffff);
+    }
+
+    // Non-owning images, e.g. from the raster cache, must be copied.
+    constexpr uint8_t kPixels[16]{};
+    auto rgba = convert(Image{Image::Format::RGBA, 2, 2, 32, 4, 16, kPixels},
+                        PixelFormat::RGBA5551,
+                        Dithering::Ordered);
+
+    ASSERT_EQ(rgba.format, Image::Format::RGBA5551);
+    ASSERT_NE(rgba.data, kPixels);
+
+    auto image =
+        convert(make_image(4, 4, 0), PixelFormat::RGBA4444, Dithering::None);
+
+    ASSERT_EQ(image.format, Image::Format::RGBA4444);
+    ASSERT_EQ(image.channels, 4U);
+
+    auto data = reinterpret_cast<const uint16_t*>(image.data);
+    for (size_t i = 0; i < image.width * image.height; ++i)
+        ASSERT_EQ(data[i], 0);
+}
+
+TEST(PixelFormatTest, DitheringPreservesAverageIntensity)
+{
+    // 0x84 lies between two 4-bit levels.
+    constexpr uint32_t kSize = 16;
+    constexpr uint8_t kValue = 0x84;
+
+    for (auto dithering : {Dithering::Ordered, Dithering::ErrorDiffusion})
+    {
+        auto image = convert(
+            make_image(kSize, kSize, kValue), PixelFormat::RGBA4444, dithering);
+
+        auto data = reinterpret_cast<const uint16_t*>(image.data);
+        uint32_t min_level = 0xf;
+        uint32_t max_level = 0;
+        uint32_t sum = 0;
+        for (size_t i = 0; i < kSize * kSize; ++i)
+        {
+            const uint32_t red = data[i] >> 12;
+            min_level = std::min(min_level, red);
+            max_level = std::max(max_level, red);
+            sum += red * 0x11;
+        }
+
+        // Dithered output should alternate between neighbouring levels, and
+        // average out to within one level of the source.
+        ASSERT_EQ(max_level - min_level, 1U);
+        ASSERT_NEAR(sum / (kSize * kSize), kValue, 0x11);
+    }
+}
+
+TEST(PixelFormatTest, PassesThroughUnsupportedImages)
+{
+    constexpr uint8_t kPixels[16]{};
+
+    auto image = convert(Image{Image::Format::BC1, 4, 4, 1, 3, 16, kPixels},
+                         PixelFormat::RGB565,
+                         Dithering::Ordered);
+
+    ASSERT_EQ(image.format, Image::Format::BC1);
+    ASSERT_EQ(image.data, kPixels);
+
+    auto png = convert(
+        make_image(2, 2, 0xff), PixelFormat::RGBA8888, Dithering::Ordered);
+
+    ASSERT_EQ(png.format, Image::Format::PNG);
+    ASSERT_EQ(png.depth, 32U);
+}
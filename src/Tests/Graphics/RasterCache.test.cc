@@ -0,0 +1,298 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/RasterCache.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Tests/TestHelpers.h"
+
+using rainbow::Data;
+using rainbow::Image;
+using rainbow::filesystem::Path;
+using rainbow::graphics::RasterCache;
+using rainbow::test::ScopedAssetsDirectory;
+
+namespace
+{
+    constexpr char kCacheDirectory[] = "RasterCacheTest";
+    constexpr char kSource[] = "<svg width=\"4\" height=\"2\"></svg>";
+
+    class ScopedCacheDirectory
+    {
+    public:
+        ScopedCacheDirectory()
+        {
+            rainbow::filesystem::create_directories(kCacheDirectory);
+        }
+
+        ~ScopedCacheDirectory()
+        {
+            auto files = PHYSFS_enumerateFiles(kCacheDirectory);
+            for (auto i = files; *i != nullptr; ++i)
+            {
+                const auto path = Path{kCacheDirectory} / *i;
+                PHYSFS_delete(path.string().c_str());
+            }
+            PHYSFS_freeList(files);
+            PHYSFS_delete(kCacheDirectory);
+        }
+
+        auto path() const { return assets_.path() / kCacheDirectory; }
+
+    private:
+        ScopedAssetsDirectory assets_{"FileSystemTest"};
+    };
+
+    auto rasterize(uint32_t width, uint32_t height)
+    {
+        const size_t size = static_cast<size_t>(width) * height * 4;
+        auto data = std::make_unique<uint8_t[]>(size);  // NOLINT
+        for (size_t i = 0; i < size; ++i)
+            data[i] = static_cast<uint8_t>(i);
+        return Image{Image::Format::SVG,
+                     width,
+                     height,
+                     32,
+                     4,
+                     size,
+                     data.release()};
+    }
+
+    void assert_rasterized(const Image& image, uint32_t width, uint32_t height)
+    {
+        ASSERT_EQ(image.width, width);
+        ASSERT_EQ(image.height, height);
+        ASSERT_EQ(image.depth, 32U);
+        ASSERT_EQ(image.channels, 4U);
+        ASSERT_EQ(image.size, width * height * 4U);
+        for (size_t i = 0; i < image.size; ++i)
+            ASSERT_EQ(image.data[i], static_cast<uint8_t>(i));
+    }
+}  // namespace
+
+TEST(RasterCacheTest, RasterizesOnlyOnce)
+{
+    ScopedCacheDirectory directory;
+    const auto source = Data::from_literal(kSource);
+
+    int count = 0;
+    auto rasterize_once = [&count] {
+        ++count;
+        return rasterize(4, 2);
+    };
+
+    RasterCache cache{directory.path()};
+
+    auto image = cache.get(source, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 1);
+    ASSERT_EQ(image.format, Image::Format::RGBA);
+    assert_rasterized(image, 4, 2);
+
+    auto shared = cache.get(source, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 1);
+    ASSERT_EQ(shared.data, image.data);
+
+    auto scaled = cache.get(source, 2.0F, [&count] {
+        ++count;
+        return rasterize(8, 4);
+    });
+
+    ASSERT_EQ(count, 2);
+    assert_rasterized(scaled, 8, 4);
+}
+
+TEST(RasterCacheTest, LoadsRasterizedImagesFromDisk)
+{
+    ScopedCacheDirectory directory;
+    const auto source = Data::from_literal(kSource);
+
+    int count = 0;
+    auto rasterize_once = [&count] {
+        ++count;
+        return rasterize(4, 2);
+    };
+
+    {
+        RasterCache cache{directory.path()};
+        auto image = cache.get(source, 1.0F, rasterize_once);
+    }
+
+    ASSERT_EQ(count, 1);
+
+    RasterCache cache{directory.path()};
+    auto image = cache.get(source, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 1);
+    ASSERT_EQ(image.format, Image::Format::RGBA);
+    assert_rasterized(image, 4, 2);
+
+    cache.clear();
+    auto remapped = cache.get(source, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 1);
+    assert_rasterized(remapped, 4, 2);
+}
+
+TEST(RasterCacheTest, CachesInMemoryWithoutDirectory)
+{
+    const auto source = Data::from_literal(kSource);
+
+    int count = 0;
+    auto rasterize_once = [&count] {
+        ++count;
+        return rasterize(4, 2);
+    };
+
+    RasterCache cache{Path{}};
+    auto image = cache.get(source, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 1);
+    ASSERT_EQ(image.format, Image::Format::RGBA);
+    assert_rasterized(image, 4, 2);
+
+    auto again = cache.get(source, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 1);
+    ASSERT_EQ(again.data, image.data);
+
+    cache.clear();
+    auto rasterized = cache.get(source, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 2);
+    assert_rasterized(rasterized, 4, 2);
+}
+
+TEST(RasterCacheTest, EvictsLeastRecentlyUsedImagesFromMemory)
+{
+    constexpr size_t kImageSize = 4 * 2 * 4;
+
+    const auto first = Data::from_literal("<svg id=\"1\"></svg>");
+    const auto second = Data::from_literal("<svg id=\"2\"></svg>");
+    const auto third = Data::from_literal("<svg id=\"3\"></svg>");
+
+    int count = 0;
+    auto rasterize_once = [&count] {
+        ++count;
+        return rasterize(4, 2);
+    };
+
+    RasterCache cache{Path{}, RasterCache::kMaxDiskSize, kImageSize * 2};
+    cache.get(first, 1.0F, rasterize_once);
+    cache.get(second, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 2);
+    ASSERT_EQ(cache.size(), kImageSize * 2);
+
+    // Using the first image makes the second one least recently used.
+    cache.get(first, 1.0F, rasterize_once);
+    cache.get(third, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 3);
+    ASSERT_EQ(cache.size(), kImageSize * 2);
+
+    cache.get(first, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 3);
+
+    cache.get(second, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 4);
+    ASSERT_EQ(cache.size(), kImageSize * 2);
+}
+
+TEST(RasterCacheTest, PrunesLeastRecentlyUsedEntries)
+{
+    constexpr size_t kEntrySize = 16 + 4 * 2 * 4;
+
+    ScopedCacheDirectory directory;
+    const auto first = Data::from_literal("<svg id=\"1\"></svg>");
+    const auto second = Data::from_literal("<svg id=\"2\"></svg>");
+    const auto third = Data::from_literal("<svg id=\"3\"></svg>");
+
+    int count = 0;
+    auto rasterize_once = [&count] {
+        ++count;
+        return rasterize(4, 2);
+    };
+
+    // File times are not necessarily precise; make sure they differ.
+    auto wait = [] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    };
+
+    {
+        RasterCache cache{directory.path(), kEntrySize * 2};
+        cache.get(first, 1.0F, rasterize_once);
+        wait();
+        cache.get(second, 1.0F, rasterize_once);
+        wait();
+
+        // Reloading the first image from disk makes it more recently used.
+        cache.clear();
+        cache.get(first, 1.0F, rasterize_once);
+        wait();
+
+        cache.get(third, 1.0F, rasterize_once);
+    }
+
+    ASSERT_EQ(count, 3);
+
+    RasterCache cache{directory.path(), kEntrySize * 2};
+    cache.get(first, 1.0F, rasterize_once);
+    cache.get(third, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 3);
+
+    cache.get(second, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 4);
+}
+
+TEST(RasterCacheTest, PrunesEntriesMappedThisSession)
+{
+    constexpr size_t kEntrySize = 16 + 4 * 2 * 4;
+
+    ScopedCacheDirectory directory;
+    const auto first = Data::from_literal("<svg id=\"1\"></svg>");
+    const auto second = Data::from_literal("<svg id=\"2\"></svg>");
+    const auto third = Data::from_literal("<svg id=\"3\"></svg>");
+
+    int count = 0;
+    auto rasterize_once = [&count] {
+        ++count;
+        return rasterize(4, 2);
+    };
+
+    auto wait = [] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    };
+
+    {
+        RasterCache cache{directory.path(), kEntrySize * 2};
+        cache.get(first, 1.0F, rasterize_once);
+        wait();
+        cache.get(second, 1.0F, rasterize_once);
+        wait();
+        cache.get(third, 1.0F, rasterize_once);
+    }
+
+    ASSERT_EQ(count, 3);
+
+    RasterCache cache{directory.path(), kEntrySize * 2};
+    cache.get(second, 1.0F, rasterize_once);
+    cache.get(third, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 3);
+
+    cache.get(first, 1.0F, rasterize_once);
+
+    ASSERT_EQ(count, 4);
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/Resample.h"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "Common/Data.h"
+#include "Graphics/Image.h"
+#include "Graphics/Texture.h"
+#include "Tests/__fixtures/ImageTest/Images.h"
+
+using namespace rainbow::graphics;
+using namespace rainbow::test;
+
+using rainbow::Data;
+using rainbow::Image;
+
+namespace
+{
+    template <typename F>
+    auto make_image(uint32_t width, uint32_t height, uint32_t channels, F&& f)
+    {
+        const size_t size = static_cast<size_t>(width) * height * channels;
+        auto data = std::make_unique<uint8_t[]>(size);  // NOLINT
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                for (uint32_t c = 0; c < channels; ++c)
+                    data[(y * width + x) * channels + c] = f(x, y, c);
+            }
+        }
+        return Image{Image::Format::PNG,
+                     width,
+                     height,
+                     channels * 8,
+                     channels,
+                     size,
+                     data.release()};
+    }
+}  // namespace
+
+TEST(ResampleTest, BoxFilterAveragesCoveredPixels)
+{
+    // 2x2 checkerboard blocks of 0 and 200 average out to 100 when halved.
+    auto image = make_image(34, 6, 4, [](uint32_t x, uint32_t y, uint32_t) {
+        return static_cast<uint8_t>((x + y) % 2 == 0 ? 200 : 0);
+    });
+
+    auto result = resample(image, 17, 3, Filter::Linear);
+
+    ASSERT_EQ(result.format, Image::Format::PNG);
+    ASSERT_EQ(result.width, 17U);
+    ASSERT_EQ(result.height, 3U);
+    ASSERT_EQ(result.depth, 32U);
+    ASSERT_EQ(result.channels, 4U);
+    ASSERT_EQ(result.size, 17U * 3U * 4U);
+
+    for (size_t i = 0; i < result.size; ++i)
+        ASSERT_EQ(result.data[i], 100) << "i = " << i;
+}
+
+TEST(ResampleTest, PreservesFlatAreas)
+{
+    for (auto filter : {Filter::Nearest, Filter::Linear, Filter::Cubic})
+    {
+        for (uint32_t channels = 1; channels <= 4; ++channels)
+        {
+            auto image = make_image(
+                61, 47, channels, [](uint32_t, uint32_t, uint32_t c) {
+                    return static_cast<uint8_t>(255 - c * 60);
+                });
+
+            auto result = resample(image, 23, 19, filter);
+
+            ASSERT_EQ(result.channels, channels);
+            for (size_t i = 0; i < result.size; ++i)
+            {
+                ASSERT_EQ(result.data[i], 255 - (i % channels) * 60)
+                    << "channels = " << channels << ", i = " << i;
+            }
+        }
+    }
+}
+
+TEST(ResampleTest, NearestFilterPicksPixels)
+{
+    auto image = make_image(8, 8, 1, [](uint32_t x, uint32_t y, uint32_t) {
+        return static_cast<uint8_t>(y * 8 + x);
+    });
+
+    auto result = resample(image, 4, 2, Filter::Nearest);
+
+    constexpr uint8_t kExpected[]{17, 19, 21, 23, 49, 51, 53, 55};
+    for (size_t i = 0; i < sizeof(kExpected); ++i)
+        ASSERT_EQ(result.data[i], kExpected[i]);
+}
+
+TEST(ResampleTest, LanczosFilterStaysWithinRange)
+{
+    // Sharp edges produce overshoot that must be clamped.
+    auto image = make_image(64, 64, 2, [](uint32_t x, uint32_t, uint32_t) {
+        return static_cast<uint8_t>(x < 32 ? 0 : 255);
+    });
+
+    auto result = resample(image, 21, 21, Filter::Cubic);
+
+    ASSERT_EQ(result.data[0], 0);
+    ASSERT_EQ(result.data[result.size - 1], 255);
+}
+
+TEST(ResampleTest, DownscalesPNGsOnDecode)
+{
+    const Data data{fixtures::basn6a08_png.data(),
+                    fixtures::basn6a08_png.size(),
+                    Data::Ownership::Reference};
+
+    auto full = Image::decode(data, 1.0F, Filter::Linear);
+
+    ASSERT_EQ(full.width, 32U);
+    ASSERT_EQ(full.height, 32U);
+
+    for (auto filter : {Filter::Nearest, Filter::Linear, Filter::Cubic})
+    {
+        auto image = Image::decode(data, 0.5F, filter);
+
+        ASSERT_EQ(image.format, Image::Format::PNG);
+        ASSERT_EQ(image.width, 16U);
+        ASSERT_EQ(image.height, 16U);
+        ASSERT_EQ(image.depth, full.depth);
+        ASSERT_EQ(image.channels, full.channels);
+        ASSERT_EQ(image.size, 16U * 16U * full.channels);
+    }
+}
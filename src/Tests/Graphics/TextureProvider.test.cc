@@ -4,6 +4,7 @@
 
 #include "Graphics/Texture.h"
 
+#include <array>
 #include <string_view>
 
 #include <gtest/gtest.h>
@@ -30,6 +31,8 @@ namespace
         int released = 0;    // NOLINT
         int updated = 0;     // NOLINT
 
+        std::array<uint32_t, 4> region{};  // NOLINT
+
         void construct(TextureHandle& handle,
                        const Image&,
                        Filter,
@@ -50,6 +53,15 @@ namespace
         {
             ++updated;
         }
+
+        void update_region(const TextureHandle&,
+                           const Image& image,
+                           uint32_t x,
+                           uint32_t y) override
+        {
+            ++updated;
+            region = {x, y, image.width, image.height};
+        }
     };
 }  // namespace
 
@@ -198,6 +210,24 @@ TEST(TextureProviderTest, UpdatesExistingTexture)
     ASSERT_EQ(allocator.updated, 1);
 }
 
+TEST(TextureProviderTest, UpdatesRegionOfExistingTexture)
+{
+    MockTextureAllocator allocator;
+    TextureProvider provider{allocator};
+
+    auto mock_image = Data::from_literal(kMockImageData);
+    auto texture = provider.get("test", mock_image);
+    ASSERT_TRUE(texture);
+
+    const uint8_t pixels[4 * 2 * 3]{};
+    const Image image{
+        Image::Format::RGBA, 2, 3, 32, 4, sizeof(pixels), pixels};
+    provider.update_region(texture, image, 5, 7);
+
+    ASSERT_EQ(allocator.updated, 1);
+    ASSERT_EQ(allocator.region, (std::array<uint32_t, 4>{5, 7, 2, 3}));
+}
+
 TEST(TextureProviderTest, ReleasesPreviousTextureWhenAssigned)
 {
     MockTextureAllocator allocator;
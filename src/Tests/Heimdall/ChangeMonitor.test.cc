@@ -0,0 +1,110 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Heimdall/ChangeMonitor.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Heimdall/ChangeQueue.h"
+
+using heimdall::ChangeQueue;
+
+#if defined(USE_HEIMDALL) && defined(RAINBOW_OS_LINUX)
+
+#include <unistd.h>
+
+using heimdall::ChangeMonitor;
+
+namespace
+{
+    class ScopedTempDirectory
+    {
+    public:
+        ScopedTempDirectory()
+        {
+            char path[] = "/tmp/ChangeMonitorTest.XXXXXX";
+            if (mkdtemp(path) != nullptr)
+                path_ = path;
+        }
+
+        ~ScopedTempDirectory()
+        {
+            for (auto&& file : files_)
+                unlink((path_ + '/' + file).c_str());
+            rmdir(path_.c_str());
+        }
+
+        [[nodiscard]] auto path() const { return path_.c_str(); }
+
+        void write(const std::string& file)
+        {
+            auto stream = fopen((path_ + '/' + file).c_str(), "wb");
+            ASSERT_NE(stream, nullptr);
+            fputs("rainbow", stream);
+            fclose(stream);
+            files_.push_back(file);
+        }
+
+    private:
+        std::string path_;
+        std::vector<std::string> files_;
+    };
+}  // namespace
+
+TEST(ChangeMonitorTest, ReportsModifiedFiles)
+{
+    ScopedTempDirectory directory;
+
+    ASSERT_NE(*directory.path(), '\0');
+
+    std::mutex mutex;
+    std::condition_variable reported;
+    std::vector<std::string> changes;
+    ChangeMonitor monitor(directory.path(), [&](rainbow::czstring path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        changes.emplace_back(path);
+        reported.notify_one();
+    });
+
+    directory.write("file.txt");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(reported.wait_for(lock, std::chrono::seconds(1), [&] {
+        return !changes.empty();
+    }));
+
+    // Give duplicate events a chance to arrive.
+    reported.wait_for(lock, std::chrono::milliseconds(100));
+
+    ASSERT_EQ(changes, std::vector<std::string>{"file.txt"});
+}
+
+#endif  // USE_HEIMDALL && RAINBOW_OS_LINUX
+
+TEST(ChangeQueueTest, CoalescesChanges)
+{
+    ChangeQueue queue{"/assets"};
+
+    queue.push("/assets/a.png");
+    queue.push("b.png");
+    queue.push("/assets/a.png");
+    queue.push("sub\\c.png");
+    queue.push("/assets/sub/c.png");
+
+    ASSERT_EQ(queue.take(),
+              (std::vector<std::string>{"a.png", "b.png", "sub/c.png"}));
+    ASSERT_TRUE(queue.take().empty());
+
+    queue.push("a.png");
+
+    ASSERT_EQ(queue.take(), std::vector<std::string>{"a.png"});
+}
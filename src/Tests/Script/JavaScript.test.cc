@@ -5,11 +5,20 @@
 #include "Script/JavaScript/JavaScript.h"
 
 #include <climits>
+#include <cstring>
 
 #include <gtest/gtest.h>
 
 #include "Common/Constants.h"
+#include "FileSystem/AsyncIO.h"
+#include "FileSystem/FileSystem.h"
 #include "Script/JavaScript/Helper.h"
+#include "Tests/TestHelpers.h"
+
+namespace rainbow::duk
+{
+    void initialize_io(duk_context* ctx);
+}
 
 namespace
 {
@@ -119,3 +128,35 @@ TEST_F(JavaScriptTest, SetsAndGetsVec2)
 
     ASSERT_EQ(duk::get<rainbow::Vec2f>(context_, 0), expected);
 }
+
+TEST(JavaScriptIOTest, WritesSurviveRestart)
+{
+    constexpr char kOutputFile[] = "JavaScriptTest.dat";
+
+    rainbow::test::ScopedAssetsDirectory scoped_assets{"FileTest_SeeksInFile"};
+
+    rainbow::AsyncIO io{0};
+
+    {
+        duk::Context context{nullptr};
+        const auto obj_idx = duk_push_bare_object(context);
+        duk::register_module(context, obj_idx, "IO", &duk::initialize_io);
+        duk_put_global_literal(context, "Rainbow");
+
+        ASSERT_EQ(duk_peval_string_noresult(
+                      context,
+                      "Rainbow.IO.writeFile('JavaScriptTest.dat', 'rainbow')"),
+                  0);
+    }
+
+    // Director::restart() tears down the script, then clears pending I/O.
+    io.clear();
+    io.update();
+
+    const auto data =
+        rainbow::File::read(kOutputFile, rainbow::FileType::UserFile);
+
+    ASSERT_EQ(data.size(), 7U);
+    ASSERT_EQ(memcmp(data.bytes(), "rainbow", data.size()), 0);
+    ASSERT_TRUE(rainbow::filesystem::remove(kOutputFile));
+}
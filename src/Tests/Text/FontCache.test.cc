@@ -0,0 +1,363 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Text/FontCache.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Graphics/Image.h"
+#include "Text/SystemFonts.h"
+
+using rainbow::FontCache;
+using rainbow::Image;
+using rainbow::graphics::Filter;
+using rainbow::graphics::ITextureAllocator;
+using rainbow::graphics::TextureHandle;
+using rainbow::graphics::TextureProvider;
+
+namespace
+{
+    struct Upload
+    {
+        Image::Format format;
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        uint32_t channels;
+        std::vector<uint8_t> pixels;
+    };
+
+    struct MockTextureAllocator final : public ITextureAllocator
+    {
+        int current_id = 0;            // NOLINT
+        std::vector<Upload> uploads;  // NOLINT
+
+        void construct(TextureHandle& handle,
+                       const Image& image,
+                       Filter,
+                       Filter) override
+        {
+            handle[0] = ++current_id;
+            record(image, 0, 0);
+        }
+
+        void destroy(TextureHandle&) override {}
+
+        [[maybe_unused, nodiscard]]
+        auto max_size() const noexcept -> size_t override
+        {
+            return sizeof(current_id);
+        }
+
+        void update(const TextureHandle&, const Image&, Filter, Filter) override
+        {
+        }
+
+        void update_region(const TextureHandle&,
+                           const Image& image,
+                           uint32_t x,
+                           uint32_t y) override
+        {
+            record(image, x, y);
+        }
+
+        void record(const Image& image, uint32_t x, uint32_t y)
+        {
+            uploads.push_back({image.format,
+                               x,
+                               y,
+                               image.width,
+                               image.height,
+                               image.depth,
+                               image.channels,
+                               {image.data, image.data + image.size}});
+        }
+    };
+
+    struct Rect
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    /// <summary>Returns where in its page specified glyph is stored.</summary>
+    auto rect_of(const FontCache::Glyph& glyph)
+    {
+        constexpr auto kSize = static_cast<float>(FontCache::kTextureSize);
+        const auto& vx = glyph.vertices;
+        return Rect{
+            static_cast<int>(std::lround(vx[0].texcoord.x * kSize)),
+            static_cast<int>(std::lround(vx[2].texcoord.y * kSize)),
+            static_cast<int>(std::lround(vx[1].position.x - vx[0].position.x)),
+            static_cast<int>(std::lround(vx[2].position.y - vx[0].position.y)),
+        };
+    }
+
+    auto has_font()
+    {
+        return static_cast<bool>(rainbow::text::monospace_font());
+    }
+}  // namespace
+
+TEST(FontCacheTest, UploadsSingleChannelRegions)
+{
+    if (!has_font())
+        return;  // There is no system font to rasterize.
+
+    MockTextureAllocator allocator;
+    TextureProvider texture_provider{allocator};
+    FontCache cache;
+
+    const auto face = cache.get("");
+    cache.get_glyph(face, 12, FT_Get_Char_Index(face, 'A'));
+    cache.update(texture_provider);
+
+    // The first upload creates the whole page.
+    ASSERT_EQ(allocator.uploads.size(), 1U);
+
+    const auto& page = allocator.uploads[0];
+
+    ASSERT_EQ(page.format, Image::Format::Luminance);
+    ASSERT_EQ(page.width, static_cast<uint32_t>(FontCache::kTextureSize));
+    ASSERT_EQ(page.height, static_cast<uint32_t>(FontCache::kTextureSize));
+    ASSERT_EQ(page.depth, 8U);
+    ASSERT_EQ(page.channels, 1U);
+    ASSERT_EQ(page.pixels.size(), size_t{page.width} * page.height);
+
+    // Later uploads only contain the glyphs added since, one byte per pixel
+    // and with rows packed tightly.
+    const auto glyph_index = FT_Get_Char_Index(face, 'B');
+    const auto glyph = cache.get_glyph(face, 24, glyph_index);
+    cache.update(texture_provider);
+
+    ASSERT_EQ(allocator.uploads.size(), 2U);
+
+    const auto& region = allocator.uploads[1];
+    const auto rect = rect_of(glyph);
+
+    ASSERT_EQ(region.format, Image::Format::Luminance);
+    ASSERT_EQ(region.depth, 8U);
+    ASSERT_EQ(region.channels, 1U);
+    ASSERT_EQ(region.pixels.size(), size_t{region.width} * region.height);
+    ASSERT_EQ(region.x, static_cast<uint32_t>(rect.x));
+    ASSERT_EQ(region.y, static_cast<uint32_t>(rect.y));
+    ASSERT_EQ(region.width, static_cast<uint32_t>(rect.width));
+    ASSERT_EQ(region.height, static_cast<uint32_t>(rect.height));
+
+    FT_Set_Char_Size(face, 0, 24 * 64, 0, FontCache::kDPI);
+    FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER);
+    const auto& bitmap = face->glyph->bitmap;
+
+    ASSERT_EQ(region.width, bitmap.width);
+    ASSERT_EQ(region.height, bitmap.rows);
+
+    for (uint32_t y = 0; y < bitmap.rows; ++y)
+    {
+        for (uint32_t x = 0; x < bitmap.width; ++x)
+        {
+            ASSERT_EQ(region.pixels[y * region.width + x],
+                      bitmap.buffer[y * bitmap.pitch + x]);
+        }
+    }
+}
+
+TEST(FontCacheTest, EvictsLeastRecentlyUsedPages)
+{
+    if (!has_font())
+        return;  // There is no system font to rasterize.
+
+    constexpr auto kMaxPages = static_cast<uint32_t>(FontCache::kMaxPages);
+
+    MockTextureAllocator allocator;
+    TextureProvider texture_provider{allocator};
+    FontCache cache;
+
+    const auto face = cache.get("");
+    const auto glyph_index = FT_Get_Char_Index(face, 'W');
+    auto get_glyph = [&cache, face, glyph_index](int i) {
+        constexpr int kFontSize = 1300;
+        return cache.get_glyph(face, kFontSize + i, glyph_index);
+    };
+
+    // Glyphs this large only fit one to a page.
+    const auto first = get_glyph(0);
+    const auto rect = rect_of(first);
+    if (rect.width * 2 <= FontCache::kTextureSize ||
+        rect.height * 2 <= FontCache::kTextureSize)
+    {
+        return;  // The system font is too narrow for this test.
+    }
+
+    // Fill up all pages, one per frame.
+    cache.update(texture_provider);
+    for (int i = 1; i < static_cast<int>(kMaxPages); ++i)
+    {
+        ASSERT_EQ(get_glyph(i).page, static_cast<uint32_t>(i));
+        cache.update(texture_provider);
+    }
+
+    ASSERT_EQ(first.page, 0U);
+    ASSERT_EQ(cache.page_count(), kMaxPages);
+
+    for (uint32_t page = 0; page < kMaxPages; ++page)
+        ASSERT_EQ(cache.generation(page), 0U);
+
+    // Keep using the first page. The least recently used page is evicted to
+    // make room for a new glyph, invalidating anything drawn from it.
+    ASSERT_EQ(get_glyph(0).page, 0U);
+    ASSERT_EQ(get_glyph(kMaxPages).page, 1U);
+    ASSERT_EQ(cache.page_count(), kMaxPages);
+    ASSERT_EQ(cache.generation(0), 0U);
+    ASSERT_EQ(cache.generation(1), 1U);
+    ASSERT_EQ(cache.generation(2), 0U);
+    ASSERT_EQ(cache.generation(3), 0U);
+
+    cache.update(texture_provider);
+
+    // Glyphs that were stored on an evicted page are rasterized again.
+    ASSERT_EQ(get_glyph(1).page, 2U);
+    ASSERT_EQ(cache.generation(2), 1U);
+
+    cache.update(texture_provider);
+
+    // Pages used in the current frame are never evicted. Once all of them
+    // are in use, new pages are added regardless of the limit.
+    for (int i = 0; i < static_cast<int>(kMaxPages); ++i)
+        get_glyph(10 + i);
+
+    ASSERT_EQ(cache.page_count(), kMaxPages);
+    ASSERT_EQ(get_glyph(20).page, kMaxPages);
+    ASSERT_EQ(cache.page_count(), kMaxPages + 1);
+}
+
+TEST(FontCacheTest, DoesNotStoreGlyphsLargerThanPage)
+{
+    if (!has_font())
+        return;  // There is no system font to rasterize.
+
+    FontCache cache;
+
+    const auto face = cache.get("");
+    const auto glyph =
+        cache.get_glyph(face, 3000, FT_Get_Char_Index(face, 'W'));
+
+    ASSERT_EQ(glyph.page, FontCache::kInvalidPage);
+    ASSERT_EQ(cache.page_count(), 0U);
+    ASSERT_EQ(cache.generation(FontCache::kInvalidPage), 0U);
+
+    cache.touch(FontCache::kInvalidPage);
+}
+
+TEST(FontCacheTest, MakesSignedDistanceFields)
+{
+    constexpr int kSpread = FontCache::kDistanceFieldSpread;
+    constexpr int kSize = 4 + kSpread * 2;
+
+    // A 2x2 square in the middle of a 4x4 bitmap.
+    uint8_t pixels[]{
+        0, 0,   0,   0,  //
+        0, 255, 255, 0,  //
+        0, 255, 255, 0,  //
+        0, 0,   0,   0,  //
+    };
+    FT_Bitmap bitmap{};
+    bitmap.rows = 4;
+    bitmap.width = 4;
+    bitmap.pitch = 4;
+    bitmap.buffer = pixels;
+    bitmap.num_grays = 256;
+    bitmap.pixel_mode = FT_PIXEL_MODE_GRAY;
+
+    const auto field = rainbow::detail::make_distance_field(bitmap);
+
+    ASSERT_EQ(field.size(), static_cast<size_t>(kSize * kSize));
+
+    auto at = [&field](int x, int y) {
+        return field[(y + kSpread) * kSize + x + kSpread];
+    };
+
+    // Distance increases by 1 / (2 * spread) per pixel, from 0.5 at the
+    // outline. Pixels inside the square are one pixel from the outside.
+    const auto value = [](double distance) {
+        return static_cast<uint8_t>(
+            std::lround((0.5 - distance / (kSpread * 2)) * 255));
+    };
+    for (int y = 1; y < 3; ++y)
+    {
+        for (int x = 1; x < 3; ++x)
+            ASSERT_EQ(at(x, y), value(-1));
+    }
+
+    ASSERT_EQ(at(0, 1), value(1));
+    ASSERT_EQ(at(3, 2), value(1));
+    ASSERT_EQ(at(1, -2), value(3));
+    ASSERT_EQ(at(0, 0), value(std::sqrt(2.0)));
+
+    // Anything further away than the spread is clamped.
+    ASSERT_EQ(at(1, 1 - kSpread), 0);
+    ASSERT_EQ(at(-kSpread, -kSpread), 0);
+    ASSERT_EQ(field.front(), 0);
+    ASSERT_EQ(field.back(), 0);
+
+    // Partially covered pixels are crossed by the outline.
+    uint8_t edge[]{128};
+    bitmap.rows = 1;
+    bitmap.width = 1;
+    bitmap.pitch = 1;
+    bitmap.buffer = edge;
+    const auto edge_field = rainbow::detail::make_distance_field(bitmap);
+
+    ASSERT_EQ(edge_field.size(), static_cast<size_t>((1 + kSpread * 2) *
+                                                     (1 + kSpread * 2)));
+    ASSERT_EQ(edge_field[kSpread * (1 + kSpread * 2) + kSpread], 128);
+}
+
+TEST(FontCacheTest, StoresPrewarmedGlyphsOnUpdate)
+{
+    if (!has_font())
+        return;  // There is no system font to rasterize.
+
+    constexpr int kFontSize = 12;
+
+    MockTextureAllocator allocator;
+    TextureProvider texture_provider{allocator};
+    FontCache cache;
+
+    const uint32_t text[]{'R', 'a', 'i', 'n', 'b', 'o', 'w'};
+    cache.prewarm("", kFontSize, text);
+
+    // Glyphs are rasterized on a worker, and stored on the first update after
+    // they are done.
+    for (int i = 0; cache.page_count() == 0 && i < 1000; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        cache.update(texture_provider);
+    }
+
+    ASSERT_EQ(cache.page_count(), 1U);
+    ASSERT_EQ(allocator.uploads.size(), 1U);
+
+    // Glyphs are already in the cache; nothing new is rasterized or uploaded.
+    const auto face = cache.get("");
+    for (auto c : text)
+    {
+        const auto glyph =
+            cache.get_glyph(face, kFontSize, FT_Get_Char_Index(face, c));
+
+        ASSERT_EQ(glyph.page, 0U);
+    }
+
+    cache.update(texture_provider);
+
+    ASSERT_EQ(allocator.uploads.size(), 1U);
+}
@@ -0,0 +1,287 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Text/Typesetter.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Text/SystemFonts.h"
+
+using rainbow::GlyphPosition;
+using rainbow::LayoutRequest;
+using rainbow::TextAlignment;
+using rainbow::TextAttributes;
+using rainbow::Typesetter;
+using rainbow::Vec2f;
+
+namespace
+{
+    constexpr int kFontSize = 16;
+
+    auto has_font()
+    {
+        return static_cast<bool>(rainbow::text::monospace_font());
+    }
+
+    struct Layout
+    {
+        std::vector<GlyphPosition> glyphs;
+        Vec2f size;
+    };
+
+    /// <summary>Lays out each string with a new typesetter.</summary>
+    auto layout_all(const std::vector<std::string>& texts,
+                    const TextAttributes& attributes)
+    {
+        Typesetter typesetter;
+        std::vector<Layout> layouts;
+        layouts.reserve(texts.size());
+        for (auto&& text : texts)
+        {
+            auto& layout = layouts.emplace_back();
+            layout.glyphs =
+                typesetter.layout_text(text, attributes, &layout.size);
+        }
+        return layouts;
+    }
+
+    void assert_same_layout(const std::vector<GlyphPosition>& actual,
+                            const std::vector<GlyphPosition>& expected)
+    {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); ++i)
+        {
+            ASSERT_EQ(actual[i].glyph_index, expected[i].glyph_index);
+            ASSERT_NEAR(actual[i].position.x, expected[i].position.x, 1e-3);
+            ASSERT_NEAR(actual[i].position.y, expected[i].position.y, 1e-3);
+        }
+    }
+}  // namespace
+
+TEST(TypesetterTest, PreparesReplacedText)
+{
+    if (!has_font())
+        return;  // There is no system font to shape with.
+
+    const std::string font_face;
+    const TextAttributes attributes{font_face, kFontSize, TextAlignment::Left};
+    const std::vector<std::string> before{
+        "Score: 100",
+        "Lives: 3",
+        "Time: 01:59",
+        "Level 1",
+        "Coins: 9",
+    };
+    const std::vector<std::string> after{
+        "Score: 1100",
+        "Lives: 2",
+        "Time: 01:58",
+        "Level 12",
+        "Coins: 10",
+    };
+
+    const auto expected = layout_all(after, attributes);
+
+    Typesetter typesetter;
+    for (auto&& text : before)
+        typesetter.layout_text(text, attributes);
+
+    std::vector<LayoutRequest> requests;
+    requests.reserve(after.size());
+    for (size_t i = 0; i < after.size(); ++i)
+        requests.push_back({after[i], attributes, before[i]});
+
+    typesetter.prepare(requests);
+
+    for (size_t i = 0; i < after.size(); ++i)
+    {
+        assert_same_layout(
+            typesetter.layout_text(after[i], attributes, nullptr, before[i]),
+            expected[i].glyphs);
+    }
+}
+
+TEST(TypesetterTest, ReshapesChangesLikeFullShape)
+{
+    if (!has_font())
+        return;  // There is no system font to shape with.
+
+    struct Change
+    {
+        std::string before;
+        std::string after;
+    };
+
+    const std::vector<Change> changes{
+        // Insertions
+        {"ello, world", "Hello, world"},
+        {"Hello world", "Hello, world"},
+        {"Hello, world", "Hello, world!"},
+
+        // Deletions
+        {"Hello, world", "ello, world"},
+        {"Hello, world", "Hello world"},
+        {"Hello, world!", "Hello, world"},
+
+        // Replacements
+        {"Score: 100", "Store: 100"},
+        {"Score: 100", "Score: 200"},
+        {"Score: 100", "Score: 101"},
+        {"Score: 100", "Lives: 9"},
+
+        // Changes next to glyphs that may combine with their neighbours,
+        // e.g. through ligatures or kerning.
+        {"fjord", "fiord"},
+        {"fiord", "fjord"},
+        {"AXE", "AVE"},
+        {"AVE", "AWE"},
+        {"Waffle", "Waffles"},
+        {"office", "offence"},
+
+        // Multi-byte characters
+        {"Caf\xc3\xa9 1", "Caf\xc3\xa9 2"},
+        {"na\xc3\xafve", "naive"},
+        {"naive", "na\xc3\xafve"},
+        {"\xe2\x82\xac" "100", "\xc2\xa3" "100"},
+        {"\xc3\xa9t\xc3\xa9", "\xc3\xa9t\xc3\xa8"},
+    };
+
+    std::vector<std::string> after;
+    after.reserve(changes.size());
+    for (auto&& change : changes)
+        after.push_back(change.after);
+
+    const std::string font_face;
+    for (auto alignment :
+         {TextAlignment::Left, TextAlignment::Center, TextAlignment::Right})
+    {
+        const TextAttributes attributes{font_face, kFontSize, alignment};
+        const auto expected = layout_all(after, attributes);
+
+        Typesetter typesetter;
+        for (size_t i = 0; i < changes.size(); ++i)
+        {
+            const auto& [before, text] = changes[i];
+            SCOPED_TRACE("'" + before + "' -> '" + text + "'");
+
+            typesetter.layout_text(before, attributes);
+
+            Vec2f size;
+            const auto glyphs =
+                typesetter.layout_text(text, attributes, &size, before);
+
+            assert_same_layout(glyphs, expected[i].glyphs);
+            ASSERT_NEAR(size.x, expected[i].size.x, 1e-3);
+            ASSERT_NEAR(size.y, expected[i].size.y, 1e-3);
+        }
+    }
+}
+
+TEST(TypesetterTest, CachesLayouts)
+{
+    if (!has_font())
+        return;  // There is no system font to shape with.
+
+    const std::string font_face;
+    const TextAttributes attributes{font_face, kFontSize, TextAlignment::Left};
+    const TextAttributes larger{font_face, kFontSize * 2, TextAlignment::Left};
+
+    Typesetter typesetter;
+
+    ASSERT_EQ(typesetter.cached_runs(), 0U);
+    ASSERT_FALSE(typesetter.is_cached("Rainbow", attributes));
+
+    const auto first = typesetter.layout_text("Rainbow", attributes);
+
+    ASSERT_EQ(typesetter.cached_runs(), 1U);
+    ASSERT_TRUE(typesetter.is_cached("Rainbow", attributes));
+
+    // Hit
+    assert_same_layout(typesetter.layout_text("Rainbow", attributes), first);
+
+    ASSERT_EQ(typesetter.cached_runs(), 1U);
+
+    // Misses
+    typesetter.layout_text("Bifrost", attributes);
+
+    ASSERT_EQ(typesetter.cached_runs(), 2U);
+    ASSERT_FALSE(typesetter.is_cached("Rainbow", larger));
+
+    typesetter.layout_text("Rainbow", larger);
+
+    ASSERT_EQ(typesetter.cached_runs(), 3U);
+    ASSERT_TRUE(typesetter.is_cached("Rainbow", attributes));
+    ASSERT_TRUE(typesetter.is_cached("Rainbow", larger));
+}
+
+TEST(TypesetterTest, EvictsLeastRecentlyUsedLayouts)
+{
+    if (!has_font())
+        return;  // There is no system font to shape with.
+
+    constexpr size_t kCapacity = Typesetter::kMaxCachedRuns;
+    constexpr size_t kQuarter = kCapacity / 4;
+
+    const std::string font_face;
+    const TextAttributes attributes{font_face, kFontSize, TextAlignment::Left};
+
+    Typesetter typesetter;
+    std::vector<std::string> texts;
+    texts.reserve(kCapacity + 1);
+    for (size_t i = 0; i <= kCapacity; ++i)
+        texts.push_back(std::to_string(i));
+
+    // The cache fills up to capacity before anything is evicted.
+    for (size_t i = 0; i < kCapacity; ++i)
+        typesetter.layout_text(texts[i], attributes);
+
+    ASSERT_EQ(typesetter.cached_runs(), kCapacity);
+
+    // Use the oldest quarter again, making the second quarter the least
+    // recently used.
+    for (size_t i = 0; i < kQuarter; ++i)
+        typesetter.layout_text(texts[i], attributes);
+
+    ASSERT_EQ(typesetter.cached_runs(), kCapacity);
+
+    // The least recently used quarter is evicted to make room.
+    typesetter.layout_text(texts[kCapacity], attributes);
+
+    ASSERT_EQ(typesetter.cached_runs(), kCapacity - kQuarter + 1);
+
+    for (size_t i = 0; i <= kCapacity; ++i)
+    {
+        const bool evicted = i >= kQuarter && i < kQuarter * 2;
+        ASSERT_EQ(typesetter.is_cached(texts[i], attributes), !evicted) << i;
+    }
+}
+
+#ifdef USE_HEIMDALL
+TEST(TypesetterTest, ReloadsOnlyLoadedFonts)
+{
+    if (!has_font())
+        return;  // There is no system font to shape with.
+
+    const std::string font_face;
+    const TextAttributes attributes{font_face, kFontSize, TextAlignment::Left};
+
+    Typesetter typesetter;
+    const auto expected = typesetter.layout_text("Rainbow", attributes);
+
+    ASSERT_FALSE(typesetter.reload("TypesetterTest.ttf"));
+    ASSERT_EQ(typesetter.cached_runs(), 1U);
+    ASSERT_TRUE(typesetter.is_cached("Rainbow", attributes));
+
+    ASSERT_TRUE(typesetter.reload(font_face));
+    ASSERT_EQ(typesetter.cached_runs(), 0U);
+    ASSERT_EQ(typesetter.font_cache().find(font_face), nullptr);
+
+    // The font is loaded again on next use.
+    assert_same_layout(
+        typesetter.layout_text("Rainbow", attributes), expected);
+}
+#endif  // USE_HEIMDALL
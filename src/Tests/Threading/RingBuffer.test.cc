@@ -0,0 +1,115 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Threading/RingBuffer.h"
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using rainbow::RingBuffer;
+
+TEST(RingBufferTest, RoundsCapacityUpToPowerOfTwo)
+{
+    ASSERT_EQ(RingBuffer<int>{1}.capacity(), 1U);
+    ASSERT_EQ(RingBuffer<int>{5}.capacity(), 8U);
+    ASSERT_EQ(RingBuffer<int>{64}.capacity(), 64U);
+}
+
+TEST(RingBufferTest, PushesAndPopsSingleItems)
+{
+    RingBuffer<int> ring{4};
+
+    ASSERT_TRUE(ring.empty());
+
+    int item = 0;
+    ASSERT_FALSE(ring.pop(item));
+
+    for (int i = 0; i < 4; ++i)
+        ASSERT_TRUE(ring.push(i));
+
+    ASSERT_FALSE(ring.push(4));
+    ASSERT_EQ(ring.size(), 4U);
+    ASSERT_EQ(ring.space(), 0U);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(ring.pop(item));
+        ASSERT_EQ(item, i);
+    }
+
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(RingBufferTest, WrapsAround)
+{
+    RingBuffer<int> ring{8};
+
+    std::vector<int> items(6);
+    std::iota(items.begin(), items.end(), 0);
+
+    std::vector<int> out(8);
+    for (int round = 0; round < 5; ++round)
+    {
+        ASSERT_EQ(ring.push(items.data(), items.size()), items.size());
+        ASSERT_EQ(ring.pop(out.data(), out.size()), items.size());
+        for (size_t i = 0; i < items.size(); ++i)
+            ASSERT_EQ(out[i], items[i]);
+    }
+}
+
+TEST(RingBufferTest, PushesOnlyWhatFits)
+{
+    RingBuffer<int> ring{8};
+
+    std::vector<int> items(10);
+    std::iota(items.begin(), items.end(), 0);
+
+    ASSERT_EQ(ring.push(items.data(), 5), 5U);
+    ASSERT_EQ(ring.push(items.data() + 5, 5), 3U);
+    ASSERT_EQ(ring.size(), 8U);
+
+    std::vector<int> out(10);
+    ASSERT_EQ(ring.pop(out.data(), out.size()), 8U);
+    for (int i = 0; i < 8; ++i)
+        ASSERT_EQ(out[i], i);
+}
+
+TEST(RingBufferTest, TransfersItemsBetweenThreads)
+{
+    constexpr int kCount = 20000;
+
+    RingBuffer<int> ring{64};
+    std::thread producer([&ring] {
+        int next = 0;
+        int batch[7];
+        while (next < kCount)
+        {
+            const int n = std::min(kCount - next, 7);
+            std::iota(batch, batch + n, next);
+            const auto pushed = ring.push(batch, n);
+            if (pushed == 0)
+                std::this_thread::yield();
+
+            next += static_cast<int>(pushed);
+        }
+    });
+
+    int expected = 0;
+    int batch[5];
+    while (expected < kCount)
+    {
+        const auto n = ring.pop(batch, 5);
+        if (n == 0)
+            std::this_thread::yield();
+
+        for (size_t i = 0; i < n; ++i)
+            ASSERT_EQ(batch[i], expected++);
+    }
+
+    producer.join();
+    ASSERT_TRUE(ring.empty());
+}
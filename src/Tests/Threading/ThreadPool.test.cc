@@ -0,0 +1,91 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Threading/ThreadPool.h"
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using rainbow::ThreadPool;
+
+TEST(ThreadPoolTest, RunsTasksInlineWithoutWorkers)
+{
+    ThreadPool pool{0};
+
+    ASSERT_EQ(pool.size(), 0U);
+
+    bool ran = false;
+    pool.submit([&ran] { ran = true; });
+
+    ASSERT_TRUE(ran);
+
+    std::vector<int> visited(7);
+    pool.parallel_for(visited.size(), [&visited](size_t i) { ++visited[i]; });
+
+    for (auto&& count : visited)
+        ASSERT_EQ(count, 1);
+}
+
+TEST(ThreadPoolTest, RunsAllSubmittedTasks)
+{
+    constexpr int kNumTasks = 100;
+
+    std::atomic<int> count{0};
+    {
+        ThreadPool pool{3};
+        for (int i = 0; i < kNumTasks; ++i)
+            pool.submit([&count] { ++count; });
+    }
+
+    ASSERT_EQ(count, kNumTasks);
+}
+
+TEST(ThreadPoolTest, VisitsEveryIndexExactlyOnce)
+{
+    ThreadPool pool{4};
+
+    for (size_t count : {0U, 1U, 2U, 5U, 1000U})
+    {
+        std::vector<std::atomic<int>> visited(count);
+        pool.parallel_for(count, [&visited](size_t i) { ++visited[i]; });
+
+        for (auto&& v : visited)
+            ASSERT_EQ(v, 1);
+    }
+}
+
+TEST(ThreadPoolTest, NestedParallelForRunsInline)
+{
+    ThreadPool pool{2};
+
+    std::atomic<int> count{0};
+    pool.parallel_for(4, [&pool, &count](size_t) {
+        pool.parallel_for(4, [&count](size_t) { ++count; });
+    });
+
+    ASSERT_EQ(count, 16);
+    ASSERT_FALSE(ThreadPool::is_worker_thread());
+}
+
+TEST(ThreadPoolTest, DoesNotWaitForBusyWorkers)
+{
+    ThreadPool pool{2};
+
+    // Keep all workers busy until we are done.
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    for (size_t i = 0; i < pool.size(); ++i)
+        pool.submit([released] { released.wait(); });
+
+    std::vector<int> visited(8);
+    pool.parallel_for(visited.size(), [&visited](size_t i) { ++visited[i]; });
+
+    release.set_value();
+
+    for (auto&& count : visited)
+        ASSERT_EQ(count, 1);
+}
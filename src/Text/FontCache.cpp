@@ -4,61 +4,291 @@
 
 #include "Text/FontCache.h"
 
+#include <cmath>
+#include <mutex>
+
 #include "Common/Logging.h"
 #include "Common/TypeCast.h"
+#include "Cooker/Formats.h"
+#include "FileSystem/AssetCache.h"
 #include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
 #include "Graphics/Image.h"
 #include "Text/SystemFonts.h"
+#include "Text/Workspace.h"
+#include "Threading/ThreadPool.h"
 
-using rainbow::Color;
+using rainbow::AssetCache;
+using rainbow::Data;
+using rainbow::File;
+using rainbow::FileType;
 using rainbow::FontCache;
 using rainbow::SpriteVertex;
+using rainbow::ThreadPool;
+using rainbow::Typesetter;
 using rainbow::Vec2i;
+using rainbow::narrow_cast;
 using rainbow::graphics::TextureProvider;
 
 namespace
 {
-    /// <summary>Horizontal/vertical resolution in dpi.</summary>
-    constexpr uint32_t kDPI = 96;
-
-    constexpr int kGlyphMargin = 1;
-
     /// <summary>26.6 fixed-point pixel coordinates.</summary>
     constexpr int kPixelFormat = 64;
 
     constexpr size_t kTextureSizeBytes =
-        FontCache::kTextureSize * FontCache::kTextureSize * 4;
+        FontCache::kTextureSize * FontCache::kTextureSize;
+
+    constexpr double kInfinity = 1e20;
 
     void blit(const uint8_t* src,
               const stbrp_rect& src_rect,
-              Color* dst,
+              uint8_t* dst,
               const Vec2i& dst_sz)
     {
         for (uint32_t row = 0; row < src_rect.h; ++row)
         {
             auto out = dst + ((src_rect.y + row) * dst_sz.x + src_rect.x);
-            const auto begin = src + src_rect.w * row;
-            std::transform(begin, begin + src_rect.w, out, [](uint8_t alpha) {
-                // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
-                return Color{0xff, alpha};
-            });
+            std::copy_n(src + src_rect.w * row, src_rect.w, out);
+        }
+    }
+
+    /// <summary>
+    ///   Computes the squared distance transform of <paramref name="n"/>
+    ///   samples, <paramref name="stride"/> apart, in place.
+    /// </summary>
+    /// <remarks>
+    ///   P. Felzenszwalb and D. Huttenlocher. "Distance Transforms of Sampled
+    ///   Functions". Theory of Computing, 8(19), 2012.
+    /// </remarks>
+    void distance_transform(double* grid,
+                            int n,
+                            int stride,
+                            std::vector<double>& f,
+                            std::vector<int>& v,
+                            std::vector<double>& z)
+    {
+        v[0] = 0;
+        z[0] = -kInfinity;
+        z[1] = kInfinity;
+        f[0] = grid[0];
+        for (int q = 1, k = 0; q < n; ++q)
+        {
+            f[q] = grid[q * stride];
+            double s;
+            do
+            {
+                const int r = v[k];
+                s = (f[q] - f[r] + q * q - r * r) / (q - r) / 2;
+            } while (s <= z[k] && --k > -1);
+
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = kInfinity;
+        }
+
+        for (int q = 0, k = 0; q < n; ++q)
+        {
+            while (z[k + 1] < q)
+                ++k;
+
+            const int r = v[k];
+            grid[q * stride] = f[r] + (q - r) * (q - r);
         }
     }
+
+    void distance_transform(std::vector<double>& grid,
+                            int width,
+                            int height)
+    {
+        const auto n = std::max(width, height);
+        std::vector<double> f(n);
+        std::vector<int> v(n);
+        std::vector<double> z(n + 1);
+        for (int x = 0; x < width; ++x)
+            distance_transform(grid.data() + x, height, width, f, v, z);
+        for (int y = 0; y < height; ++y)
+            distance_transform(grid.data() + y * width, width, 1, f, v, z);
+    }
+
+    auto load_font(std::string_view font_name) -> std::shared_ptr<const Data>
+    {
+        if (font_name.empty())
+        {
+            return std::make_shared<const Data>(
+                rainbow::text::monospace_font());
+        }
+
+        // Fonts with identical contents share the same buffer.
+        auto cache = AssetCache::Get();
+        auto data = cache == nullptr
+                        ? std::make_shared<const Data>(
+                              File::map(font_name.data(), FileType::Asset))
+                        : cache->load(font_name.data(), FileType::Asset);
+        return data == nullptr ? std::make_shared<const Data>() : data;
+    }
+
+    auto make_vertices(int left, int top, const stbrp_rect& rect)
+    {
+        std::array<SpriteVertex, 4> vx;
+
+        vx[0].position.x = left;
+        vx[0].position.y = narrow_cast<float>(top - rect.h);
+        vx[1].position.x = narrow_cast<float>(left + rect.w);
+        vx[1].position.y = vx[0].position.y;
+        vx[2].position.x = vx[1].position.x;
+        vx[2].position.y = narrow_cast<float>(top);
+        vx[3].position.x = vx[0].position.x;
+        vx[3].position.y = vx[2].position.y;
+
+        constexpr auto kSize = narrow_cast<float>(FontCache::kTextureSize);
+        vx[0].texcoord.x = rect.x / kSize;
+        vx[0].texcoord.y = (rect.y + rect.h) / kSize;
+        vx[1].texcoord.x = (rect.x + rect.w) / kSize;
+        vx[1].texcoord.y = vx[0].texcoord.y;
+        vx[2].texcoord.x = vx[1].texcoord.x;
+        vx[2].texcoord.y = rect.y / kSize;
+        vx[3].texcoord.x = vx[0].texcoord.x;
+        vx[3].texcoord.y = vx[2].texcoord.y;
+
+        return vx;
+    }
 }  // namespace
 
-FontCache::FontCache()
+auto rainbow::detail::make_distance_field(const FT_Bitmap& bitmap)
+    -> std::vector<uint8_t>
+{
+    constexpr auto kSpread = FontCache::kDistanceFieldSpread;
+
+    const int width = static_cast<int>(bitmap.width) + kSpread * 2;
+    const int height = static_cast<int>(bitmap.rows) + kSpread * 2;
+    const auto size = static_cast<size_t>(width) * height;
+
+    // Partially covered pixels are assumed to be crossed by the outline,
+    // which gives us sub-pixel distances near the edges.
+    std::vector<double> outer(size, kInfinity);
+    std::vector<double> inner(size, 0.0);
+    for (unsigned int y = 0; y < bitmap.rows; ++y)
+    {
+        const auto row = bitmap.buffer + y * bitmap.pitch;
+        for (unsigned int x = 0; x < bitmap.width; ++x)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+            const double coverage = row[x] / 255.0;
+            const auto i = (y + kSpread) * width + x + kSpread;
+            if (coverage >= 1.0)
+            {
+                outer[i] = 0.0;
+                inner[i] = kInfinity;
+            }
+            else if (coverage > 0.0)
+            {
+                const auto d = 0.5 - coverage;
+                outer[i] = d > 0.0 ? d * d : 0.0;
+                inner[i] = d < 0.0 ? d * d : 0.0;
+            }
+        }
+    }
+
+    distance_transform(outer, width, height);
+    distance_transform(inner, width, height);
+
+    std::vector<uint8_t> field(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        const auto d = std::sqrt(outer[i]) - std::sqrt(inner[i]);
+        const auto value = 0.5 - d / (kSpread * 2);
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+        field[i] = static_cast<uint8_t>(
+            std::lround(std::clamp(value, 0.0, 1.0) * 255));
+    }
+    return field;
+}
+
+struct FontCache::Bitmap
+{
+    uint32_t glyph_index;
+    int left;
+    int top;
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+
+    /// <summary>
+    ///   Rasterizes specified glyph at the current size of
+    ///   <paramref name="face"/>.
+    /// </summary>
+    static auto rasterize(FT_Face face,
+                          uint32_t glyph_index,
+                          bool distance_field) -> Bitmap
+    {
+        Bitmap glyph{glyph_index, 0, 0, 0, 0, {}};
+        FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER);
+        FT_GlyphSlot slot = face->glyph;
+        const FT_Bitmap& bitmap = slot->bitmap;
+
+        R_ASSERT(bitmap.num_grays == 256, "");
+        R_ASSERT(bitmap.pixel_mode == FT_PIXEL_MODE_GRAY, "");
+
+        glyph.left = slot->bitmap_left;
+        glyph.top = slot->bitmap_top;
+        glyph.width = static_cast<int>(bitmap.width);
+        glyph.height = static_cast<int>(bitmap.rows);
+        if (distance_field)
+        {
+            glyph.pixels = detail::make_distance_field(bitmap);
+            glyph.left -= kDistanceFieldSpread;
+            glyph.top += kDistanceFieldSpread;
+            glyph.width += kDistanceFieldSpread * 2;
+            glyph.height += kDistanceFieldSpread * 2;
+            return glyph;
+        }
+
+        glyph.pixels.resize(static_cast<size_t>(bitmap.width) * bitmap.rows);
+        for (uint32_t row = 0; row < bitmap.rows; ++row)
+        {
+            std::copy_n(bitmap.buffer + row * bitmap.pitch,
+                        bitmap.width,
+                        glyph.pixels.data() + row * bitmap.width);
+        }
+        return glyph;
+    }
+};
+
+struct FontCache::PrewarmQueue
+{
+    struct Batch
+    {
+        std::string font_name;
+        std::shared_ptr<const Data> font;
+        int32_t font_size;
+        std::vector<Bitmap> bitmaps;
+    };
+
+    std::mutex mutex;
+    std::vector<Batch> batches;
+};
+
+FontCache::Page::Page()
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+    bitmap = std::make_unique<uint8_t[]>(kTextureSizeBytes);
+    reset();
+}
+
+void FontCache::Page::reset()
 {
     const auto texture_size = ceil_pow2(kTextureSize);
-    stbrp_init_target(&bin_context_,
+    stbrp_init_target(&bin_context,
                       texture_size,
                       texture_size,
-                      bin_nodes_.data(),
-                      narrow_cast<int>(bin_nodes_.size()));
-
-    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
-    bitmap_ = std::make_unique<uint8_t[]>(kTextureSizeBytes);
-    std::fill_n(bitmap_.get(), kTextureSizeBytes, 0);
+                      bin_nodes.data(),
+                      narrow_cast<int>(bin_nodes.size()));
+    std::fill_n(bitmap.get(), kTextureSizeBytes, 0);
+}
 
+FontCache::FontCache() : prewarmed_(std::make_shared<PrewarmQueue>())
+{
     FT_Init_FreeType(&library_);
     R_ASSERT(library_, "Failed to initialise FreeType");
 
@@ -76,19 +306,24 @@ FontCache::~FontCache()
     FT_Done_FreeType(library_);
 }
 
+auto FontCache::data(std::string_view font_name)
+    -> std::shared_ptr<const Data>
+{
+    get(font_name);
+    return font_cache_.find(font_name)->second.data;
+}
+
 auto FontCache::get(std::string_view font_name) -> FT_Face
 {
     auto search = font_cache_.find(font_name);
     if (search == font_cache_.end())
     {
-        auto data = font_name.empty()
-                        ? text::monospace_font()
-                        : File::read(font_name.data(), FileType::Asset);
+        auto data = load_font(font_name);
         FT_Face face;
         [[maybe_unused]] FT_Error error =
             FT_New_Memory_Face(library_,
-                               data.as<FT_Byte*>(),
-                               narrow_cast<FT_Long>(data.size()),
+                               data->as<FT_Byte*>(),
+                               narrow_cast<FT_Long>(data->size()),
                                0,
                                &face);
 
@@ -100,38 +335,361 @@ auto FontCache::get(std::string_view font_name) -> FT_Face
         R_ASSERT(error == FT_Err_Ok, "Failed to select character map");
 
         font_cache_.emplace(font_name, FontFace{face, std::move(data)});
+        if (!font_name.empty())
+            load_atlas(font_name, face);
+
         return face;
     }
 
     return search->second.face;
 }
 
-auto FontCache::get_glyph(FT_Face face, int32_t font_size, uint32_t glyph_index)
-    -> std::array<SpriteVertex, 4>
+auto FontCache::get_glyph(FT_Face face,
+                          int32_t font_size,
+                          uint32_t glyph_index,
+                          GlyphRendering rendering) -> Glyph
 {
-    const Index cache_index{face, font_size, glyph_index};
-    auto search = glyph_cache_.find(cache_index);
-    if (search == glyph_cache_.end())
+    return get_glyphs(face, font_size, {glyph_index}, rendering)[0];
+}
+
+auto FontCache::get_glyphs(FT_Face face,
+                           int32_t font_size,
+                           const std::vector<uint32_t>& glyph_indices,
+                           GlyphRendering rendering) -> std::vector<Glyph>
+{
+    // Distance field glyphs are shared by all font sizes.
+    const bool distance_field = rendering == GlyphRendering::DistanceField;
+    const auto cache_size = distance_field ? 0 : font_size;
+
+    // Pages holding glyphs we already have must be marked as used before
+    // packing the misses, or they may get evicted.
+    std::vector<uint32_t> misses;
+    for (auto glyph_index : glyph_indices)
     {
-        FT_Set_Char_Size(face, 0, font_size * kPixelFormat, 0, kDPI);
-        FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER);
-        FT_GlyphSlot slot = face->glyph;
-        const FT_Bitmap& bitmap = slot->bitmap;
+        auto search = glyph_cache_.find(Index{face, cache_size, glyph_index});
+        if (search == glyph_cache_.end())
+            misses.push_back(glyph_index);
+        else
+            touch(search->second.page);
+    }
 
-        R_ASSERT(bitmap.num_grays == 256, "");
-        R_ASSERT(bitmap.pixel_mode == FT_PIXEL_MODE_GRAY, "");
+    if (!misses.empty())
+    {
+        std::sort(misses.begin(), misses.end());
+        misses.erase(std::unique(misses.begin(), misses.end()), misses.end());
+
+        const auto size = distance_field ? kDistanceFieldSize : font_size;
+        FT_Set_Char_Size(face, 0, size * kPixelFormat, 0, kDPI);
+
+        std::vector<Bitmap> bitmaps;
+        bitmaps.reserve(misses.size());
+        for (auto glyph_index : misses)
+        {
+            bitmaps.push_back(
+                Bitmap::rasterize(face, glyph_index, distance_field));
+        }
+        store(face, cache_size, bitmaps);
+    }
+
+    std::vector<Glyph> glyphs;
+    glyphs.reserve(glyph_indices.size());
+    for (auto glyph_index : glyph_indices)
+    {
+        auto search = glyph_cache_.find(Index{face, cache_size, glyph_index});
+        glyphs.push_back(search == glyph_cache_.end() ? Glyph{}
+                                                      : search->second);
+    }
+    return glyphs;
+}
+
+void FontCache::prewarm(std::string_view font_name,
+                        int32_t font_size,
+                        ArrayView<uint32_t> code_points,
+                        GlyphRendering rendering)
+{
+    const bool distance_field = rendering == GlyphRendering::DistanceField;
+    auto task = [queue = prewarmed_,
+                 font = data(font_name),
+                 font_name = std::string{font_name},
+                 font_size = distance_field ? 0 : font_size,
+                 size = distance_field ? kDistanceFieldSize : font_size,
+                 code_points = std::vector<uint32_t>(code_points.begin(),
+                                                     code_points.end()),
+                 distance_field]() {
+        // FreeType faces must not be shared between threads.
+        auto& workspace = Typesetter::Workspace::get();
+        auto face = workspace.get_face(font_name, font, size);
+
+        std::vector<uint32_t> glyph_indices;
+        glyph_indices.reserve(code_points.size());
+        for (auto code_point : code_points)
+        {
+            const auto glyph_index = FT_Get_Char_Index(face, code_point);
+            if (glyph_index != 0)
+                glyph_indices.push_back(glyph_index);
+        }
+
+        std::sort(glyph_indices.begin(), glyph_indices.end());
+        glyph_indices.erase(
+            std::unique(glyph_indices.begin(), glyph_indices.end()),
+            glyph_indices.end());
+
+        std::vector<Bitmap> bitmaps;
+        bitmaps.reserve(glyph_indices.size());
+        for (auto glyph_index : glyph_indices)
+        {
+            bitmaps.push_back(
+                Bitmap::rasterize(face, glyph_index, distance_field));
+        }
+
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->batches.push_back(
+            {std::move(font_name), font, font_size, std::move(bitmaps)});
+    };
+    ThreadPool::shared().submit(std::move(task));
+}
+
+void FontCache::load_atlas(std::string_view font_name, FT_Face face)
+{
+    const auto path = std::string{font_name} + ".atlas";
+    if (!filesystem::exists(path.c_str()))
+        return;
+
+    const auto data = File::map(path.c_str(), FileType::Asset);
+    const auto header = cooker::header_of<cooker::GlyphAtlasHeader>(
+        data.bytes(), data.size());
+    const auto records_size =
+        sizeof(cooker::GlyphRecord) * (header ? header->glyph_count : 0);
+    const auto pixels_size =
+        header ? static_cast<size_t>(header->width) * header->height : 0;
+    if (header == nullptr ||
+        data.size() < sizeof(*header) + records_size + pixels_size)
+    {
+        LOGE("FontCache: Invalid glyph atlas: %s", path.c_str());
+        return;
+    }
+
+    stbrp_rect page{0, header->width, header->height, 0, 0, 0};
+    const auto page_index = pack(page);
+    if (page.was_packed == 0)
+    {
+        LOGW("FontCache: No room for glyph atlas: %s", path.c_str());
+        return;
+    }
+
+    auto& target = *pages_[page_index];
+    blit(data.bytes() + sizeof(*header) + records_size,
+         page,
+         target.bitmap.get(),
+         {kTextureSize, kTextureSize});
+    target.dirty.add(page);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto records = reinterpret_cast<const cooker::GlyphRecord*>(
+        data.bytes() + sizeof(*header));
+    for (uint32_t i = 0; i < header->glyph_count; ++i)
+    {
+        const auto& record = records[i];
+        if (record.x + record.width > header->width ||
+            record.y + record.height > header->height)
+        {
+            LOGW("FontCache: Glyph %u is out of bounds in %s",
+                 record.glyph_index,
+                 path.c_str());
+            continue;
+        }
 
-        stbrp_rect rect{
+        const stbrp_rect rect{
             0,
+            record.width,
+            record.height,
+            static_cast<stbrp_coord>(page.x + record.x),
+            static_cast<stbrp_coord>(page.y + record.y),
+            1,
+        };
+        glyph_cache_.try_emplace(
+            Index{face, record.font_size, record.glyph_index},
+            Glyph{make_vertices(record.left, record.top, rect), page_index});
+    }
+}
+
+auto FontCache::acquire_page() -> uint32_t
+{
+    // Reuse the least recently used page, unless we are still below the
+    // limit, or all pages are in use.
+    auto lru = std::min_element(
+        std::begin(pages_), std::end(pages_), [](auto&& lhs, auto&& rhs) {
+            return lhs->last_used < rhs->last_used;
+        });
+    if (pages_.size() < kMaxPages || (*lru)->last_used == frame_)
+    {
+        if (pages_.size() >= kMaxPages)
+            LOGW("FontCache: All %u texture pages are in use", page_count());
+
+        pages_.push_back(std::make_unique<Page>());
+        return page_count() - 1;
+    }
+
+    const auto index = narrow_cast<uint32_t>(lru - std::begin(pages_));
+    for (auto i = glyph_cache_.begin(); i != glyph_cache_.end();)
+    {
+        if (i->second.page == index)
+            glyph_cache_.erase(i++);
+        else
+            ++i;
+    }
+
+    // Margins around new glyphs must be cleared on the GPU as well.
+    auto& page = **lru;
+    page.reset();
+    page.dirty = {0, 0, kTextureSize, kTextureSize};
+    ++page.generation;
+    return index;
+}
+
+void FontCache::commit_prewarmed()
+{
+    std::vector<PrewarmQueue::Batch> batches;
+    {
+        std::lock_guard<std::mutex> lock(prewarmed_->mutex);
+        batches.swap(prewarmed_->batches);
+    }
+
+    for (auto&& batch : batches)
+    {
+        // The font may have been reloaded while we were busy.
+        auto font = font_cache_.find(batch.font_name);
+        if (font == font_cache_.end() || font->second.data != batch.font)
+            continue;
+
+        const auto face = font->second.face;
+        auto& bitmaps = batch.bitmaps;
+        bitmaps.erase(
+            std::remove_if(
+                bitmaps.begin(),
+                bitmaps.end(),
+                [this, face, font_size = batch.font_size](auto&& bitmap) {
+                    return glyph_cache_.contains(
+                        Index{face, font_size, bitmap.glyph_index});
+                }),
+            bitmaps.end());
+        store(face, batch.font_size, bitmaps);
+    }
+}
+
+auto FontCache::pack(stbrp_rect& rect) -> uint32_t
+{
+    std::vector<stbrp_rect> rects{rect};
+    std::vector<uint32_t> pages;
+    pack(rects, pages);
+    rect = rects[0];
+    return pages[0];
+}
+
+void FontCache::pack(std::vector<stbrp_rect>& rects,
+                     std::vector<uint32_t>& pages)
+{
+    pages.assign(rects.size(), kInvalidPage);
+
+    // Rectangles are packed together so that stb_rect_pack can sort them,
+    // which packs a lot tighter than adding them one by one.
+    std::vector<stbrp_rect> pending;
+    pending.reserve(rects.size());
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        auto& rect = rects[i];
+        rect.was_packed = 0;
+        if (rect.w > kTextureSize || rect.h > kTextureSize)
+            continue;
+
+        pending.push_back(rect);
+        pending.back().id = narrow_cast<int>(i);
+    }
+
+    auto pack_into = [this, &rects, &pages, &pending](uint32_t page) {
+        stbrp_pack_rects(&pages_[page]->bin_context,
+                         pending.data(),
+                         narrow_cast<int>(pending.size()));
+        auto packed = std::partition(
+            pending.begin(), pending.end(), [](auto&& rect) {
+                return rect.was_packed == 0;
+            });
+        if (packed == pending.end())
+            return false;
+
+        touch(page);
+        std::for_each(packed, pending.end(), [&rects, &pages, page](auto&& r) {
+            auto& rect = rects[r.id];
+            rect.x = r.x;
+            rect.y = r.y;
+            rect.was_packed = 1;
+            pages[r.id] = page;
+        });
+        pending.erase(packed, pending.end());
+        return true;
+    };
+
+    for (uint32_t i = 0; i < page_count() && !pending.empty(); ++i)
+        pack_into(i);
+
+    // Anything that doesn't fit on an empty page, never will.
+    while (!pending.empty() && pack_into(acquire_page()))
+        ;
+}
+
+#ifdef USE_HEIMDALL
+auto FontCache::reload(std::string_view font_name) -> bool
+{
+    auto search = font_cache_.find(font_name);
+    if (search == font_cache_.end())
+        return false;
+
+    auto face = search->second.face;
+    for (auto i = glyph_cache_.begin(); i != glyph_cache_.end();)
+    {
+        if (i->first.face == face)
+            glyph_cache_.erase(i++);
+        else
+            ++i;
+    }
+
+    FT_Done_Face(face);
+    font_cache_.erase(search);
+    return true;
+}
+#endif  // USE_HEIMDALL
+
+void FontCache::store(FT_Face face,
+                      int32_t font_size,
+                      std::vector<Bitmap>& bitmaps)
+{
+    std::vector<stbrp_rect> rects;
+    rects.reserve(bitmaps.size());
+    for (auto&& bitmap : bitmaps)
+    {
+        rects.push_back({
+            narrow_cast<int>(rects.size()),
             static_cast<stbrp_coord>(bitmap.width + kGlyphMargin * 2),
-            static_cast<stbrp_coord>(bitmap.rows + kGlyphMargin * 2),
+            static_cast<stbrp_coord>(bitmap.height + kGlyphMargin * 2),
+            0,
             0,
             0,
-            0};
-        stbrp_pack_rects(&bin_context_, &rect, 1);
+        });
+    }
 
-        R_ASSERT(rect.was_packed != 0,
-                 "Failed to pack a glyph, please increase your texture size");
+    std::vector<uint32_t> pages;
+    pack(rects, pages);
+
+    for (auto&& rect : rects)
+    {
+        if (rect.was_packed == 0)
+        {
+            LOGW("FontCache: Glyph %u (%dx%d) does not fit in a texture page",
+                 bitmaps[rect.id].glyph_index,
+                 bitmaps[rect.id].width,
+                 bitmaps[rect.id].height);
+            continue;
+        }
 
         // Adjust coordinates to compensate for margins.
         rect.w -= kGlyphMargin * 2;
@@ -139,59 +697,87 @@ auto FontCache::get_glyph(FT_Face face, int32_t font_size, uint32_t glyph_index)
         rect.x += kGlyphMargin;
         rect.y += kGlyphMargin;
 
-        blit(bitmap.buffer,
+        const auto& bitmap = bitmaps[rect.id];
+        const auto page = pages[rect.id];
+        auto& target = *pages_[page];
+        blit(bitmap.pixels.data(),
              rect,
-             reinterpret_cast<Color*>(bitmap_.get()),
+             target.bitmap.get(),
              {kTextureSize, kTextureSize});
-        state_ = State::NeedsUpdate;
-
-        std::array<SpriteVertex, 4> vx;
-
-        vx[0].position.x = slot->bitmap_left;
-        vx[0].position.y = narrow_cast<float>(slot->bitmap_top -
-                                              narrow_cast<FT_Int>(bitmap.rows));
-        vx[1].position.x = narrow_cast<float>(slot->bitmap_left + bitmap.width);
-        vx[1].position.y = vx[0].position.y;
-        vx[2].position.x = vx[1].position.x;
-        vx[2].position.y = narrow_cast<float>(slot->bitmap_top);
-        vx[3].position.x = vx[0].position.x;
-        vx[3].position.y = vx[2].position.y;
-
-        vx[0].texcoord.x = rect.x / narrow_cast<float>(kTextureSize);
-        vx[0].texcoord.y = (rect.y + rect.h) / narrow_cast<float>(kTextureSize);
-        vx[1].texcoord.x = (rect.x + rect.w) / narrow_cast<float>(kTextureSize);
-        vx[1].texcoord.y = vx[0].texcoord.y;
-        vx[2].texcoord.x = vx[1].texcoord.x;
-        vx[2].texcoord.y = rect.y / narrow_cast<float>(kTextureSize);
-        vx[3].texcoord.x = vx[0].texcoord.x;
-        vx[3].texcoord.y = vx[2].texcoord.y;
+        target.dirty.add(rect);
 
-        glyph_cache_[cache_index] = {vx};
-        return vx;
+        glyph_cache_.try_emplace(
+            Index{face, font_size, bitmap.glyph_index},
+            Glyph{make_vertices(bitmap.left, bitmap.top, rect), page});
     }
-
-    return search->second.vertices;
 }
 
 void FontCache::update(TextureProvider& texture_provider)
 {
-    if (state_ != State::Ready)
+    commit_prewarmed();
+
+    for (uint32_t i = 0; i < page_count(); ++i)
     {
+        auto& page = *pages_[i];
+        if (page.dirty.empty())
+            continue;
+
+        if (!page.texture)
+        {
+            const auto image = Image{
+                Image::Format::Luminance,
+                narrow_cast<uint32_t>(kTextureSize),
+                narrow_cast<uint32_t>(kTextureSize),
+                8U,
+                1U,
+                kTextureSizeBytes,
+                page.bitmap.get(),
+            };
+            const auto id = "rainbow://font-cache/" + std::to_string(i);
+            page.texture = texture_provider.get(id, image);
+            page.dirty = {};
+            continue;
+        }
+
+        // Only upload the region that has changed. Rows spanning the whole
+        // texture are already contiguous; others must be copied first.
+        const auto& dirty = page.dirty;
+        const int width = dirty.right - dirty.left;
+        const int height = dirty.bottom - dirty.top;
+        const auto row_size = narrow_cast<size_t>(width);
+        const auto first_row =
+            page.bitmap.get() + dirty.top * kTextureSize + dirty.left;
+        const uint8_t* pixels = first_row;
+        if (width < kTextureSize)
+        {
+            staging_.resize(row_size * height);
+            for (int row = 0; row < height; ++row)
+            {
+                std::copy_n(first_row + row * kTextureSize,
+                            row_size,
+                            staging_.data() + row * row_size);
+            }
+            pixels = staging_.data();
+        }
+
         const auto image = Image{
-            Image::Format::RGBA,
-            narrow_cast<uint32_t>(kTextureSize),
-            narrow_cast<uint32_t>(kTextureSize),
-            32U,
-            4U,
-            kTextureSizeBytes,
-            bitmap_.get(),
+            Image::Format::Luminance,
+            narrow_cast<uint32_t>(width),
+            narrow_cast<uint32_t>(height),
+            8U,
+            1U,
+            row_size * height,
+            pixels,
         };
-        if (!texture_)
-            texture_ = texture_provider.get("rainbow://font-cache", image);
-        else
-            texture_provider.update(texture_, image);
-        state_ = State::Ready;
+        texture_provider.update_region(page.texture,
+                                       image,
+                                       narrow_cast<uint32_t>(dirty.left),
+                                       narrow_cast<uint32_t>(dirty.top));
+        page.dirty = {};
     }
+
+    // Pages used from here on belong to the next frame.
+    ++frame_;
 }
 
 #define STB_RECT_PACK_IMPLEMENTATION
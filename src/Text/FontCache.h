@@ -5,8 +5,12 @@
 #ifndef TEXT_FONTCACHE_H_
 #define TEXT_FONTCACHE_H_
 
+#include <algorithm>
 #include <array>
+#include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 // clang-format off
 #include "ThirdParty/DisableWarnings.h"
@@ -20,41 +24,222 @@
 
 #include "Common/Data.h"
 #include "Common/Global.h"
+#include "Common/TypeCast.h"
 #include "Graphics/SpriteVertex.h"
 #include "Graphics/Texture.h"
+#include "Memory/Array.h"
 #include "Memory/ArrayMap.h"
 
 namespace rainbow
 {
+    enum class GlyphRendering
+    {
+        /// <summary>
+        ///   Glyphs are rasterized for every font size they are used with.
+        /// </summary>
+        Coverage,
+
+        /// <summary>
+        ///   Glyphs are rasterized once as signed distance fields, and scaled
+        ///   to any font size. Must be drawn with the distance field shader.
+        /// </summary>
+        DistanceField,
+    };
+
+    namespace detail
+    {
+        /// <summary>
+        ///   Returns the signed distance field of a glyph bitmap, padded by
+        ///   <see cref="FontCache::kDistanceFieldSpread"/> on all sides. The
+        ///   outline is at 0.5; values increase inwards.
+        /// </summary>
+        auto make_distance_field(const FT_Bitmap& bitmap)
+            -> std::vector<uint8_t>;
+    }  // namespace detail
+
+    /// <summary>
+    ///   Rasterizes glyphs on demand and stores them in texture pages.
+    /// </summary>
+    /// <remarks>
+    ///   <para>
+    ///     Pages are added as they fill up. Once there are
+    ///     <see cref="FontCache::kMaxPages"/> pages, the least recently used
+    ///     page is cleared and reused instead. Only glyphs stored on that page
+    ///     need to be rasterized again.
+    ///   </para>
+    ///   <para>
+    ///     Pages that have been used in the current frame are never evicted;
+    ///     if there are no other pages, a page is added regardless of the
+    ///     limit.
+    ///   </para>
+    ///   <para>
+    ///     Glyphs that are needed together should be requested together with
+    ///     <see cref="FontCache::get_glyphs"/>, so that misses are packed in
+    ///     one go. Glyphs known to be needed later can be rasterized on a
+    ///     worker thread with <see cref="FontCache::prewarm"/>.
+    ///   </para>
+    /// </remarks>
     class FontCache : public Global<FontCache>
     {
     public:
-        static constexpr auto kTextureSize = 1024;
+        /// <summary>Horizontal/vertical resolution in dpi.</summary>
+        static constexpr uint32_t kDPI = 96;
+
+        /// <summary>Empty space around each glyph in the texture.</summary>
+        static constexpr int kGlyphMargin = 1;
+
+        /// <summary>
+        ///   Font size that distance field glyphs are rasterized at.
+        /// </summary>
+        static constexpr int32_t kDistanceFieldSize = 32;
+
+        /// <summary>
+        ///   Largest distance, in pixels at <see cref="kDistanceFieldSize"/>,
+        ///   stored in distance field glyphs.
+        /// </summary>
+        static constexpr int kDistanceFieldSpread = 6;
+
+        /// <summary>
+        ///   Number of texture pages to keep before evicting old glyphs.
+        /// </summary>
+        static constexpr size_t kMaxPages = 4;
+
+        /// <summary>
+        ///   Width and height of a glyph texture page. Glyphs are stored as
+        ///   8-bit coverage values, and are tinted by the text shader.
+        /// </summary>
+        static constexpr auto kTextureSize = 2048;
+
+        /// <summary>
+        ///   Page of glyphs that could not be stored, e.g. because they are
+        ///   larger than a texture page. Such glyphs must not be drawn.
+        /// </summary>
+        static constexpr uint32_t kInvalidPage =
+            std::numeric_limits<uint32_t>::max();
+
+        struct Glyph
+        {
+            std::array<SpriteVertex, 4> vertices;
+            uint32_t page = kInvalidPage;
+        };
 
         FontCache();
         ~FontCache();
 
-        [[nodiscard]] auto texture() const -> const graphics::Texture&
+        /// <summary>
+        ///   Returns the generation of specified page. It is incremented every
+        ///   time the page is evicted, invalidating all glyphs previously
+        ///   stored on it. Pages that do not exist are always at generation
+        ///   0.
+        /// </summary>
+        [[nodiscard]] auto generation(uint32_t page) const -> uint32_t
         {
-            return texture_;
+            return page < pages_.size() ? pages_[page]->generation : 0;
+        }
+
+        /// <summary>Returns the number of texture pages.</summary>
+        [[nodiscard]] auto page_count() const
+        {
+            return narrow_cast<uint32_t>(pages_.size());
+        }
+
+        [[nodiscard]] auto texture(uint32_t page) const
+            -> const graphics::Texture&
+        {
+            return pages_[page]->texture;
+        }
+
+        /// <summary>
+        ///   Returns the file backing specified font, loading the font if
+        ///   necessary.
+        /// </summary>
+        auto data(std::string_view font_name) -> std::shared_ptr<const Data>;
+
+        /// <summary>
+        ///   Returns the face of specified font if it is loaded; otherwise
+        ///   <c>nullptr</c>.
+        /// </summary>
+        [[nodiscard]] auto find(std::string_view font_name) const -> FT_Face
+        {
+            auto search = font_cache_.find(font_name);
+            return search == font_cache_.end() ? nullptr : search->second.face;
         }
 
         auto get(std::string_view font_name) -> FT_Face;
-        auto get_glyph(FT_Face face, int32_t font_size, uint32_t glyph_index)
-            -> std::array<SpriteVertex, 4>;
+        /// <summary>
+        ///   Returns the vertices of specified glyph, rasterizing it if needed.
+        ///   Distance field glyphs are returned at
+        ///   <see cref="kDistanceFieldSize"/>, and must be scaled to
+        ///   <paramref name="font_size"/> by the caller. Glyphs that could not
+        ///   be stored are returned with <see cref="kInvalidPage"/>.
+        /// </summary>
+        auto get_glyph(FT_Face face,
+                       int32_t font_size,
+                       uint32_t glyph_index,
+                       GlyphRendering rendering = GlyphRendering::Coverage)
+            -> Glyph;
+
+        /// <summary>
+        ///   Returns the vertices of specified glyphs, in the same order.
+        ///   Glyphs that are not cached are rasterized and packed as a batch.
+        /// </summary>
+        auto get_glyphs(FT_Face face,
+                        int32_t font_size,
+                        const std::vector<uint32_t>& glyph_indices,
+                        GlyphRendering rendering = GlyphRendering::Coverage)
+            -> std::vector<Glyph>;
+
+        /// <summary>
+        ///   Rasterizes the glyphs of <paramref name="code_points"/> on a
+        ///   worker thread, using the worker's own FreeType objects. The
+        ///   glyphs are added to the cache on the next <see cref="update"/>
+        ///   after they are done. Available to scripts as
+        ///   <c>Rainbow.FontCache.prewarm()</c>.
+        /// </summary>
+        void prewarm(std::string_view font_name,
+                     int32_t font_size,
+                     ArrayView<uint32_t> code_points,
+                     GlyphRendering rendering = GlyphRendering::Coverage);
+
+        /// <summary>
+        ///   Marks specified page as used, preventing it from being evicted
+        ///   during the current frame.
+        /// </summary>
+        void touch(uint32_t page)
+        {
+            if (page < pages_.size())
+                pages_[page]->last_used = frame_;
+        }
+
+#ifdef USE_HEIMDALL
+        /// <summary>
+        ///   Unloads specified font, and drops its glyphs from the glyph
+        ///   cache. It is loaded again on next use.
+        /// </summary>
+        /// <remarks>
+        ///   Space in the glyph texture is not reclaimed, and labels keep
+        ///   using the previous glyphs until they are laid out again.
+        /// </remarks>
+        /// <returns>Whether specified font was loaded.</returns>
+        auto reload(std::string_view font_name) -> bool;
+#endif  // USE_HEIMDALL
 
         void update(graphics::TextureProvider&);
 
     private:
+        /// <summary>A rasterized glyph that has yet to be packed.</summary>
+        struct Bitmap;
+
+        /// <summary>
+        ///   Glyphs rasterized by <see cref="prewarm"/>, waiting to be added
+        ///   to the cache.
+        /// </summary>
+        struct PrewarmQueue;
+
         struct FontFace
         {
             FT_Face face;
-            Data data;
-        };
-
-        struct GlyphInfo
-        {
-            std::array<SpriteVertex, 4> vertices;
+            std::shared_ptr<const Data> data;
         };
 
         struct Index
@@ -77,20 +262,92 @@ namespace rainbow
             }
         };
 
-        enum class State
+        /// <summary>
+        ///   Bounding box of the glyphs that have not been uploaded yet.
+        /// </summary>
+        struct DirtyRegion
+        {
+            int left = kTextureSize;
+            int top = kTextureSize;
+            int right = 0;
+            int bottom = 0;
+
+            [[nodiscard]] auto empty() const { return left >= right; }
+
+            void add(const stbrp_rect& rect)
+            {
+                left = std::min(left, static_cast<int>(rect.x));
+                top = std::min(top, static_cast<int>(rect.y));
+                right = std::max(right, static_cast<int>(rect.x + rect.w));
+                bottom = std::max(bottom, static_cast<int>(rect.y + rect.h));
+            }
+        };
+
+        struct Page
         {
-            Ready,
-            NeedsUpdate,
+            stbrp_context bin_context;
+            std::array<stbrp_node, kTextureSize> bin_nodes;
+            std::unique_ptr<uint8_t[]> bitmap;
+            DirtyRegion dirty;
+            graphics::Texture texture;
+            uint64_t last_used = 0;
+            uint32_t generation = 0;
+
+            Page();
+
+            /// <summary>
+            ///   Clears the bitmap and frees up all space for new glyphs.
+            /// </summary>
+            void reset();
         };
 
-        State state_ = State::Ready;
-        graphics::Texture texture_;
-        absl::flat_hash_map<Index, GlyphInfo> glyph_cache_;
+        std::vector<std::unique_ptr<Page>> pages_;
+        std::vector<uint8_t> staging_;
+        absl::flat_hash_map<Index, Glyph> glyph_cache_;
         ArrayMap<std::string, FontFace> font_cache_;
-        stbrp_context bin_context_;
-        std::array<stbrp_node, kTextureSize> bin_nodes_;
-        std::unique_ptr<uint8_t[]> bitmap_;
+        std::shared_ptr<PrewarmQueue> prewarmed_;
+        uint64_t frame_ = 1;
         FT_Library library_;
+
+        /// <summary>
+        ///   Returns the index of a page with free space, adding a page or
+        ///   evicting the least recently used one.
+        /// </summary>
+        auto acquire_page() -> uint32_t;
+
+        /// <summary>Adds glyphs rasterized by workers to the cache.</summary>
+        void commit_prewarmed();
+
+        /// <summary>
+        ///   Loads glyphs pre-baked by the asset cooker, if
+        ///   <c>&lt;font_name&gt;.atlas</c> exists.
+        /// </summary>
+        void load_atlas(std::string_view font_name, FT_Face face);
+
+        /// <summary>
+        ///   Finds room for <paramref name="rect"/>, evicting the least
+        ///   recently used page if necessary.
+        /// </summary>
+        /// <returns>
+        ///   The page <paramref name="rect"/> was packed into, if
+        ///   <c>rect.was_packed</c> is set.
+        /// </returns>
+        auto pack(stbrp_rect& rect) -> uint32_t;
+
+        /// <summary>
+        ///   Finds room for all <paramref name="rects"/>, evicting pages as
+        ///   necessary. The page of each packed rectangle is written to
+        ///   <paramref name="pages"/>, at the same index.
+        /// </summary>
+        void pack(std::vector<stbrp_rect>& rects, std::vector<uint32_t>& pages);
+
+        /// <summary>
+        ///   Packs <paramref name="bitmaps"/> and adds them to the glyph cache.
+        ///   None of them may be in the cache already.
+        /// </summary>
+        void store(FT_Face face,
+                   int32_t font_size,
+                   std::vector<Bitmap>& bitmaps);
     };
 }  // namespace rainbow
 
@@ -4,6 +4,10 @@
 
 #include "Text/Typesetter.h"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+
 // clang-format off
 #include "ThirdParty/DisableWarnings.h"
 #include <hb.h>  // NOLINT(llvm-include-order)
@@ -11,14 +15,22 @@
 #include "ThirdParty/ReenableWarnings.h"
 // clang-format on
 
+#include <absl/container/flat_hash_set.h>
+
+#include "Common/Algorithm.h"
 #include "Common/Logging.h"
 #include "Common/String.h"
 #include "Common/TypeCast.h"
+#include "Text/Workspace.h"
+#include "Threading/ThreadPool.h"
 
 using rainbow::czstring;
+using rainbow::Data;
 using rainbow::GlyphPosition;
-using rainbow::SpriteVertex;
+using rainbow::LayoutRequest;
 using rainbow::TextAttributes;
+using rainbow::TextMesh;
+using rainbow::ThreadPool;
 using rainbow::Typesetter;
 using rainbow::Vec2f;
 
@@ -46,6 +58,36 @@ namespace
         return i;
     }
 
+    auto create_font(FT_Face face) -> hb_font_t*
+    {
+        auto font = hb_ft_font_create(face, nullptr);
+        hb_ft_font_set_load_flags(font, FT_LOAD_DEFAULT);
+        return font;
+    }
+
+    auto line_height_of(FT_Face face)
+    {
+        return face->size->metrics.height /
+               rainbow::narrow_cast<float>(kPixelFormat);
+    }
+
+    auto is_continuation_byte(std::string_view text, size_t i)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+        return i < text.size() && (text[i] & 0xc0) == 0x80;
+    }
+
+    auto is_unsafe_to_break(const hb_glyph_info_t& info)
+    {
+        return (hb_glyph_info_get_glyph_flags(&info) &
+                HB_GLYPH_FLAG_UNSAFE_TO_BREAK) != 0;
+    }
+
+    /// <summary>
+    ///   Incremented whenever all workspaces must release their fonts.
+    /// </summary>
+    std::atomic<uint32_t> g_workspace_generation{0};
+
     constexpr auto to_vec2(hb_position_t x, hb_position_t y) -> Vec2f
     {
         return Vec2f{x / rainbow::narrow_cast<float>(kPixelFormat),
@@ -53,6 +95,136 @@ namespace
     }
 }  // namespace
 
+auto Typesetter::Workspace::get() -> Workspace&
+{
+    thread_local Workspace workspace;
+    if (workspace.generation_ != g_workspace_generation)
+    {
+        workspace.clear();
+        workspace.generation_ = g_workspace_generation;
+    }
+    return workspace;
+}
+
+void Typesetter::Workspace::invalidate()
+{
+    ++g_workspace_generation;
+}
+
+Typesetter::Workspace::Workspace()
+    : buffer_(hb_buffer_create()), generation_(g_workspace_generation)
+{
+    FT_Init_FreeType(&library_);
+    R_ASSERT(library_, "Failed to initialise FreeType");
+    R_ASSERT(hb_buffer_allocation_successful(buffer_),  //
+             "Failed to allocate HarfBuzz buffer");
+}
+
+Typesetter::Workspace::~Workspace()
+{
+    clear();
+    FT_Done_FreeType(library_);
+    hb_buffer_destroy(buffer_);
+}
+
+auto Typesetter::Workspace::get_face(std::string_view font_name,
+                                     const std::shared_ptr<const Data>& data,
+                                     int32_t font_size) -> FT_Face
+{
+    auto i = faces_.find(font_name);
+    if (i != faces_.end() && i->second.data != data)
+    {
+        // The font was reloaded since we last used it.
+        release(i);
+        i = faces_.end();
+    }
+
+    if (i == faces_.end())
+    {
+        if (faces_.size() >= kMaxFaces)
+        {
+            release(std::min_element(
+                faces_.begin(), faces_.end(), [](auto&& lhs, auto&& rhs) {
+                    return lhs.second.last_used < rhs.second.last_used;
+                }));
+        }
+
+        FT_Face face = nullptr;
+        [[maybe_unused]] FT_Error error =
+            FT_New_Memory_Face(library_,
+                               data->as<const FT_Byte*>(),
+                               narrow_cast<FT_Long>(data->size()),
+                               0,
+                               &face);
+
+        R_ASSERT(error == FT_Err_Ok, "Failed to load font face");
+
+        FT_Select_Charmap(face, FT_ENCODING_UNICODE);
+        i = faces_.emplace(font_name, Face{face, data, 0}).first;
+    }
+
+    i->second.last_used = ++clock_;
+
+    auto face = i->second.face;
+    FT_Set_Char_Size(face, 0, font_size * kPixelFormat, 0, kDPI);
+    return face;
+}
+
+auto Typesetter::Workspace::get_font(std::string_view font_name,
+                                     const std::shared_ptr<const Data>& data,
+                                     int32_t font_size) -> const Font&
+{
+    auto face = get_face(font_name, data, font_size);
+    const FontKey key{face, font_size};
+    auto i = fonts_.find(key);
+    if (i == fonts_.end())
+    {
+        if (fonts_.size() >= kMaxFonts)
+            clear_fonts();
+
+        i = fonts_.emplace(key, Font{create_font(face), line_height_of(face)})
+                .first;
+    }
+
+    return i->second;
+}
+
+void Typesetter::Workspace::clear()
+{
+    clear_fonts();
+    for (auto&& [font_name, face] : faces_)
+        FT_Done_Face(face.face);
+    faces_.clear();
+}
+
+void Typesetter::Workspace::clear_fonts()
+{
+    for (auto&& [key, font] : fonts_)
+        hb_font_destroy(font.font);
+    fonts_.clear();
+}
+
+void Typesetter::Workspace::release(ArrayMap<std::string, Face>::iterator i)
+{
+    // Faces' addresses may be reused; fonts must not outlive their face.
+    const auto face = i->second.face;
+    for (auto j = fonts_.begin(); j != fonts_.end();)
+    {
+        if (j->first.face == face)
+        {
+            hb_font_destroy(j->second.font);
+            fonts_.erase(j++);
+        }
+        else
+        {
+            ++j;
+        }
+    }
+
+    FT_Done_Face(face);
+    faces_.erase(i);
+}
+
 Typesetter::Typesetter()
 {
     buffer_ = hb_buffer_create();
@@ -62,73 +234,444 @@ Typesetter::Typesetter()
 
 Typesetter::~Typesetter()
 {
+    for (auto&& [key, font] : fonts_)
+        hb_font_destroy(font.font);
     hb_buffer_destroy(buffer_);
 }
 
 auto Typesetter::draw_text(std::string_view text,
                            const Vec2f& position,
                            const TextAttributes& attributes,
-                           Vec2f* size) -> std::vector<SpriteVertex>
+                           Vec2f* size,
+                           std::string_view previous_text) -> TextMesh
 {
-    auto glyph_positions = layout_text(text, attributes, size);
-    std::vector<SpriteVertex> vertices;
-    vertices.reserve(glyph_positions.size() * 4);
-    auto font_face = font_cache_.get(attributes.font_face);
+    auto glyph_positions =
+        layout_text(text, attributes, size, previous_text);
+    std::vector<uint32_t> glyph_indices;
+    glyph_indices.reserve(glyph_positions.size());
     for (auto&& glyph : glyph_positions)
+        glyph_indices.push_back(glyph.glyph_index);
+
+    // Missing glyphs are rasterized and packed together.
+    auto glyphs = font_cache_.get_glyphs(font_cache_.get(attributes.font_face),
+                                         attributes.font_size,
+                                         glyph_indices,
+                                         attributes.rendering);
+    const auto scale =
+        attributes.rendering == GlyphRendering::DistanceField
+            ? narrow_cast<float>(attributes.font_size) /
+                  FontCache::kDistanceFieldSize
+            : 1.0F;
+    for (size_t i = 0; i < glyphs.size(); ++i)
+    {
+        auto p = glyph_positions[i].position + position;
+        for (auto&& vx : glyphs[i].vertices)
+            vx.position = vx.position * scale + p;
+    }
+
+    // Glyphs are drawn one texture page at a time.
+    std::stable_sort(
+        glyphs.begin(), glyphs.end(), [](auto&& lhs, auto&& rhs) {
+            return lhs.page < rhs.page;
+        });
+
+    TextMesh mesh;
+    mesh.vertices.reserve(glyphs.size() * 4);
+    for (auto&& glyph : glyphs)
     {
-        auto vx = font_cache_.get_glyph(
-            font_face, attributes.font_size, glyph.glyph_index);
-        auto p = glyph.position + position;
-        vx[0].position += p;
-        vx[1].position += p;
-        vx[2].position += p;
-        vx[3].position += p;
-        vertices.insert(vertices.end(), vx.begin(), vx.end());
+        // Glyphs that could not be stored have nothing to draw from.
+        if (glyph.page == FontCache::kInvalidPage)
+            continue;
+
+        if (mesh.ranges.empty() || mesh.ranges.back().page != glyph.page)
+        {
+            const auto first = narrow_cast<uint32_t>(mesh.vertices.size() / 4);
+            mesh.ranges.push_back(
+                {glyph.page, font_cache_.generation(glyph.page), first, 0});
+        }
+
+        ++mesh.ranges.back().count;
+        mesh.vertices.insert(
+            mesh.vertices.end(), glyph.vertices.begin(), glyph.vertices.end());
     }
-    return vertices;
+    return mesh;
 }
 
 auto Typesetter::layout_text(std::string_view text,
                              const TextAttributes& attributes,
-                             Vec2f* size) -> std::vector<GlyphPosition>
+                             Vec2f* size,
+                             std::string_view previous_text)
+    -> std::vector<GlyphPosition>
 {
-    std::vector<GlyphPosition> result;
-
     auto font_face = font_cache_.get(attributes.font_face);
-    FT_Set_Char_Size(
-        font_face, 0, attributes.font_size * kPixelFormat, 0, kDPI);
-    const auto line_height =
-        font_face->size->metrics.height / narrow_cast<float>(kPixelFormat);
-    auto font = hb_ft_font_create(font_face, nullptr);
-    hb_ft_font_set_load_flags(font, FT_LOAD_DEFAULT);
+    const auto key = key_of(font_face, text, attributes);
+    auto search = runs_.find(key);
+    auto& run = search != runs_.end() && search->second.text == text
+                    ? search->second
+                    : store(key,
+                            shape(font_face, text, attributes, previous_text));
+    run.last_used = ++clock_;
+
+    if (size != nullptr)
+        *size = run.size;
+
+    return run.glyphs;
+}
+
+void Typesetter::prepare(const std::vector<LayoutRequest>& requests)
+{
+    auto& thread_pool = ThreadPool::shared();
+    if (thread_pool.size() == 0 || requests.size() < kMinParallelLayouts)
+        return;
+
+    struct Job
+    {
+        RunKey key;
+        const LayoutRequest* request;
+        std::shared_ptr<const Data> font;
+        const Run* previous;
+        Run run;
+    };
+
+    std::vector<Job> jobs;
+    absl::flat_hash_set<RunKey> queued;
+    for (auto&& request : requests)
+    {
+        // Prepared runs must not evict each other before they are used.
+        if (jobs.size() == kMaxCachedRuns / 2)
+            break;
+
+        const auto& attributes = request.attributes;
+        const auto face = font_cache_.get(attributes.font_face);
+        const auto key = key_of(face, request.text, attributes);
+        auto search = runs_.find(key);
+        if ((search != runs_.end() && search->second.text == request.text) ||
+            !queued.insert(key).second)
+        {
+            continue;
+        }
+
+        // Runs are not stored until all jobs are done, so the text being
+        // replaced can safely be reused by the workers.
+        const Run* previous = nullptr;
+        if (!request.previous_text.empty())
+        {
+            const auto& previous_text = request.previous_text;
+            auto i = runs_.find(key_of(face, previous_text, attributes));
+            if (i != runs_.end() && i->second.text == previous_text)
+                previous = &i->second;
+        }
+
+        jobs.push_back({key,
+                        &request,
+                        font_cache_.data(attributes.font_face),
+                        previous,
+                        {}});
+    }
+
+    if (jobs.size() < kMinParallelLayouts)
+        return;
+
+    thread_pool.parallel_for(jobs.size(), [&jobs](size_t i) {
+        auto& job = jobs[i];
+        auto& workspace = Workspace::get();
+        const auto& attributes = job.request->attributes;
+        const auto& font = workspace.get_font(
+            attributes.font_face, job.font, attributes.font_size);
+        const auto buffer = workspace.buffer();
+        const auto text = job.request->text;
+        const auto alignment = attributes.text_alignment;
+        auto run = job.previous == nullptr
+                       ? std::nullopt
+                       : reshape(buffer, font, *job.previous, text, alignment);
+        job.run = run ? *std::move(run) : shape(buffer, font, text, alignment);
+    });
+
+    for (auto&& job : jobs)
+        store(job.key, std::move(job.run)).last_used = ++clock_;
+}
+
+#ifdef USE_HEIMDALL
+auto Typesetter::reload(std::string_view font_name) -> bool
+{
+    const auto face = font_cache_.find(font_name);
+    if (face == nullptr)
+        return false;
+
+    // The face is about to be released; its address may be reused.
+    for (auto i = fonts_.begin(); i != fonts_.end();)
+    {
+        if (i->first.face == face)
+        {
+            hb_font_destroy(i->second.font);
+            fonts_.erase(i++);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    for (auto i = runs_.begin(); i != runs_.end();)
+    {
+        if (i->first.face == face)
+            runs_.erase(i++);
+        else
+            ++i;
+    }
+
+    Workspace::invalidate();
+    return font_cache_.reload(font_name);
+}
+#endif  // USE_HEIMDALL
+
+auto Typesetter::get_font(FT_Face face, int32_t font_size) -> const Font&
+{
+    // `FontCache` may have rendered glyphs at a different size since last
+    // time. HarfBuzz reads advances off the face so it must be set first.
+    FT_Set_Char_Size(face, 0, font_size * kPixelFormat, 0, kDPI);
+
+    auto [i, inserted] = fonts_.try_emplace(FontKey{face, font_size});
+    if (inserted)
+        i->second = Font{create_font(face), line_height_of(face)};
+
+    return i->second;
+}
+
+auto Typesetter::key_of(FT_Face face,
+                        std::string_view text,
+                        const TextAttributes& attributes) -> RunKey
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto bytes = reinterpret_cast<const uint8_t*>(text.data());
+    return {face,
+            attributes.font_size,
+            attributes.text_alignment,
+            fnv1a(bytes, text.size())};
+}
+
+void Typesetter::align(Run& run, TextAlignment alignment)
+{
+    float shift = 0.0F;
+    switch (alignment)
+    {
+        case TextAlignment::Left:
+            break;
+        case TextAlignment::Right:
+            shift = run.end.x;
+            break;
+        case TextAlignment::Center:
+            shift = run.end.x / 2;
+            break;
+    }
+
+    run.glyphs.clear();
+    run.glyphs.reserve(run.shaped.size());
+    for (auto&& glyph : run.shaped)
+    {
+        auto position = glyph.pen + glyph.offset;
+        position.x -= shift;
+        run.glyphs.push_back({glyph.glyph_index, position});
+    }
+}
+
+auto Typesetter::reshape(hb_buffer_t* buffer,
+                         const Font& font,
+                         const Run& previous,
+                         std::string_view text,
+                         TextAlignment alignment) -> std::optional<Run>
+{
+    const auto& old_glyphs = previous.shaped;
+    const std::string_view old_text = previous.text;
+    if (old_glyphs.empty() || text.empty() ||
+        text.find('\n') != std::string_view::npos)
+    {
+        return {};
+    }
+
+    // Find the common prefix and suffix, on character boundaries.
+    const auto common = std::min(text.size(), old_text.size());
+    size_t prefix = 0;
+    while (prefix < common && text[prefix] == old_text[prefix])
+        ++prefix;
+    while (prefix > 0 && (is_continuation_byte(text, prefix) ||
+                          is_continuation_byte(old_text, prefix)))
+    {
+        --prefix;
+    }
+
+    size_t suffix = 0;
+    while (suffix < common - prefix &&
+           text[text.size() - suffix - 1] ==
+               old_text[old_text.size() - suffix - 1])
+    {
+        ++suffix;
+    }
+    while (suffix > 0 &&
+           is_continuation_byte(old_text, old_text.size() - suffix))
+    {
+        --suffix;
+    }
+
+    // Glyphs next to a change may be affected by it, e.g. through kerning or
+    // ligatures. Reshape one unchanged cluster on either side of the changed
+    // span, and only split where HarfBuzz says it is safe to do so.
+    const auto count = old_glyphs.size();
+    auto can_split_at = [&old_glyphs](size_t i) {
+        return !old_glyphs[i].unsafe_to_break &&
+               old_glyphs[i].cluster != old_glyphs[i - 1].cluster;
+    };
+
+    size_t first = 0;
+    for (size_t i = 1; i < count && old_glyphs[i].cluster < prefix; ++i)
+    {
+        if (can_split_at(i))
+            first = i;
+    }
+
+    const auto suffix_start = old_text.size() - suffix;
+    size_t last = count;
+    for (auto i = count - 1; i > first && old_glyphs[i].cluster > suffix_start;
+         --i)
+    {
+        if (can_split_at(i))
+            last = i;
+    }
+
+    if (first == 0 && last == count)
+        return {};
+
+    const auto start = old_glyphs[first].cluster;
+    const auto end = last == count
+                         ? text.size()
+                         : old_glyphs[last].cluster + text.size() -
+                               old_text.size();
+
+    hb_buffer_reset(buffer);
+    hb_buffer_add_utf8(buffer,
+                       text.data(),
+                       narrow_cast<int>(text.size()),
+                       start,
+                       narrow_cast<int>(end - start));
+    hb_buffer_guess_segment_properties(buffer);
+    if (hb_buffer_get_direction(buffer) != HB_DIRECTION_LTR)
+        return {};
+
+    hb_shape(font.font, buffer, nullptr, 0);
+
+    unsigned int length;
+    auto infos = hb_buffer_get_glyph_infos(buffer, &length);
+    auto positions = hb_buffer_get_glyph_positions(buffer, &length);
+
+    Run run{std::string{text}, {}, {}, 0, {}, {}};
+    auto& shaped = run.shaped;
+    shaped.reserve(first + length + count - last);
+    shaped.insert(
+        shaped.end(), old_glyphs.begin(), old_glyphs.begin() + first);
+
+    auto pen = old_glyphs[first].pen;
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        const auto& p = positions[i];
+        shaped.push_back({infos[i].codepoint,
+                          infos[i].cluster,
+                          pen,
+                          to_vec2(p.x_offset, p.y_offset),
+                          is_unsafe_to_break(infos[i])});
+        pen += to_vec2(p.x_advance, p.y_advance);
+    }
+
+    // The reused suffix moves along with the glyphs before it.
+    const auto delta = last == count ? Vec2f{} : pen - old_glyphs[last].pen;
+    std::transform(old_glyphs.begin() + last,
+                   old_glyphs.end(),
+                   std::back_inserter(shaped),
+                   [delta, &text, &old_text](ShapedGlyph glyph) {
+                       glyph.cluster = narrow_cast<uint32_t>(
+                           glyph.cluster + text.size() - old_text.size());
+                       glyph.pen += delta;
+                       return glyph;
+                   });
+    run.end = last == count ? pen : previous.end + delta;
+
+    run.size = {std::max(run.end.x, 0.0F), previous.size.y};
+    align(run, alignment);
+    return run;
+}
+
+auto Typesetter::shape(FT_Face face,
+                       std::string_view text,
+                       const TextAttributes& attributes,
+                       std::string_view previous_text) -> Run
+{
+    const auto& font = get_font(face, attributes.font_size);
+    const auto alignment = attributes.text_alignment;
+    if (previous_text.empty())
+        return shape(buffer_, font, text, alignment);
+
+    auto previous = runs_.find(key_of(face, previous_text, attributes));
+    if (previous == runs_.end() || previous->second.text != previous_text)
+        return shape(buffer_, font, text, alignment);
+
+    auto run = reshape(buffer_, font, previous->second, text, alignment);
+    return run ? *std::move(run) : shape(buffer_, font, text, alignment);
+}
+
+auto Typesetter::shape(hb_buffer_t* buffer,
+                       const Font& font,
+                       std::string_view text,
+                       TextAlignment alignment) -> Run
+{
+    Run run{std::string{text}, {}, {}, 0, {}, {}};
+    auto& result = run.glyphs;
 
+    const bool single_line = text.find('\n') == std::string_view::npos;
+    const auto line_height = font.line_height;
     float width = 0.0F;
     int line_count = 0;
     int start = 0;
     const auto length = narrow_cast<int>(text.length());
     while (start < length)
     {
-        hb_buffer_reset(buffer_);
+        hb_buffer_reset(buffer);
 
         const int line_length = suggest_line_break(text, start);
-        hb_buffer_add_utf8(buffer_, text.data(), length, start, line_length);
-        hb_buffer_guess_segment_properties(buffer_);
-        hb_shape(font, buffer_, nullptr, 0);
+        hb_buffer_add_utf8(buffer, text.data(), length, start, line_length);
+        hb_buffer_guess_segment_properties(buffer);
+        hb_shape(font.font, buffer, nullptr, 0);
 
         unsigned int count;
-        auto infos = hb_buffer_get_glyph_infos(buffer_, &count);
-        auto positions = hb_buffer_get_glyph_positions(buffer_, &count);
+        auto infos = hb_buffer_get_glyph_infos(buffer, &count);
+        auto positions = hb_buffer_get_glyph_positions(buffer, &count);
+
+        // Single line, left-to-right text can later be partially reshaped.
+        const bool reusable =
+            single_line &&
+            hb_buffer_get_direction(buffer) == HB_DIRECTION_LTR;
+        if (reusable)
+            run.shaped.reserve(count);
 
         Vec2f origin{0, -line_height * narrow_cast<float>(line_count)};
         for (unsigned int i = 0; i < count; ++i)
         {
             const auto& p = positions[i];
-            result.push_back(
-                {infos[i].codepoint, origin + to_vec2(p.x_offset, p.y_offset)});
+            const auto offset = to_vec2(p.x_offset, p.y_offset);
+            result.push_back({infos[i].codepoint, origin + offset});
+            if (reusable)
+            {
+                run.shaped.push_back({infos[i].codepoint,
+                                      infos[i].cluster,
+                                      origin,
+                                      offset,
+                                      is_unsafe_to_break(infos[i])});
+            }
             origin += to_vec2(p.x_advance, p.y_advance);
         }
 
-        switch (attributes.text_alignment)
+        if (reusable)
+            run.end = origin;
+
+        switch (alignment)
         {
             case TextAlignment::Left:
                 break;
@@ -150,13 +693,42 @@ auto Typesetter::layout_text(std::string_view text,
         width = std::max(width, origin.x);
     }
 
-    hb_font_destroy(font);
+    run.size = {width, line_height * narrow_cast<float>(line_count)};
+    return run;
+}
 
-    if (size != nullptr)
+auto Typesetter::store(const RunKey& key, Run run) -> Run&
+{
+    auto search = runs_.find(key);
+    if (search != runs_.end())
     {
-        size->x = width;
-        size->y = line_height * narrow_cast<float>(line_count);
+        // Hash collision; the most recent string wins.
+        search->second = std::move(run);
+        return search->second;
     }
 
-    return result;
+    trim();
+    return runs_.try_emplace(key, std::move(run)).first->second;
+}
+
+void Typesetter::trim()
+{
+    if (runs_.size() < kMaxCachedRuns)
+        return;
+
+    // Evict a quarter at a time so we don't have to sort on every miss.
+    std::vector<std::pair<uint64_t, RunKey>> runs;
+    runs.reserve(runs_.size());
+    for (auto&& [key, run] : runs_)
+        runs.emplace_back(run.last_used, key);
+
+    const auto evict = std::begin(runs) + kMaxCachedRuns / 4;
+    std::nth_element(
+        std::begin(runs), evict, std::end(runs), [](auto&& lhs, auto&& rhs) {
+            return lhs.first < rhs.first;
+        });
+
+    std::for_each(std::begin(runs), evict, [this](auto&& run) {
+        runs_.erase(run.second);
+    });
 }
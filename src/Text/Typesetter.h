@@ -5,10 +5,13 @@
 #ifndef TEXT_TYPESETTER_H_
 #define TEXT_TYPESETTER_H_
 
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+
 #include <Rainbow/TextAlignment.h>
 
 #include "Common/NonCopyable.h"
@@ -16,6 +19,7 @@
 #include "Text/FontCache.h"
 
 struct hb_buffer_t;
+struct hb_font_t;
 
 namespace rainbow
 {
@@ -25,16 +29,67 @@ namespace rainbow
         Vec2f position;
     };
 
+    /// <summary>Consecutive glyphs stored on the same texture page.</summary>
+    struct GlyphRange
+    {
+        uint32_t page;
+        uint32_t generation;
+        uint32_t first;
+        uint32_t count;
+    };
+
     struct TextAttributes
     {
         const std::string& font_face;
         int font_size;
         TextAlignment text_alignment;
+        GlyphRendering rendering = GlyphRendering::Coverage;
+    };
+
+    /// <summary>A string to be laid out ahead of time.</summary>
+    struct LayoutRequest
+    {
+        std::string_view text;
+        TextAttributes attributes;
+
+        /// <summary>
+        ///   Text that <see cref="text"/> replaces, if any. See
+        ///   <see cref="Typesetter::layout_text"/>.
+        /// </summary>
+        std::string_view previous_text = {};
     };
 
+    struct TextMesh
+    {
+        std::vector<SpriteVertex> vertices;
+
+        /// <summary>Glyphs grouped by texture page.</summary>
+        std::vector<GlyphRange> ranges;
+    };
+
+    /// <summary>Shapes and lays out text.</summary>
+    /// <remarks>
+    ///   HarfBuzz fonts are kept for every font face and size used, and the
+    ///   most recently laid out strings are cached. Laying out the same
+    ///   string again, e.g. when a label is only moved, skips shaping.
+    ///   Strings can also be shaped ahead of time on worker threads with
+    ///   <see cref="prepare"/>.
+    ///
+    ///   When a string replaces one that was laid out before, only the span
+    ///   that differs is shaped again, if possible.
+    /// </remarks>
     class Typesetter : private NonCopyable<Typesetter>
     {
     public:
+        /// <summary>Number of laid out strings to keep.</summary>
+        static constexpr size_t kMaxCachedRuns = 256;
+
+        /// <summary>
+        ///   Minimum number of strings before <see cref="prepare"/> bothers
+        ///   with worker threads.
+        /// </summary>
+        static constexpr size_t kMinParallelLayouts = 4;
+
         Typesetter();
         ~Typesetter();
 
@@ -43,15 +98,202 @@ namespace rainbow
         auto draw_text(std::string_view text,
                        const Vec2f& position,
                        const TextAttributes& attributes,
-                       Vec2f* size = nullptr) -> std::vector<SpriteVertex>;
+                       Vec2f* size = nullptr,
+                       std::string_view previous_text = {}) -> TextMesh;
 
+        /// <summary>Shapes and positions the glyphs of a string.</summary>
+        /// <param name="previous_text">
+        ///   Text that was previously laid out with the same attributes, and
+        ///   is now being replaced. Glyphs of any common prefix or suffix are
+        ///   reused if possible.
+        /// </param>
         auto layout_text(std::string_view text,
                          const TextAttributes& attributes,
-                         Vec2f* size = nullptr) -> std::vector<GlyphPosition>;
+                         Vec2f* size = nullptr,
+                         std::string_view previous_text = {})
+            -> std::vector<GlyphPosition>;
+
+        /// <summary>
+        ///   Shapes the strings that have not been laid out yet, spread over
+        ///   the shared thread pool. Subsequent calls to
+        ///   <see cref="layout_text"/> with the same text and attributes skip
+        ///   shaping.
+        /// </summary>
+        /// <remarks>
+        ///   Strings replacing one that is still cached are reshaped only
+        ///   where they differ, like in <see cref="layout_text"/>. Each worker
+        ///   shapes with its own FreeType and HarfBuzz objects.
+        ///   Glyphs are not rasterized until the text is drawn, which happens
+        ///   on the calling thread only.
+        /// </remarks>
+        void prepare(const std::vector<LayoutRequest>& requests);
+
+#ifdef USE_HEIMDALL
+        /// <summary>
+        ///   Unloads specified font, and drops the fonts and layouts cached
+        ///   for it. Does nothing if the font is not loaded.
+        /// </summary>
+        /// <returns>Whether specified font was loaded.</returns>
+        auto reload(std::string_view font_name) -> bool;
+#endif  // USE_HEIMDALL
+
+#ifdef RAINBOW_TEST
+        /// <summary>Returns the number of cached layouts.</summary>
+        [[nodiscard]] auto cached_runs() const { return runs_.size(); }
+
+        /// <summary>
+        ///   Returns whether a layout of <paramref name="text"/> is cached.
+        /// </summary>
+        auto is_cached(std::string_view text, const TextAttributes& attributes)
+            -> bool
+        {
+            const auto face = font_cache_.get(attributes.font_face);
+            auto search = runs_.find(key_of(face, text, attributes));
+            return search != runs_.end() && search->second.text == text;
+        }
+#endif  // RAINBOW_TEST
+
+        /// <summary>
+        ///   Per-thread shaping state used by workers. Declared in
+        ///   <c>Text/Workspace.h</c>.
+        /// </summary>
+        class Workspace;
 
     private:
+        struct FontKey
+        {
+            FT_Face face;
+            int32_t font_size;
+
+            template <typename H>
+            friend auto AbslHashValue(H hash_state, const FontKey& k) -> H
+            {
+                return H::combine(std::move(hash_state), k.face, k.font_size);
+            }
+
+            friend auto operator==(const FontKey& lhs, const FontKey& rhs)
+                -> bool
+            {
+                return lhs.face == rhs.face && lhs.font_size == rhs.font_size;
+            }
+        };
+
+        struct Font
+        {
+            hb_font_t* font;
+            float line_height;
+        };
+
+        struct RunKey
+        {
+            FT_Face face;
+            int32_t font_size;
+            TextAlignment alignment;
+            uint64_t text;  // Hash of the text
+
+            template <typename H>
+            friend auto AbslHashValue(H hash_state, const RunKey& k) -> H
+            {
+                return H::combine(std::move(hash_state),
+                                  k.face,
+                                  k.font_size,
+                                  k.alignment,
+                                  k.text);
+            }
+
+            friend auto operator==(const RunKey& lhs, const RunKey& rhs)
+                -> bool
+            {
+                return lhs.face == rhs.face && lhs.font_size == rhs.font_size &&
+                       lhs.alignment == rhs.alignment && lhs.text == rhs.text;
+            }
+        };
+
+        /// <summary>A glyph as it was shaped, before alignment.</summary>
+        struct ShapedGlyph
+        {
+            uint32_t glyph_index;
+            uint32_t cluster;  // Offset of the glyph's first byte in the text
+            Vec2f pen;         // Pen position before advancing past the glyph
+            Vec2f offset;
+            bool unsafe_to_break;
+        };
+
+        struct Run
+        {
+            std::string text;
+            std::vector<GlyphPosition> glyphs;
+            Vec2f size;
+            uint64_t last_used;
+
+            /// <summary>
+            ///   Glyphs of single line, left-to-right text; empty otherwise.
+            ///   Only these runs can be partially reused.
+            /// </summary>
+            std::vector<ShapedGlyph> shaped;
+
+            /// <summary>Pen position after the last glyph.</summary>
+            Vec2f end;
+        };
+
         FontCache font_cache_;
         hb_buffer_t* buffer_;
+        absl::flat_hash_map<FontKey, Font> fonts_;
+        absl::flat_hash_map<RunKey, Run> runs_;
+        uint64_t clock_ = 0;
+
+        /// <summary>
+        ///   Returns the HarfBuzz font for <paramref name="face"/> at
+        ///   <paramref name="font_size"/>, creating it if necessary.
+        /// </summary>
+        auto get_font(FT_Face face, int32_t font_size) -> const Font&;
+
+        static auto key_of(FT_Face face,
+                           std::string_view text,
+                           const TextAttributes& attributes) -> RunKey;
+
+        /// <summary>
+        ///   Positions the glyphs of a single line run according to
+        ///   <paramref name="alignment"/>.
+        /// </summary>
+        static void align(Run& run, TextAlignment alignment);
+
+        /// <summary>
+        ///   Shapes <paramref name="text"/>, reusing the glyphs of the common
+        ///   prefix and suffix of <paramref name="previous"/>.
+        /// </summary>
+        /// <returns>
+        ///   Nothing if there was nothing to reuse, or the text is not single
+        ///   line, left-to-right.
+        /// </returns>
+        static auto reshape(hb_buffer_t* buffer,
+                            const Font& font,
+                            const Run& previous,
+                            std::string_view text,
+                            TextAlignment alignment) -> std::optional<Run>;
+
+        static auto shape(hb_buffer_t* buffer,
+                          const Font& font,
+                          std::string_view text,
+                          TextAlignment alignment) -> Run;
+
+        /// <summary>
+        ///   Shapes <paramref name="text"/>, partially reusing
+        ///   <paramref name="previous_text"/> if it is still cached.
+        /// </summary>
+        auto shape(FT_Face face,
+                   std::string_view text,
+                   const TextAttributes& attributes,
+                   std::string_view previous_text) -> Run;
+
+        /// <summary>Caches <paramref name="run"/>.</summary>
+        auto store(const RunKey& key, Run run) -> Run&;
+
+        /// <summary>
+        ///   Evicts the least recently used runs until there is room for new
+        ///   ones.
+        /// </summary>
+        void trim();
     };
 }  // namespace rainbow
 
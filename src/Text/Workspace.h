@@ -0,0 +1,96 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef TEXT_WORKSPACE_H_
+#define TEXT_WORKSPACE_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "Memory/ArrayMap.h"
+#include "Text/Typesetter.h"
+
+namespace rainbow
+{
+    /// <summary>
+    ///   FreeType and HarfBuzz objects owned by a single thread. FreeType
+    ///   faces must not be shared between threads, but they may share the
+    ///   same font file.
+    /// </summary>
+    /// <remarks>
+    ///   At most <see cref="kMaxFaces"/> faces are kept, and the least
+    ///   recently used one is released to make room for another.
+    /// </remarks>
+    class Typesetter::Workspace : private NonCopyable<Workspace>
+    {
+    public:
+        /// <summary>Number of font faces to keep per thread.</summary>
+        static constexpr size_t kMaxFaces = 4;
+
+        /// <summary>
+        ///   Number of HarfBuzz fonts to keep per thread before they are all
+        ///   released.
+        /// </summary>
+        static constexpr size_t kMaxFonts = 16;
+
+        /// <summary>Returns the calling thread's workspace.</summary>
+        static auto get() -> Workspace&;
+
+        /// <summary>
+        ///   Releases the faces and fonts of all workspaces. Workspaces on
+        ///   other threads are cleared the next time they are used.
+        /// </summary>
+        static void invalidate();
+
+        Workspace();
+        ~Workspace();
+
+        [[nodiscard]] auto buffer() const { return buffer_; }
+
+        /// <summary>
+        ///   Returns this thread's face for <paramref name="font_name"/>, set
+        ///   to <paramref name="font_size"/>. <paramref name="data"/> is the
+        ///   font file; if it differs from last time, the font was reloaded
+        ///   and the face is recreated.
+        /// </summary>
+        auto get_face(std::string_view font_name,
+                      const std::shared_ptr<const Data>& data,
+                      int32_t font_size) -> FT_Face;
+
+        /// <summary>
+        ///   Returns this thread's HarfBuzz font for
+        ///   <paramref name="font_name"/> at <paramref name="font_size"/>.
+        /// </summary>
+        auto get_font(std::string_view font_name,
+                      const std::shared_ptr<const Data>& data,
+                      int32_t font_size) -> const Font&;
+
+    private:
+        struct Face
+        {
+            FT_Face face = nullptr;
+            std::shared_ptr<const Data> data;
+            uint64_t last_used = 0;
+        };
+
+        FT_Library library_ = nullptr;
+        hb_buffer_t* buffer_;
+        ArrayMap<std::string, Face> faces_;
+        absl::flat_hash_map<FontKey, Font> fonts_;
+        uint64_t clock_ = 0;
+        uint32_t generation_ = 0;
+
+        /// <summary>Releases all faces and fonts.</summary>
+        void clear();
+
+        /// <summary>Releases all HarfBuzz fonts.</summary>
+        void clear_fonts();
+
+        /// <summary>Releases a face, and any fonts created from it.</summary>
+        void release(ArrayMap<std::string, Face>::iterator i);
+    };
+}  // namespace rainbow
+
+#endif
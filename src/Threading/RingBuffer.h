@@ -0,0 +1,133 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef THREADING_RINGBUFFER_H_
+#define THREADING_RINGBUFFER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+#include "Common/NonCopyable.h"
+
+namespace rainbow
+{
+    /// <summary>
+    ///   Lock-free, fixed-size ring buffer for a single producer and a single
+    ///   consumer thread.
+    /// </summary>
+    /// <remarks>
+    ///   <see cref="push"/> may only be called from the producer thread, and
+    ///   <see cref="pop"/> only from the consumer thread. Neither ever blocks
+    ///   or allocates.
+    /// </remarks>
+    template <typename T>
+    class RingBuffer : private NonCopyable<RingBuffer<T>>
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+    public:
+        /// <summary>
+        ///   Creates a ring buffer that holds at least
+        ///   <paramref name="capacity"/> items.
+        /// </summary>
+        explicit RingBuffer(size_t capacity)
+            : capacity_(round_up(capacity)),
+              items_(std::make_unique<T[]>(capacity_))
+        {
+        }
+
+        /// <summary>Returns the maximum number of items.</summary>
+        [[nodiscard]] auto capacity() const { return capacity_; }
+
+        /// <summary>Returns whether there are no items to pop.</summary>
+        [[nodiscard]] auto empty() const { return size() == 0; }
+
+        /// <summary>Returns the number of items that can be popped.</summary>
+        [[nodiscard]] auto size() const -> size_t
+        {
+            return write_.load(std::memory_order_acquire) -
+                   read_.load(std::memory_order_acquire);
+        }
+
+        /// <summary>
+        ///   Copies up to <paramref name="count"/> items into
+        ///   <paramref name="out"/>. Consumer only.
+        /// </summary>
+        /// <returns>Number of items popped.</returns>
+        auto pop(T* out, size_t count) -> size_t
+        {
+            const auto read = read_.load(std::memory_order_relaxed);
+            const auto write = write_.load(std::memory_order_acquire);
+            count = std::min(count, write - read);
+            copy_out(read, out, count);
+            read_.store(read + count, std::memory_order_release);
+            return count;
+        }
+
+        /// <summary>Pops a single item. Consumer only.</summary>
+        auto pop(T& item) -> bool { return pop(&item, 1) == 1; }
+
+        /// <summary>
+        ///   Copies up to <paramref name="count"/> items from
+        ///   <paramref name="items"/> into the buffer. Producer only.
+        /// </summary>
+        /// <returns>Number of items pushed.</returns>
+        auto push(const T* items, size_t count) -> size_t
+        {
+            const auto write = write_.load(std::memory_order_relaxed);
+            const auto read = read_.load(std::memory_order_acquire);
+            count = std::min(count, capacity_ - (write - read));
+            copy_in(write, items, count);
+            write_.store(write + count, std::memory_order_release);
+            return count;
+        }
+
+        /// <summary>Pushes a single item. Producer only.</summary>
+        auto push(const T& item) -> bool { return push(&item, 1) == 1; }
+
+        /// <summary>
+        ///   Returns the number of items that can be pushed. Only exact when
+        ///   called from the producer thread.
+        /// </summary>
+        [[nodiscard]] auto space() const { return capacity_ - size(); }
+
+    private:
+        /// <remarks>
+        ///   Indices only ever increase and are wrapped when accessing items.
+        ///   They are kept apart to avoid false sharing between threads.
+        /// </remarks>
+        alignas(64) std::atomic<size_t> write_{0};
+        alignas(64) std::atomic<size_t> read_{0};
+        alignas(64) const size_t capacity_;
+        std::unique_ptr<T[]> items_;
+
+        static auto round_up(size_t n) -> size_t
+        {
+            size_t capacity = 1;
+            while (capacity < n)
+                capacity <<= 1;
+            return capacity;
+        }
+
+        void copy_in(size_t index, const T* items, size_t count)
+        {
+            const auto first = index & (capacity_ - 1);
+            const auto n = std::min(count, capacity_ - first);
+            std::copy_n(items, n, items_.get() + first);
+            std::copy_n(items + n, count - n, items_.get());
+        }
+
+        void copy_out(size_t index, T* out, size_t count) const
+        {
+            const auto first = index & (capacity_ - 1);
+            const auto n = std::min(count, capacity_ - first);
+            std::copy_n(items_.get() + first, n, out);
+            std::copy_n(items_.get(), count - n, out + n);
+        }
+    };
+}  // namespace rainbow
+
+#endif
@@ -0,0 +1,93 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Threading/ThreadPool.h"
+
+#include "Platform/Macros.h"
+
+using rainbow::ThreadPool;
+
+namespace
+{
+    thread_local bool t_is_worker_thread = false;
+
+    auto shared_pool_size() -> size_t
+    {
+#ifdef RAINBOW_JS
+        // Threads are not available without SharedArrayBuffer.
+        return 0;
+#else
+        const auto concurrency = std::thread::hardware_concurrency();
+        return concurrency > 1 ? concurrency - 1 : 0;
+#endif
+    }
+}  // namespace
+
+auto ThreadPool::shared() -> ThreadPool&
+{
+    static ThreadPool pool{shared_pool_size()};
+    return pool;
+}
+
+auto ThreadPool::is_worker_thread() -> bool
+{
+    return t_is_worker_thread;
+}
+
+ThreadPool::ThreadPool(size_t num_workers)
+{
+    workers_.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i)
+        workers_.emplace_back([this] { run(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+
+    for (auto&& worker : workers_)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    if (workers_.empty())
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    condition_.notify_one();
+}
+
+void ThreadPool::run()
+{
+    t_is_worker_thread = true;
+
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(
+                lock, [this] { return stopping_ || !tasks_.empty(); });
+
+            // Drain the queue before stopping so no task is silently dropped.
+            if (tasks_.empty())
+                return;
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
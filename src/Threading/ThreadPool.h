@@ -0,0 +1,131 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef THREADING_THREADPOOL_H_
+#define THREADING_THREADPOOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/NonCopyable.h"
+
+namespace rainbow
+{
+    /// <summary>Fixed-size pool of worker threads.</summary>
+    class ThreadPool : private NonCopyable<ThreadPool>
+    {
+    public:
+        /// <summary>
+        ///   Returns the process-wide pool for CPU-bound work. It has one
+        ///   worker less than there are hardware threads, so that callers of
+        ///   <see cref="parallel_for"/> can make up for the difference.
+        /// </summary>
+        static auto shared() -> ThreadPool&;
+
+        /// <summary>Returns whether the caller is one of our workers.</summary>
+        static auto is_worker_thread() -> bool;
+
+        /// <summary>Creates a pool with specified number of workers.</summary>
+        /// <remarks>
+        ///   A pool without workers runs tasks on the calling thread.
+        /// </remarks>
+        explicit ThreadPool(size_t num_workers);
+        ~ThreadPool();
+
+        /// <summary>Returns the number of worker threads.</summary>
+        [[nodiscard]] auto size() const { return workers_.size(); }
+
+        /// <summary>
+        ///   Calls <paramref name="func"/> with every index in
+        ///   [0, <paramref name="count"/>), spread over the calling thread and
+        ///   the workers. Returns when all calls have completed.
+        /// </summary>
+        /// <remarks>
+        ///   When called from a worker, everything runs on the calling thread
+        ///   to avoid workers waiting on each other. Workers that are busy
+        ///   with other tasks are not waited for either.
+        /// </remarks>
+        template <typename F>
+        void parallel_for(size_t count, F&& func)
+        {
+            const size_t helpers =
+                is_worker_thread() || count == 0
+                    ? 0
+                    : std::min(workers_.size(), count - 1);
+            if (helpers == 0)
+            {
+                for (size_t i = 0; i < count; ++i)
+                    func(i);
+                return;
+            }
+
+            // Helpers may not start until long after we are done, e.g. when
+            // all workers are busy with other tasks. We take over any work
+            // they have yet to claim instead of waiting for them, and only
+            // wait for those that are already running.
+            struct State
+            {
+                std::atomic<size_t> next{0};
+                std::mutex mutex;
+                std::condition_variable done;
+                size_t running = 0;
+                bool finished = false;
+            };
+
+            auto state = std::make_shared<State>();
+            auto work = [&next = state->next, count, &func] {
+                for (auto i = next++; i < count; i = next++)
+                    func(i);
+            };
+
+            for (size_t i = 0; i < helpers; ++i)
+            {
+                submit([state, &work] {
+                    {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        if (state->finished)
+                            return;
+
+                        ++state->running;
+                    }
+
+                    work();
+
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (--state->running == 0)
+                        state->done.notify_one();
+                });
+            }
+
+            work();
+
+            // Running helpers still reference this stack frame and must have
+            // returned before we can leave it.
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->finished = true;
+            state->done.wait(lock, [&state] { return state->running == 0; });
+        }
+
+        /// <summary>Queues a task to be run on a worker thread.</summary>
+        void submit(std::function<void()> task);
+
+    private:
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stopping_ = false;
+
+        void run();
+    };
+}  // namespace rainbow
+
+#endif
@@ -0,0 +1,336 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+// @ts-check
+"use strict";
+
+/**
+ * Builds a Rainbow asset pack (.rpk) from a directory. See
+ * `src/FileSystem/Pack.h` for a description of the format.
+ *
+ * Usage: build-pack.js [--alignment <bytes>] [--no-compression] <assets> <output>
+ */
+
+const fs = require("fs");
+const path = require("path");
+
+const MAGIC = 0x4b415052; // "RPAK"
+const VERSION = 1;
+const HEADER_SIZE = 32;
+const ENTRY_SIZE = 32;
+const DEFAULT_ALIGNMENT = 4096;
+
+const COMPRESSION_NONE = 0;
+const COMPRESSION_LZ4 = 1;
+
+// Only keep compressed entries that are at least this much smaller.
+const MIN_COMPRESSION_RATIO = 0.9;
+
+const LZ4_HASH_LOG = 16;
+const LZ4_LAST_LITERALS = 5;
+const LZ4_MAX_OFFSET = 65535;
+const LZ4_MF_LIMIT = 12;
+const LZ4_MIN_MATCH = 4;
+
+/**
+ * @typedef {{
+ *   name: string;
+ *   hash: bigint;
+ *   size: number;
+ *   data: Buffer;
+ *   compression: number;
+ *   nameOffset: number;
+ *   offset: number;
+ * }} Entry
+ */
+
+/**
+ * Rounds `value` up to the nearest multiple of `alignment`.
+ * @param {number} value
+ * @param {number} alignment
+ * @returns {number}
+ */
+function align(value, alignment) {
+  return Math.ceil(value / alignment) * alignment;
+}
+
+/**
+ * Returns the 64-bit FNV-1a hash of specified bytes.
+ * @param {Buffer} bytes
+ * @returns {bigint}
+ */
+function fnv1a(bytes) {
+  let hash = 0xcbf29ce484222325n;
+  for (const b of bytes) {
+    hash ^= BigInt(b);
+    hash = (hash * 0x100000001b3n) & 0xffffffffffffffffn;
+  }
+  return hash;
+}
+
+/**
+ * Writes an LZ4 length continuation and returns the new output position.
+ * @param {Buffer} out
+ * @param {number} op
+ * @param {number} length
+ * @returns {number}
+ */
+function writeLength(out, op, length) {
+  for (; length >= 255; length -= 255) {
+    out[op++] = 255;
+  }
+  out[op++] = length;
+  return op;
+}
+
+/**
+ * Compresses specified data into a single LZ4 block.
+ * @param {Buffer} src
+ * @returns {Buffer}
+ */
+function compressLZ4(src) {
+  const out = Buffer.alloc(src.length + Math.ceil(src.length / 255) + 16);
+  const table = new Int32Array(1 << LZ4_HASH_LOG).fill(-1);
+  const matchLimit = src.length - LZ4_LAST_LITERALS;
+
+  let op = 0;
+  let anchor = 0;
+
+  /** @type {(end: number, offset: number, matchLength: number) => void} */
+  const emit = (end, offset, matchLength) => {
+    const literals = end - anchor;
+    const token = op++;
+    out[token] = Math.min(literals, 15) << 4;
+    if (literals >= 15) {
+      op = writeLength(out, op, literals - 15);
+    }
+    op += src.copy(out, op, anchor, end);
+
+    if (matchLength > 0) {
+      out.writeUInt16LE(offset, op);
+      op += 2;
+
+      const length = matchLength - LZ4_MIN_MATCH;
+      out[token] |= Math.min(length, 15);
+      if (length >= 15) {
+        op = writeLength(out, op, length - 15);
+      }
+    }
+  };
+
+  // The last match must start at least 12 bytes before the end of the block,
+  // and the last 5 bytes are always literals.
+  let ip = 0;
+  while (ip + LZ4_MF_LIMIT <= src.length) {
+    const sequence = src.readUInt32LE(ip);
+    const h = Math.imul(sequence, 2654435761) >>> (32 - LZ4_HASH_LOG);
+    const ref = table[h];
+    table[h] = ip;
+
+    if (
+      ref < 0 ||
+      ip - ref > LZ4_MAX_OFFSET ||
+      src.readUInt32LE(ref) !== sequence
+    ) {
+      ++ip;
+      continue;
+    }
+
+    let length = LZ4_MIN_MATCH;
+    while (ip + length < matchLimit && src[ref + length] === src[ip + length]) {
+      ++length;
+    }
+
+    emit(ip, ip - ref, length);
+    ip += length;
+    anchor = ip;
+  }
+
+  emit(src.length, 0, 0);
+  return out.subarray(0, op);
+}
+
+/**
+ * Returns all files under specified directory, relative to `root`.
+ * @param {string} root
+ * @param {string} dir
+ * @returns {string[]}
+ */
+function listFiles(root, dir = root) {
+  return fs
+    .readdirSync(dir, { withFileTypes: true })
+    .filter((entry) => !entry.name.startsWith("."))
+    .sort((a, b) => (a.name < b.name ? -1 : a.name > b.name ? 1 : 0))
+    .flatMap((entry) => {
+      const p = path.join(dir, entry.name);
+      if (entry.isDirectory()) {
+        return listFiles(root, p);
+      }
+      return entry.isFile() ? [path.relative(root, p)] : [];
+    });
+}
+
+/**
+ * Reads and, if worthwhile, compresses an asset.
+ * @param {string} assetsDir
+ * @param {string} file
+ * @param {boolean} compress
+ * @returns {Entry}
+ */
+function makeEntry(assetsDir, file, compress) {
+  const name = file.split(path.sep).join("/");
+  const nameBytes = Buffer.from(name, "utf8");
+  if (nameBytes.length > 0xffff) {
+    throw new Error(`Path is too long: ${name}`);
+  }
+
+  const data = fs.readFileSync(path.join(assetsDir, file));
+  if (data.length > 0xffffffff) {
+    throw new Error(`File is too large: ${name}`);
+  }
+
+  /** @type {Entry} */
+  const entry = {
+    name,
+    hash: fnv1a(nameBytes),
+    size: data.length,
+    data,
+    compression: COMPRESSION_NONE,
+    nameOffset: 0,
+    offset: 0,
+  };
+
+  if (compress && data.length > 0) {
+    const compressed = compressLZ4(data);
+    if (compressed.length < data.length * MIN_COMPRESSION_RATIO) {
+      entry.data = compressed;
+      entry.compression = COMPRESSION_LZ4;
+    }
+  }
+
+  return entry;
+}
+
+/**
+ * Builds a pack from all files in specified directory.
+ * @param {string} assetsDir
+ * @param {string} output
+ * @param {{ alignment: number; compress: boolean; }} options
+ */
+function buildPack(assetsDir, output, { alignment, compress }) {
+  const entries = listFiles(assetsDir).map((file) =>
+    makeEntry(assetsDir, file, compress)
+  );
+
+  let slotCount = 1;
+  while (slotCount < entries.length * 2) {
+    slotCount *= 2;
+  }
+
+  const names = [];
+  let namesSize = 0;
+  for (const entry of entries) {
+    const name = Buffer.from(`${entry.name}\0`, "utf8");
+    entry.nameOffset = namesSize;
+    names.push(name);
+    namesSize += name.length;
+  }
+
+  const entriesOffset = align(HEADER_SIZE + slotCount * 4, 8);
+  const namesOffset = entriesOffset + entries.length * ENTRY_SIZE;
+
+  let cursor = namesOffset + namesSize;
+  for (const entry of entries) {
+    entry.offset = align(cursor, alignment);
+    cursor = entry.offset + entry.data.length;
+  }
+
+  const toc = Buffer.alloc(namesOffset);
+  toc.writeUInt32LE(MAGIC, 0);
+  toc.writeUInt32LE(VERSION, 4);
+  toc.writeUInt32LE(entries.length, 8);
+  toc.writeUInt32LE(slotCount, 12);
+  toc.writeUInt32LE(alignment, 16);
+  toc.writeUInt32LE(namesSize, 20);
+
+  const mask = BigInt(slotCount - 1);
+  entries.forEach((entry, i) => {
+    let slot = Number(entry.hash & mask);
+    while (toc.readUInt32LE(HEADER_SIZE + slot * 4) !== 0) {
+      slot = (slot + 1) % slotCount;
+    }
+    toc.writeUInt32LE(i + 1, HEADER_SIZE + slot * 4);
+
+    const p = entriesOffset + i * ENTRY_SIZE;
+    toc.writeBigUInt64LE(entry.hash, p);
+    toc.writeBigUInt64LE(BigInt(entry.offset), p + 8);
+    toc.writeUInt32LE(entry.size, p + 16);
+    toc.writeUInt32LE(entry.data.length, p + 20);
+    toc.writeUInt32LE(entry.nameOffset, p + 24);
+    toc.writeUInt16LE(Buffer.byteLength(entry.name, "utf8"), p + 28);
+    toc.writeUInt16LE(entry.compression, p + 30);
+  });
+
+  // Write to a temporary file first so that a failed build doesn't leave a
+  // corrupt pack behind.
+  const tmp = `${output}.tmp`;
+  const fd = fs.openSync(tmp, "w", 0o644);
+  try {
+    fs.writeSync(fd, toc, 0, toc.length, 0);
+    fs.writeSync(fd, Buffer.concat(names), 0, namesSize, namesOffset);
+    for (const entry of entries) {
+      fs.writeSync(fd, entry.data, 0, entry.data.length, entry.offset);
+    }
+    fs.ftruncateSync(fd, cursor);
+  } finally {
+    fs.closeSync(fd);
+  }
+  fs.renameSync(tmp, output);
+
+  const compressed = entries.filter((e) => e.compression !== COMPRESSION_NONE);
+  // eslint-disable-next-line no-console
+  console.log(
+    `${assetsDir} -> ${output} (${entries.length} files, ${compressed.length} compressed, ${cursor} bytes)`
+  );
+}
+
+if (require.main && require.main.filename === __filename) {
+  const args = process.argv.slice(process.argv.indexOf(__filename) + 1);
+  const options = { alignment: DEFAULT_ALIGNMENT, compress: true };
+  const positional = [];
+  for (let i = 0; i < args.length; ++i) {
+    switch (args[i]) {
+      case "--alignment":
+        options.alignment = Number(args[++i]);
+        break;
+      case "--no-compression":
+        options.compress = false;
+        break;
+      default:
+        positional.push(args[i]);
+        break;
+    }
+  }
+
+  const { alignment } = options;
+  if (
+    positional.length !== 2 ||
+    !Number.isInteger(alignment) ||
+    alignment <= 0 ||
+    (alignment & (alignment - 1)) !== 0
+  ) {
+    // eslint-disable-next-line no-console
+    console.error(
+      "Usage: build-pack.js [--alignment <bytes>] [--no-compression] <assets> <output>"
+    );
+    process.exit(1);
+  }
+
+  buildPack(positional[0], positional[1], options);
+}
+
+module.exports = {
+  buildPack,
+  compressLZ4,
+};
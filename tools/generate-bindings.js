@@ -19,10 +19,15 @@ const sourcePath = path.resolve(__dirname, "..", "src");
      | "Animation::Frames"
      | "Animation|Label|SpriteBatch"
      | "Animation|Label|SpriteBatch|czstring|int"
+     | "ArrayBuffer|czstring"
      | "Channel"
      | "Channel|Sound"
      | "Channel|undefined"
      | "Color"
+     | "IOPriority"
+     | "IORequest"
+     | "IORequest::OnFulfilled"
+     | "IORequest::OnRejected"
      | "Rect"
      | "Sound"
      | "Sound|undefined"
@@ -43,6 +48,7 @@ const sourcePath = path.resolve(__dirname, "..", "src");
  *   type: NativeType;
  *   name: string;
  *   mustBeMoved?: boolean;
+ *   optional?: boolean;
  * }} ParameterInfo
  *
  * @typedef {{
@@ -160,6 +166,13 @@ const modules = [
     sourceName: "ControllerButton",
     values: [],
   },
+  {
+    type: "enum",
+    name: "IOPriority",
+    source: "FileSystem/AsyncIO.h",
+    sourceName: "IOPriority",
+    values: [],
+  },
   {
     type: "class",
     name: "Label",
@@ -439,6 +452,77 @@ const modules = [
       },
     ],
   },
+  {
+    type: "module",
+    name: "FontCache",
+    source: "Text/FontCache.h",
+    sourceName: "FontCache",
+    functions: [
+      {
+        name: "prewarm",
+        parameters: [
+          { type: "czstring", name: "font" },
+          { type: "int", name: "fontSize" },
+          { type: "czstring", name: "text" },
+        ],
+      },
+    ],
+  },
+  {
+    type: "module",
+    name: "IO",
+    source: "FileSystem/AsyncIO.h",
+    sourceName: "IO",
+    functions: [
+      {
+        name: "read_file",
+        parameters: [
+          { type: "czstring", name: "path" },
+          { type: "IOPriority", name: "priority", optional: true },
+        ],
+        returnType: "IORequest",
+      },
+      {
+        name: "read_user_file",
+        parameters: [
+          { type: "czstring", name: "path" },
+          { type: "IOPriority", name: "priority", optional: true },
+        ],
+        returnType: "IORequest",
+      },
+      {
+        name: "write_file",
+        parameters: [
+          { type: "czstring", name: "path" },
+          { type: "ArrayBuffer|czstring", name: "data" },
+          { type: "IOPriority", name: "priority", optional: true },
+        ],
+        returnType: "IORequest",
+      },
+    ],
+    types: [
+      {
+        type: "class",
+        name: "IORequest",
+        source: "FileSystem/AsyncIO.h",
+        sourceName: "IORequest",
+        methods: [
+          {
+            name: "then",
+            parameters: [
+              { type: "IORequest::OnFulfilled", name: "onFulfilled" },
+              {
+                type: "IORequest::OnRejected",
+                name: "onRejected",
+                optional: true,
+              },
+            ],
+          },
+          { name: "cancel", parameters: [], returnType: "bool" },
+        ],
+      },
+    ],
+  },
   {
     type: "module",
     name: "Input",
@@ -806,7 +890,10 @@ function generateTypeScriptDeclaration(typeInfo) {
   /** @type {(parameters: ParameterInfo[]) => string} */
   const joinParams = (parameters) => {
     return parameters
-      .map((p) => `${p.name}: ${toTypeScriptType(p.type)}`)
+      .map((p) => {
+        const optional = p.optional ? "?" : "";
+        return `${p.name}${optional}: ${toTypeScriptType(p.type)}`;
+      })
       .join(", ");
   };
 
@@ -820,6 +907,10 @@ function generateTypeScriptDeclaration(typeInfo) {
             return "(animation: Animation, event: AnimationEvent) => void";
           case "Animation::Frames":
             return "Rect[]";
+          case "IORequest::OnFulfilled":
+            return "(result?: ArrayBuffer) => void";
+          case "IORequest::OnRejected":
+            return "(reason: string) => void";
           case "SpriteRef":
             return "Sprite";
           case "bool":